@@ -107,13 +107,13 @@ int main()
 	char& newBoolComponent1 = eReg.Assign<char>(e1);
 	newBoolComponent1 = '1';
 
-	CU::SparseSet<Entity> intEntities;
+	EntityRegistry::EntitySet intEntities;
 	eReg.Collection<int>(intEntities);
 	
-	CU::SparseSet<Entity> intFloatEntities;
+	EntityRegistry::EntitySet intFloatEntities;
 	eReg.Collection<int, float>(intFloatEntities);
 
-	CU::SparseSet<Entity> intFloatCharEntities;
+	EntityRegistry::EntitySet intFloatCharEntities;
 	eReg.Collection<int, float, char>(intFloatCharEntities);
 
 	eReg.Remove<int>(e1);
@@ -0,0 +1,259 @@
+#pragma once
+#include <vector>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <assert.h>
+
+/*
+	Vector made of fixed-size, aligned chunks that are never moved once allocated.
+	Growing allocates another chunk instead of reallocating, so pointers and references to elements stay valid
+	for as long as the element itself is not erased or moved by the owner, and large elements are never copied on growth.
+	Elements of a chunk are contiguous, GetChunkData/GetChunkSize allow linear iteration chunk by chunk.
+	Mirrors the subset of the std::vector interface the component registry relies on so it can be used as a pool backend.
+*/
+
+namespace CommonUtility
+{
+	template<class T, size_t ChunkBytes = 16 * 1024>
+	class ChunkedVector
+	{
+	public:
+		static constexpr size_t chunkAlignment = (std::max)(alignof(T), static_cast<size_t>(64));//At least a cache line.
+		static constexpr size_t elementsPerChunk = []
+		{
+			size_t elements = 1;
+			while ((elements * 2 * sizeof(T)) <= ChunkBytes)
+			{
+				elements *= 2;
+			}
+			return elements;
+		}();//Power of two so indexing is a shift and a mask.
+
+		ChunkedVector() {}
+		ChunkedVector(const ChunkedVector& anOtherVector) = delete;
+		ChunkedVector(ChunkedVector&& anOtherVector);
+		~ChunkedVector();
+
+		ChunkedVector& operator=(const ChunkedVector& anOtherVector) = delete;
+		ChunkedVector& operator=(ChunkedVector&& anOtherVector);
+
+		template<class ... Arguments>
+		T& emplace_back(Arguments&& ... someArguments);
+		void push_back(const T& anElement);
+		void push_back(T&& anElement);
+		void pop_back();
+
+		void resize(const size_t aSize);
+		void reserve(const size_t aCapacity);
+		void clear();
+		void shrink_to_fit();//Releases chunks beyond the one holding the last element.
+
+		size_t size() const { return mySize; }
+		size_t capacity() const { return myChunks.size() * elementsPerChunk; }
+		bool empty() const { return mySize == 0; }
+
+		T& operator[](const size_t anIndex);
+		const T& operator[](const size_t anIndex) const;
+
+		T& back();
+		const T& back() const;
+
+		size_t GetChunkCount() const;//Chunks holding at least one element.
+		T* GetChunkData(const size_t aChunkIndex);
+		const T* GetChunkData(const size_t aChunkIndex) const;
+		size_t GetChunkSize(const size_t aChunkIndex) const;
+
+	private:
+		static constexpr size_t GetChunkIndex(const size_t anIndex) { return anIndex / elementsPerChunk; }
+		static constexpr size_t GetChunkOffset(const size_t anIndex) { return anIndex & (elementsPerChunk - 1); }
+
+		T* GetSlot(const size_t anIndex) const;
+		void AssureChunkFor(const size_t anIndex);
+		void ReleaseChunks(const size_t aFirstChunk);
+
+		std::vector<T*> myChunks;
+		size_t mySize = 0;
+	};
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedVector<T, ChunkBytes>::ChunkedVector(ChunkedVector && anOtherVector) : myChunks(std::move(anOtherVector.myChunks)), mySize(anOtherVector.mySize)
+	{
+		anOtherVector.myChunks.clear();
+		anOtherVector.mySize = 0;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedVector<T, ChunkBytes>::~ChunkedVector()
+	{
+		clear();
+		ReleaseChunks(0);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedVector<T, ChunkBytes>& ChunkedVector<T, ChunkBytes>::operator=(ChunkedVector && anOtherVector)
+	{
+		if (this == &anOtherVector)
+			return *this;
+
+		clear();
+		ReleaseChunks(0);
+		myChunks = std::move(anOtherVector.myChunks);
+		mySize = anOtherVector.mySize;
+		anOtherVector.myChunks.clear();
+		anOtherVector.mySize = 0;
+
+		return *this;
+	}
+
+	template<class T, size_t ChunkBytes>
+	template<class ...Arguments>
+	inline T& ChunkedVector<T, ChunkBytes>::emplace_back(Arguments && ...someArguments)
+	{
+		AssureChunkFor(mySize);
+		T* element = new(GetSlot(mySize)) T(std::forward<Arguments>(someArguments)...);
+		++mySize;
+
+		return *element;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::push_back(const T & anElement)
+	{
+		emplace_back(anElement);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::push_back(T && anElement)
+	{
+		emplace_back(std::move(anElement));
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::pop_back()
+	{
+		assert(mySize > 0 && "pop_back on an empty ChunkedVector.");
+		--mySize;
+		GetSlot(mySize)->~T();
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::resize(const size_t aSize)
+	{
+		while (mySize > aSize)
+		{
+			pop_back();
+		}
+
+		reserve(aSize);
+		while (mySize < aSize)
+		{
+			emplace_back();
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::reserve(const size_t aCapacity)
+	{
+		if (aCapacity > 0)
+		{
+			AssureChunkFor(aCapacity - 1);
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::clear()
+	{
+		while (mySize > 0)
+		{
+			pop_back();
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::shrink_to_fit()
+	{
+		ReleaseChunks(GetChunkCount());
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T & ChunkedVector<T, ChunkBytes>::operator[](const size_t anIndex)
+	{
+		assert(anIndex < mySize && "ChunkedVector index out of range.");
+		return *GetSlot(anIndex);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline const T & ChunkedVector<T, ChunkBytes>::operator[](const size_t anIndex) const
+	{
+		assert(anIndex < mySize && "ChunkedVector index out of range.");
+		return *GetSlot(anIndex);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T & ChunkedVector<T, ChunkBytes>::back()
+	{
+		return (*this)[mySize - 1];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline const T & ChunkedVector<T, ChunkBytes>::back() const
+	{
+		return (*this)[mySize - 1];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline size_t ChunkedVector<T, ChunkBytes>::GetChunkCount() const
+	{
+		return (mySize + elementsPerChunk - 1) / elementsPerChunk;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T * ChunkedVector<T, ChunkBytes>::GetChunkData(const size_t aChunkIndex)
+	{
+		return myChunks[aChunkIndex];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline const T * ChunkedVector<T, ChunkBytes>::GetChunkData(const size_t aChunkIndex) const
+	{
+		return myChunks[aChunkIndex];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline size_t ChunkedVector<T, ChunkBytes>::GetChunkSize(const size_t aChunkIndex) const
+	{
+		return (std::min)(elementsPerChunk, mySize - aChunkIndex * elementsPerChunk);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T * ChunkedVector<T, ChunkBytes>::GetSlot(const size_t anIndex) const
+	{
+		return myChunks[GetChunkIndex(anIndex)] + GetChunkOffset(anIndex);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::AssureChunkFor(const size_t anIndex)
+	{
+		const size_t chunkIndex = GetChunkIndex(anIndex);
+		if (chunkIndex < myChunks.size())
+			return;
+
+		while (myChunks.size() <= chunkIndex)
+		{
+			myChunks.push_back(static_cast<T*>(::operator new(elementsPerChunk * sizeof(T), std::align_val_t(chunkAlignment))));
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedVector<T, ChunkBytes>::ReleaseChunks(const size_t aFirstChunk)
+	{
+		for (size_t chunkIndex = aFirstChunk; chunkIndex < myChunks.size(); ++chunkIndex)
+		{
+			::operator delete(myChunks[chunkIndex], std::align_val_t(chunkAlignment));
+		}
+		myChunks.resize((std::min)(aFirstChunk, myChunks.size()));
+	}
+}
+
+namespace CU = CommonUtility;
@@ -0,0 +1,776 @@
+#pragma once
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <assert.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define COLUMNKERNELS_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#define COLUMNKERNELS_TARGET_AVX2
+#define COLUMNKERNELS_TARGET_SSSE3
+#else
+#define COLUMNKERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#define COLUMNKERNELS_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+/*
+	Bulk operations over SoAC columns, meant for ColumnSpans handed out by SoAC::Transform.
+
+		particles.Transform<0, 1>([aDeltaTime](CU::ColumnSpan<float> aPositions, CU::ColumnSpan<const float> aVelocities)
+		{
+			CU::ColumnKernels::Axpy(aDeltaTime, aVelocities, aPositions);
+			CU::ColumnKernels::Clamp(aPositions, -1000.f, 1000.f);
+		});
+
+	Every kernel has a scalar, an SSE2 and an AVX2 implementation. The instruction set is picked at runtime from what the CPU
+	supports, so a build without /arch:AVX2 still runs the AVX2 paths on machines that have it. SetInstructionSet can lower it,
+	e.g. to compare the paths. Loads are unaligned, AlignedSoAC columns only make them faster.
+	CompactByMask is the stream compaction behind SoAC::EraseIf. 4 and 8-byte trivially copyable columns are left-packed with AVX2,
+	or at the SSE2 level with SSSE3's pshufb when the CPU has it(see IsSSSE3Supported). Everything else runs the scalar loop.
+	Float sums are accumulated in lanes(also by the scalar path), so their rounding differs from a sequential loop. Int sums do not overflow, they
+	are accumulated in 64 bits. Min/Max of an empty span return the identity(max/lowest of the type).
+*/
+
+namespace CommonUtility
+{
+	//Contiguous run of one column, what SoAC::Transform hands to a span callable.
+	template<class T>
+	class ColumnSpan
+	{
+	public:
+		ColumnSpan() {}
+		ColumnSpan(T* someData, const size_t aSize) : myData(someData), mySize(aSize) {}
+		template<class U, class = std::enable_if_t<std::is_convertible<U(*)[], T(*)[]>::value>>
+		ColumnSpan(const ColumnSpan<U>& anOther) : myData(anOther.Data()), mySize(anOther.Size()) {}
+
+		inline T& operator[](const size_t anIndex) const { return myData[anIndex]; }
+		inline T* begin() const { return myData; }
+		inline T* end() const { return myData + mySize; }
+		inline T* Data() const { return myData; }
+		inline size_t Size() const { return mySize; }
+
+	private:
+		T* myData = nullptr;
+		size_t mySize = 0;
+	};
+
+	namespace ColumnKernels
+	{
+		enum class InstructionSet
+		{
+			Scalar,
+			SSE2,
+			AVX2
+		};
+
+		InstructionSet GetSupportedInstructionSet();
+		InstructionSet GetInstructionSet();
+		void SetInstructionSet(const InstructionSet anInstructionSet);
+		bool IsSSSE3Supported();//Only CompactByMask needs more than SSE2 at the SSE2 level, it falls back to scalar without SSSE3.
+
+		//someY[i] += aScale * someX[i]
+		void Axpy(const float aScale, const ColumnSpan<const float>& someX, const ColumnSpan<float>& someY);
+
+		float Sum(const ColumnSpan<const float>& someValues);
+		long long Sum(const ColumnSpan<const int>& someValues);
+		float Min(const ColumnSpan<const float>& someValues);
+		int Min(const ColumnSpan<const int>& someValues);
+		float Max(const ColumnSpan<const float>& someValues);
+		int Max(const ColumnSpan<const int>& someValues);
+
+		void Clamp(const ColumnSpan<float>& someValues, const float aMin, const float aMax);
+		void Clamp(const ColumnSpan<int>& someValues, const int aMin, const int aMax);
+
+		//Moves the elements whose bit is set in aKeepMask(bit index % 8 of byte index / 8) to the front, in order. Returns how many were kept.
+		template<class T>
+		size_t CompactByMask(T* someValues, const unsigned char* aKeepMask, const size_t aCount);
+
+		namespace Detail
+		{
+			inline InstructionSet& ActiveInstructionSet()
+			{
+				static InstructionSet instructionSet = GetSupportedInstructionSet();
+				return instructionSet;
+			}
+
+			template<class T>
+			inline T ScalarMin(const T* someValues, const size_t aCount, T aResult)
+			{
+				for (size_t index = 0; index < aCount; ++index)
+				{
+					aResult = (someValues[index] < aResult) ? someValues[index] : aResult;
+				}
+				return aResult;
+			}
+
+			template<class T>
+			inline T ScalarMax(const T* someValues, const size_t aCount, T aResult)
+			{
+				for (size_t index = 0; index < aCount; ++index)
+				{
+					aResult = (aResult < someValues[index]) ? someValues[index] : aResult;
+				}
+				return aResult;
+			}
+
+			template<class T>
+			inline void ScalarClamp(T* someValues, const size_t aCount, const T aMin, const T aMax)
+			{
+				for (size_t index = 0; index < aCount; ++index)
+				{
+					someValues[index] = (std::min)((std::max)(someValues[index], aMin), aMax);
+				}
+			}
+
+			inline void ScalarAxpy(const float aScale, const float* someX, float* someY, const size_t aCount)
+			{
+				for (size_t index = 0; index < aCount; ++index)
+				{
+					someY[index] += aScale * someX[index];
+				}
+			}
+
+			//Accumulates in 8 independent lanes like the vector paths, a single running sum waits on the previous add every element.
+			inline float ScalarSum(const float* someValues, const size_t aCount)
+			{
+				constexpr size_t laneCount = 8;
+				float lanes[laneCount] = {};
+				size_t index = 0;
+				for (; index + laneCount <= aCount; index += laneCount)
+				{
+					for (size_t lane = 0; lane < laneCount; ++lane)
+					{
+						lanes[lane] += someValues[index + lane];
+					}
+				}
+				float sum = ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+				for (; index < aCount; ++index)
+				{
+					sum += someValues[index];
+				}
+				return sum;
+			}
+
+			//Lane indices moving the kept elements of a block to its front, one entry per keep mask of the block.
+			//Lanes are the 32-bit lanes of a 256-bit block for AVX2's permute, or the bytes of a 128-bit block for SSSE3's pshufb.
+			template<unsigned int ElementsPerBlock, unsigned int LaneCount = 8>
+			struct LeftPackTable
+			{
+				unsigned char myLanes[1 << ElementsPerBlock][LaneCount] = {};
+				unsigned char myCounts[1 << ElementsPerBlock] = {};
+			};
+
+			template<unsigned int ElementsPerBlock, unsigned int LaneCount = 8>
+			constexpr LeftPackTable<ElementsPerBlock, LaneCount> BuildLeftPackTable()
+			{
+				constexpr unsigned int lanesPerElement = LaneCount / ElementsPerBlock;
+				LeftPackTable<ElementsPerBlock, LaneCount> table;
+				for (unsigned int mask = 0; mask < (1u << ElementsPerBlock); ++mask)
+				{
+					unsigned int count = 0;
+					for (unsigned int element = 0; element < ElementsPerBlock; ++element)
+					{
+						if ((mask & (1u << element)) != 0)
+						{
+							for (unsigned int lane = 0; lane < lanesPerElement; ++lane)
+							{
+								table.myLanes[mask][count * lanesPerElement + lane] = static_cast<unsigned char>(element * lanesPerElement + lane);
+							}
+							++count;
+						}
+					}
+					table.myCounts[mask] = static_cast<unsigned char>(count);
+				}
+				return table;
+			}
+
+			inline constexpr LeftPackTable<8> leftPackTable32 = BuildLeftPackTable<8>();
+			inline constexpr LeftPackTable<4> leftPackTable64 = BuildLeftPackTable<4>();
+			inline constexpr LeftPackTable<4, 16> shuffleTable32 = BuildLeftPackTable<4, 16>();
+			inline constexpr LeftPackTable<2, 16> shuffleTable64 = BuildLeftPackTable<2, 16>();
+
+#if defined(COLUMNKERNELS_X64)
+			//SSE2 has no 32-bit integer min/max, select through a compare mask instead.
+			inline __m128i SelectSSE2(const __m128i aMask, const __m128i anIfSet, const __m128i anIfClear)
+			{
+				return _mm_or_si128(_mm_and_si128(aMask, anIfSet), _mm_andnot_si128(aMask, anIfClear));
+			}
+
+			inline float HorizontalSumSSE2(const __m128 someValues)
+			{
+				const __m128 pairs = _mm_add_ps(someValues, _mm_movehl_ps(someValues, someValues));
+				return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+			}
+
+			inline void AxpySSE2(const float aScale, const float* someX, float* someY, const size_t aCount)
+			{
+				const __m128 scale = _mm_set1_ps(aScale);
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					_mm_storeu_ps(someY + index, _mm_add_ps(_mm_loadu_ps(someY + index), _mm_mul_ps(_mm_loadu_ps(someX + index), scale)));
+				}
+				for (; index < aCount; ++index)
+				{
+					someY[index] += aScale * someX[index];
+				}
+			}
+
+			inline float SumSSE2(const float* someValues, const size_t aCount)
+			{
+				__m128 first = _mm_setzero_ps();
+				__m128 second = _mm_setzero_ps();
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					first = _mm_add_ps(first, _mm_loadu_ps(someValues + index));
+					second = _mm_add_ps(second, _mm_loadu_ps(someValues + index + 4));
+				}
+				float sum = HorizontalSumSSE2(_mm_add_ps(first, second));
+				for (; index < aCount; ++index)
+				{
+					sum += someValues[index];
+				}
+				return sum;
+			}
+
+			inline long long SumSSE2(const int* someValues, const size_t aCount)
+			{
+				//Sign extends each int to 64 bits by interleaving it with its sign mask.
+				__m128i sum = _mm_setzero_si128();
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + index));
+					const __m128i signs = _mm_srai_epi32(values, 31);
+					sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(values, signs), _mm_unpackhi_epi32(values, signs)));
+				}
+				alignas(16) long long lanes[2];
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+				long long result = lanes[0] + lanes[1];
+				for (; index < aCount; ++index)
+				{
+					result += someValues[index];
+				}
+				return result;
+			}
+
+			inline float MinSSE2(const float* someValues, const size_t aCount)
+			{
+				__m128 result = _mm_set1_ps((std::numeric_limits<float>::max)());
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					result = _mm_min_ps(result, _mm_loadu_ps(someValues + index));
+				}
+				alignas(16) float lanes[4];
+				_mm_store_ps(lanes, result);
+				return ScalarMin(someValues + index, aCount - index, ScalarMin(lanes, 4, lanes[0]));
+			}
+
+			inline float MaxSSE2(const float* someValues, const size_t aCount)
+			{
+				__m128 result = _mm_set1_ps(std::numeric_limits<float>::lowest());
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					result = _mm_max_ps(result, _mm_loadu_ps(someValues + index));
+				}
+				alignas(16) float lanes[4];
+				_mm_store_ps(lanes, result);
+				return ScalarMax(someValues + index, aCount - index, ScalarMax(lanes, 4, lanes[0]));
+			}
+
+			inline int MinSSE2(const int* someValues, const size_t aCount)
+			{
+				__m128i result = _mm_set1_epi32((std::numeric_limits<int>::max)());
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + index));
+					result = SelectSSE2(_mm_cmplt_epi32(values, result), values, result);
+				}
+				alignas(16) int lanes[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes), result);
+				return ScalarMin(someValues + index, aCount - index, ScalarMin(lanes, 4, lanes[0]));
+			}
+
+			inline int MaxSSE2(const int* someValues, const size_t aCount)
+			{
+				__m128i result = _mm_set1_epi32(std::numeric_limits<int>::lowest());
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + index));
+					result = SelectSSE2(_mm_cmpgt_epi32(values, result), values, result);
+				}
+				alignas(16) int lanes[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes), result);
+				return ScalarMax(someValues + index, aCount - index, ScalarMax(lanes, 4, lanes[0]));
+			}
+
+			inline void ClampSSE2(float* someValues, const size_t aCount, const float aMin, const float aMax)
+			{
+				const __m128 minimum = _mm_set1_ps(aMin);
+				const __m128 maximum = _mm_set1_ps(aMax);
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					_mm_storeu_ps(someValues + index, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(someValues + index), minimum), maximum));
+				}
+				ScalarClamp(someValues + index, aCount - index, aMin, aMax);
+			}
+
+			inline void ClampSSE2(int* someValues, const size_t aCount, const int aMin, const int aMax)
+			{
+				const __m128i minimum = _mm_set1_epi32(aMin);
+				const __m128i maximum = _mm_set1_epi32(aMax);
+				size_t index = 0;
+				for (; index + 4 <= aCount; index += 4)
+				{
+					__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + index));
+					values = SelectSSE2(_mm_cmplt_epi32(values, minimum), minimum, values);
+					values = SelectSSE2(_mm_cmpgt_epi32(values, maximum), maximum, values);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(someValues + index), values);
+				}
+				ScalarClamp(someValues + index, aCount - index, aMin, aMax);
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline void AxpyAVX2(const float aScale, const float* someX, float* someY, const size_t aCount)
+			{
+				const __m256 scale = _mm256_set1_ps(aScale);
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					_mm256_storeu_ps(someY + index, _mm256_add_ps(_mm256_loadu_ps(someY + index), _mm256_mul_ps(_mm256_loadu_ps(someX + index), scale)));
+				}
+				for (; index < aCount; ++index)
+				{
+					someY[index] += aScale * someX[index];
+				}
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline float SumAVX2(const float* someValues, const size_t aCount)
+			{
+				__m256 first = _mm256_setzero_ps();
+				__m256 second = _mm256_setzero_ps();
+				size_t index = 0;
+				for (; index + 16 <= aCount; index += 16)
+				{
+					first = _mm256_add_ps(first, _mm256_loadu_ps(someValues + index));
+					second = _mm256_add_ps(second, _mm256_loadu_ps(someValues + index + 8));
+				}
+				const __m256 sums = _mm256_add_ps(first, second);
+				float sum = HorizontalSumSSE2(_mm_add_ps(_mm256_castps256_ps128(sums), _mm256_extractf128_ps(sums, 1)));
+				for (; index < aCount; ++index)
+				{
+					sum += someValues[index];
+				}
+				return sum;
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline long long SumAVX2(const int* someValues, const size_t aCount)
+			{
+				__m256i sum = _mm256_setzero_si256();
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + index));
+					const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + index + 4));
+					sum = _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_cvtepi32_epi64(low), _mm256_cvtepi32_epi64(high)));
+				}
+				alignas(32) long long lanes[4];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+				long long result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+				for (; index < aCount; ++index)
+				{
+					result += someValues[index];
+				}
+				return result;
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline float MinAVX2(const float* someValues, const size_t aCount)
+			{
+				__m256 result = _mm256_set1_ps((std::numeric_limits<float>::max)());
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					result = _mm256_min_ps(result, _mm256_loadu_ps(someValues + index));
+				}
+				alignas(32) float lanes[8];
+				_mm256_store_ps(lanes, result);
+				return ScalarMin(someValues + index, aCount - index, ScalarMin(lanes, 8, lanes[0]));
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline float MaxAVX2(const float* someValues, const size_t aCount)
+			{
+				__m256 result = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					result = _mm256_max_ps(result, _mm256_loadu_ps(someValues + index));
+				}
+				alignas(32) float lanes[8];
+				_mm256_store_ps(lanes, result);
+				return ScalarMax(someValues + index, aCount - index, ScalarMax(lanes, 8, lanes[0]));
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline int MinAVX2(const int* someValues, const size_t aCount)
+			{
+				__m256i result = _mm256_set1_epi32((std::numeric_limits<int>::max)());
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					result = _mm256_min_epi32(result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(someValues + index)));
+				}
+				alignas(32) int lanes[8];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), result);
+				return ScalarMin(someValues + index, aCount - index, ScalarMin(lanes, 8, lanes[0]));
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline int MaxAVX2(const int* someValues, const size_t aCount)
+			{
+				__m256i result = _mm256_set1_epi32(std::numeric_limits<int>::lowest());
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					result = _mm256_max_epi32(result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(someValues + index)));
+				}
+				alignas(32) int lanes[8];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), result);
+				return ScalarMax(someValues + index, aCount - index, ScalarMax(lanes, 8, lanes[0]));
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline void ClampAVX2(float* someValues, const size_t aCount, const float aMin, const float aMax)
+			{
+				const __m256 minimum = _mm256_set1_ps(aMin);
+				const __m256 maximum = _mm256_set1_ps(aMax);
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					_mm256_storeu_ps(someValues + index, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(someValues + index), minimum), maximum));
+				}
+				ScalarClamp(someValues + index, aCount - index, aMin, aMax);
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline void ClampAVX2(int* someValues, const size_t aCount, const int aMin, const int aMax)
+			{
+				const __m256i minimum = _mm256_set1_epi32(aMin);
+				const __m256i maximum = _mm256_set1_epi32(aMax);
+				size_t index = 0;
+				for (; index + 8 <= aCount; index += 8)
+				{
+					__m256i* values = reinterpret_cast<__m256i*>(someValues + index);
+					_mm256_storeu_si256(values, _mm256_min_epi32(_mm256_max_epi32(_mm256_loadu_si256(values), minimum), maximum));
+				}
+				ScalarClamp(someValues + index, aCount - index, aMin, aMax);
+			}
+
+			//Left-packs whole 8 element blocks from aRead on, returns the write position. A block is stored whole at the write position,
+			//which never passes the read position, so the lanes past the kept ones only land on elements already read.
+			COLUMNKERNELS_TARGET_AVX2 inline size_t LeftPack32AVX2(char* someValues, const unsigned char* aKeepMask, size_t aRead, size_t aWrite, const size_t aCount)
+			{
+				for (; aRead + 8 <= aCount; aRead += 8)
+				{
+					const unsigned int mask = aKeepMask[aRead / 8];
+					const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(someValues + aRead * 4));
+					const __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(leftPackTable32.myLanes[mask])));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(someValues + aWrite * 4), _mm256_permutevar8x32_epi32(values, lanes));
+					aWrite += leftPackTable32.myCounts[mask];
+				}
+				return aWrite;
+			}
+
+			COLUMNKERNELS_TARGET_AVX2 inline size_t LeftPack64AVX2(char* someValues, const unsigned char* aKeepMask, size_t aRead, size_t aWrite, const size_t aCount)
+			{
+				for (; aRead + 8 <= aCount; aRead += 8)
+				{
+					const unsigned int mask = aKeepMask[aRead / 8];
+					for (unsigned int half = 0; half < 2; ++half)
+					{
+						const unsigned int halfMask = (mask >> (half * 4)) & 0xF;
+						const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(someValues + (aRead + half * 4) * 8));
+						const __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(leftPackTable64.myLanes[halfMask])));
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(someValues + aWrite * 8), _mm256_permutevar8x32_epi32(values, lanes));
+						aWrite += leftPackTable64.myCounts[halfMask];
+					}
+				}
+				return aWrite;
+			}
+
+			//The 128-bit counterpart of LeftPack32AVX2/LeftPack64AVX2, each 8 element block is packed in 16-byte parts.
+			template<unsigned int ElementsPerPart>
+			COLUMNKERNELS_TARGET_SSSE3 inline size_t LeftPackSSSE3(char* someValues, const unsigned char* aKeepMask, size_t aRead, size_t aWrite, const size_t aCount, const LeftPackTable<ElementsPerPart, 16>& aTable)
+			{
+				constexpr size_t elementBytes = 16 / ElementsPerPart;
+				constexpr unsigned int partMask = (1u << ElementsPerPart) - 1;
+				for (; aRead + 8 <= aCount; aRead += 8)
+				{
+					const unsigned int mask = aKeepMask[aRead / 8];
+					for (unsigned int part = 0; part < 8 / ElementsPerPart; ++part)
+					{
+						const unsigned int keptMask = (mask >> (part * ElementsPerPart)) & partMask;
+						const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(someValues + (aRead + part * ElementsPerPart) * elementBytes));
+						const __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aTable.myLanes[keptMask]));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(someValues + aWrite * elementBytes), _mm_shuffle_epi8(values, lanes));
+						aWrite += aTable.myCounts[keptMask];
+					}
+				}
+				return aWrite;
+			}
+#endif
+		}
+
+		inline InstructionSet GetSupportedInstructionSet()
+		{
+#if defined(COLUMNKERNELS_X64)
+#ifdef _MSC_VER
+			//AVX2 needs the CPU flag(leaf 7, EBX bit 5) and the OS saving the YMM registers(OSXSAVE, XCR0 bits 1 and 2).
+			int registers[4];
+			__cpuid(registers, 1);
+			const bool hasOSXSave = (registers[2] & (1 << 27)) != 0;
+			__cpuidex(registers, 7, 0);
+			const bool hasAVX2 = hasOSXSave && ((registers[1] & (1 << 5)) != 0) && ((_xgetbv(0) & 0x6) == 0x6);
+#else
+			const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+			return hasAVX2 ? InstructionSet::AVX2 : InstructionSet::SSE2;
+#else
+			return InstructionSet::Scalar;
+#endif
+		}
+
+		inline bool IsSSSE3Supported()
+		{
+#if defined(COLUMNKERNELS_X64)
+#ifdef _MSC_VER
+			int registers[4];
+			__cpuid(registers, 1);
+			return (registers[2] & (1 << 9)) != 0;
+#else
+			return __builtin_cpu_supports("ssse3");
+#endif
+#else
+			return false;
+#endif
+		}
+
+		inline InstructionSet GetInstructionSet()
+		{
+			return Detail::ActiveInstructionSet();
+		}
+
+		//Selects anInstructionSet, or the best supported one below it.
+		inline void SetInstructionSet(const InstructionSet anInstructionSet)
+		{
+			Detail::ActiveInstructionSet() = (std::min)(anInstructionSet, GetSupportedInstructionSet());
+		}
+
+		inline void Axpy(const float aScale, const ColumnSpan<const float>& someX, const ColumnSpan<float>& someY)
+		{
+			assert(someX.Size() == someY.Size() && "Axpy spans differ in size.");
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: Detail::AxpyAVX2(aScale, someX.Data(), someY.Data(), someY.Size()); return;
+			case InstructionSet::SSE2: Detail::AxpySSE2(aScale, someX.Data(), someY.Data(), someY.Size()); return;
+			default: break;
+			}
+#endif
+			Detail::ScalarAxpy(aScale, someX.Data(), someY.Data(), someY.Size());
+		}
+
+		inline float Sum(const ColumnSpan<const float>& someValues)
+		{
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: return Detail::SumAVX2(someValues.Data(), someValues.Size());
+			case InstructionSet::SSE2: return Detail::SumSSE2(someValues.Data(), someValues.Size());
+			default: break;
+			}
+#endif
+			return Detail::ScalarSum(someValues.Data(), someValues.Size());
+		}
+
+		inline long long Sum(const ColumnSpan<const int>& someValues)
+		{
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: return Detail::SumAVX2(someValues.Data(), someValues.Size());
+			case InstructionSet::SSE2: return Detail::SumSSE2(someValues.Data(), someValues.Size());
+			default: break;
+			}
+#endif
+			long long sum = 0;
+			for (const int value : someValues)
+			{
+				sum += value;
+			}
+			return sum;
+		}
+
+		inline float Min(const ColumnSpan<const float>& someValues)
+		{
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: return Detail::MinAVX2(someValues.Data(), someValues.Size());
+			case InstructionSet::SSE2: return Detail::MinSSE2(someValues.Data(), someValues.Size());
+			default: break;
+			}
+#endif
+			return Detail::ScalarMin(someValues.Data(), someValues.Size(), (std::numeric_limits<float>::max)());
+		}
+
+		inline int Min(const ColumnSpan<const int>& someValues)
+		{
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: return Detail::MinAVX2(someValues.Data(), someValues.Size());
+			case InstructionSet::SSE2: return Detail::MinSSE2(someValues.Data(), someValues.Size());
+			default: break;
+			}
+#endif
+			return Detail::ScalarMin(someValues.Data(), someValues.Size(), (std::numeric_limits<int>::max)());
+		}
+
+		inline float Max(const ColumnSpan<const float>& someValues)
+		{
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: return Detail::MaxAVX2(someValues.Data(), someValues.Size());
+			case InstructionSet::SSE2: return Detail::MaxSSE2(someValues.Data(), someValues.Size());
+			default: break;
+			}
+#endif
+			return Detail::ScalarMax(someValues.Data(), someValues.Size(), std::numeric_limits<float>::lowest());
+		}
+
+		inline int Max(const ColumnSpan<const int>& someValues)
+		{
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: return Detail::MaxAVX2(someValues.Data(), someValues.Size());
+			case InstructionSet::SSE2: return Detail::MaxSSE2(someValues.Data(), someValues.Size());
+			default: break;
+			}
+#endif
+			return Detail::ScalarMax(someValues.Data(), someValues.Size(), std::numeric_limits<int>::lowest());
+		}
+
+		inline void Clamp(const ColumnSpan<float>& someValues, const float aMin, const float aMax)
+		{
+			assert(!(aMax < aMin) && "Clamp range is inverted.");
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: Detail::ClampAVX2(someValues.Data(), someValues.Size(), aMin, aMax); return;
+			case InstructionSet::SSE2: Detail::ClampSSE2(someValues.Data(), someValues.Size(), aMin, aMax); return;
+			default: break;
+			}
+#endif
+			Detail::ScalarClamp(someValues.Data(), someValues.Size(), aMin, aMax);
+		}
+
+		inline void Clamp(const ColumnSpan<int>& someValues, const int aMin, const int aMax)
+		{
+			assert(!(aMax < aMin) && "Clamp range is inverted.");
+#if defined(COLUMNKERNELS_X64)
+			switch (GetInstructionSet())
+			{
+			case InstructionSet::AVX2: Detail::ClampAVX2(someValues.Data(), someValues.Size(), aMin, aMax); return;
+			case InstructionSet::SSE2: Detail::ClampSSE2(someValues.Data(), someValues.Size(), aMin, aMax); return;
+			default: break;
+			}
+#endif
+			Detail::ScalarClamp(someValues.Data(), someValues.Size(), aMin, aMax);
+		}
+
+		template<class T>
+		inline size_t CompactByMask(T* someValues, const unsigned char* aKeepMask, const size_t aCount)
+		{
+			//Elements before the first block with a removed element are already in place.
+			size_t read = 0;
+			while ((read + 8 <= aCount) && (aKeepMask[read / 8] == 0xFF))
+			{
+				read += 8;
+			}
+			size_t write = read;
+
+			if constexpr (std::is_trivially_copyable<T>::value)
+			{
+#if defined(COLUMNKERNELS_X64)
+				if constexpr ((sizeof(T) == 4) || (sizeof(T) == 8))
+				{
+					static const bool hasSSSE3 = IsSSSE3Supported();
+					char* bytes = reinterpret_cast<char*>(someValues);
+					if (GetInstructionSet() == InstructionSet::AVX2)
+					{
+						write = (sizeof(T) == 4) ? Detail::LeftPack32AVX2(bytes, aKeepMask, read, write, aCount) : Detail::LeftPack64AVX2(bytes, aKeepMask, read, write, aCount);
+						read = (std::max)(read, aCount & ~static_cast<size_t>(7));
+					}
+					else if ((GetInstructionSet() == InstructionSet::SSE2) && hasSSSE3)
+					{
+						write = (sizeof(T) == 4) ? Detail::LeftPackSSSE3(bytes, aKeepMask, read, write, aCount, Detail::shuffleTable32) : Detail::LeftPackSSSE3(bytes, aKeepMask, read, write, aCount, Detail::shuffleTable64);
+						read = (std::max)(read, aCount & ~static_cast<size_t>(7));
+					}
+				}
+#endif
+				//Whole kept blocks are copied and whole removed ones skipped, mixed blocks are branchless: every element is copied
+				//and the write position only advances past kept ones.
+				for (; read + 8 <= aCount; read += 8)
+				{
+					const unsigned int mask = aKeepMask[read / 8];
+					if (mask == 0xFF)
+					{
+						for (size_t element = 0; element < 8; ++element)
+						{
+							someValues[write + element] = someValues[read + element];
+						}
+						write += 8;
+					}
+					else if (mask != 0)
+					{
+						for (size_t element = 0; element < 8; ++element)
+						{
+							someValues[write] = someValues[read + element];
+							write += (mask >> element) & 1;
+						}
+					}
+				}
+				for (; read < aCount; ++read)
+				{
+					someValues[write] = someValues[read];
+					write += (aKeepMask[read / 8] >> (read % 8)) & 1;
+				}
+			}
+			else
+			{
+				for (; read < aCount; ++read)
+				{
+					if (((aKeepMask[read / 8] >> (read % 8)) & 1) != 0)
+					{
+						if (write != read)
+						{
+							someValues[write] = std::move(someValues[read]);
+						}
+						++write;
+					}
+				}
+			}
+			return write;
+		}
+	}
+}
+
+namespace CU = CommonUtility;
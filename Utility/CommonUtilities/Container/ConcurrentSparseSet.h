@@ -0,0 +1,385 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <assert.h>
+
+#include "SparseSet.h"
+
+/*
+	SparseSet variant for one writer thread and any amount of reader threads.
+	IsValid/Find/Size are lock-free and may run concurrently with Add/RemoveCyclic/Clear, which must all run on the same thread.
+
+	The sparse side is a page directory sized once at construction, pages are allocated on first use and never moved or freed
+	before the set is destroyed, so a reader never sees a slot move under it.
+	The dense side grows by copying into a larger buffer. The old buffer is retired and only deleted once every reader that
+	could still hold it has left, tracked with two epoch counters(epoch based reclamation):
+	- A reader enters by incrementing the counter of the current epoch's parity, and leaves by decrementing it.
+	  Counters are striped over cache lines by thread so readers on different cores don't contend on one line.
+	- The writer only advances the epoch once the counters of the previous parity have drained,
+	  so a buffer retired in epoch E is unreachable once the epoch reaches E + 2.
+
+	Membership(IsValid) is exact at the moment the reader loads the element's slot. Indexers that compare the dense element reload
+	the slot when it doesn't match, and retry if it changed, so an element moved by RemoveCyclic never reads as missing.
+	The dense index returned by Find may be stale by the time it is used if the writer moves that element,
+	readers should only rely on it after synchronising with the writer.
+*/
+
+namespace CommonUtility
+{
+	template<class T = unsigned int, class SparseIndexer = SparseIdentity<T>>
+	class ConcurrentSparseSet
+	{
+	public:
+		static constexpr T failureIndex = std::numeric_limits<T>::max();
+		static constexpr size_t pageSize = 1024;//Slots per sparse page, must be a power of two.
+
+		//Elements must map to a sparse index of at most aMaxSparseIndex, the default covers every entity index of EntityTraits<unsigned int>.
+		ConcurrentSparseSet(const size_t aMaxSparseIndex = (1 << 20) - 1);
+		ConcurrentSparseSet(const ConcurrentSparseSet& anOtherSet) = delete;
+		ConcurrentSparseSet& operator=(const ConcurrentSparseSet& anOtherSet) = delete;
+		~ConcurrentSparseSet();
+
+		//Writer thread only.
+		bool Add(const T anElement);//Returns false and adds nothing when the element maps past the max sparse index.
+		void RemoveCyclic(const T anElement);//Swaps the last element into the removed element's place.
+		void Clear();//Keeps the pages and the dense buffer, so no memory is handed back while readers may be active.
+		void Reserve(const size_t aCapacity);
+		T operator[](const size_t aDenseIndex) const;//Readers are not registered here, so the dense buffer could be reclaimed under them.
+
+		//Any thread.
+		bool IsValid(const T anElement) const;
+		T Find(const T anElement) const;
+		size_t Size() const;
+
+		size_t GetRetiredBufferCount() const;//Writer thread only, dense buffers waiting for readers to leave.
+
+	private:
+		static_assert((pageSize & (pageSize - 1)) == 0, "ConcurrentSparseSet pageSize must be a power of two.");
+
+		using Slot = std::atomic<T>;
+
+		struct DenseBuffer
+		{
+			DenseBuffer(const size_t aCapacity) : myCapacity(aCapacity), myElements(std::make_unique<std::atomic<T>[]>(aCapacity)) {}
+
+			const size_t myCapacity;
+			std::unique_ptr<std::atomic<T>[]> myElements;
+		};
+
+		static constexpr size_t readerStripeCount = 16;
+
+		struct alignas(64) ReaderStripe
+		{
+			std::atomic<size_t> myActiveReaders[2] = { {0}, {0} };
+		};
+
+		struct RetiredBuffer
+		{
+			DenseBuffer* myBuffer;
+			unsigned long long myEpoch;
+		};
+
+		//Keeps the calling reader registered in the epoch it entered for as long as it lives.
+		class ReadGuard
+		{
+		public:
+			ReadGuard(const ConcurrentSparseSet& aSet);
+			~ReadGuard();
+
+		private:
+			std::atomic<size_t>* myActiveReaders;
+			unsigned long long myEpoch;
+		};
+
+		static constexpr size_t GetPageIndex(const T anElement) { return static_cast<size_t>(SparseIndexer::ToSparse(anElement)) / pageSize; }
+		static constexpr size_t GetPageOffset(const T anElement) { return static_cast<size_t>(SparseIndexer::ToSparse(anElement)) & (pageSize - 1); }
+
+		Slot& AssureSparseSlot(const T anElement);
+		Slot& GetSparseSlot(const T anElement) const;
+		void Grow(const size_t aCapacity);
+		void Reclaim();
+		static size_t GetReaderStripeIndex();
+
+		std::unique_ptr<std::atomic<Slot*>[]> myPageDirectory;
+		const size_t myPageCount;
+		std::atomic<DenseBuffer*> myDenseBuffer;
+		std::atomic<size_t> mySize;
+
+		mutable std::atomic<unsigned long long> myEpoch;
+		mutable ReaderStripe myReaderStripes[readerStripeCount];
+		std::vector<RetiredBuffer> myRetiredBuffers;
+	};
+
+	template<class T, class SparseIndexer>
+	inline ConcurrentSparseSet<T, SparseIndexer>::ConcurrentSparseSet(const size_t aMaxSparseIndex)
+		: myPageDirectory(std::make_unique<std::atomic<Slot*>[]>(aMaxSparseIndex / pageSize + 1))
+		, myPageCount(aMaxSparseIndex / pageSize + 1)
+		, myDenseBuffer(new DenseBuffer(64))
+		, mySize(0)
+		, myEpoch(0)
+	{
+		for (size_t pageIndex = 0; pageIndex < myPageCount; ++pageIndex)
+		{
+			myPageDirectory[pageIndex].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline ConcurrentSparseSet<T, SparseIndexer>::~ConcurrentSparseSet()
+	{
+		for (size_t pageIndex = 0; pageIndex < myPageCount; ++pageIndex)
+		{
+			delete[] myPageDirectory[pageIndex].load(std::memory_order_relaxed);
+		}
+
+		for (const RetiredBuffer& retiredBuffer : myRetiredBuffers)
+		{
+			delete retiredBuffer.myBuffer;
+		}
+		delete myDenseBuffer.load(std::memory_order_relaxed);
+	}
+
+	template<class T, class SparseIndexer>
+	inline bool ConcurrentSparseSet<T, SparseIndexer>::Add(const T anElement)
+	{
+		assert(!IsValid(anElement) && "Identifier has already been added to sparse set before. Duplicate elements are not allowed.");
+
+		//The page directory can't grow under readers, so the bound is checked in release as well.
+		if (GetPageIndex(anElement) >= myPageCount)
+			return false;
+
+		const size_t denseIndex = mySize.load(std::memory_order_relaxed);
+		DenseBuffer* buffer = myDenseBuffer.load(std::memory_order_relaxed);
+		if (denseIndex == buffer->myCapacity)
+		{
+			Grow(buffer->myCapacity * 2);
+			buffer = myDenseBuffer.load(std::memory_order_relaxed);
+		}
+
+		buffer->myElements[denseIndex].store(anElement, std::memory_order_release);
+		AssureSparseSlot(anElement).store(static_cast<T>(denseIndex), std::memory_order_release);
+		mySize.store(denseIndex + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<class T, class SparseIndexer>
+	inline void ConcurrentSparseSet<T, SparseIndexer>::RemoveCyclic(const T anElement)
+	{
+		assert(IsValid(anElement) && "Element not valid, could not RemoveCyclic element.");
+
+		DenseBuffer* buffer = myDenseBuffer.load(std::memory_order_relaxed);
+		const size_t lastDenseIndex = mySize.load(std::memory_order_relaxed) - 1;
+		Slot& slot = GetSparseSlot(anElement);
+		const T denseIndex = slot.load(std::memory_order_relaxed);
+
+		//The last element is published in its new place before the removed one disappears, so it never reads as missing.
+		const T lastElement = buffer->myElements[lastDenseIndex].load(std::memory_order_relaxed);
+		buffer->myElements[denseIndex].store(lastElement, std::memory_order_release);
+		GetSparseSlot(lastElement).store(denseIndex, std::memory_order_release);
+		slot.store(failureIndex, std::memory_order_release);
+		mySize.store(lastDenseIndex, std::memory_order_release);
+
+		Reclaim();
+	}
+
+	template<class T, class SparseIndexer>
+	inline void ConcurrentSparseSet<T, SparseIndexer>::Clear()
+	{
+		DenseBuffer* buffer = myDenseBuffer.load(std::memory_order_relaxed);
+		const size_t size = mySize.load(std::memory_order_relaxed);
+		for (size_t denseIndex = 0; denseIndex < size; ++denseIndex)
+		{
+			GetSparseSlot(buffer->myElements[denseIndex].load(std::memory_order_relaxed)).store(failureIndex, std::memory_order_release);
+		}
+		mySize.store(0, std::memory_order_release);
+
+		Reclaim();
+	}
+
+	template<class T, class SparseIndexer>
+	inline void ConcurrentSparseSet<T, SparseIndexer>::Reserve(const size_t aCapacity)
+	{
+		if (aCapacity > myDenseBuffer.load(std::memory_order_relaxed)->myCapacity)
+		{
+			Grow(aCapacity);
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline T ConcurrentSparseSet<T, SparseIndexer>::operator[](const size_t aDenseIndex) const
+	{
+		assert(aDenseIndex < Size() && "ConcurrentSparseSet dense index out of range.");
+		return myDenseBuffer.load(std::memory_order_acquire)->myElements[aDenseIndex].load(std::memory_order_relaxed);
+	}
+
+	template<class T, class SparseIndexer>
+	inline bool ConcurrentSparseSet<T, SparseIndexer>::IsValid(const T anElement) const
+	{
+		return Find(anElement) != failureIndex;
+	}
+
+	template<class T, class SparseIndexer>
+	inline T ConcurrentSparseSet<T, SparseIndexer>::Find(const T anElement) const
+	{
+		const size_t pageIndex = GetPageIndex(anElement);
+		if (pageIndex >= myPageCount)
+			return failureIndex;
+
+		const Slot* page = myPageDirectory[pageIndex].load(std::memory_order_acquire);
+		if (page == nullptr)
+			return failureIndex;
+
+		if constexpr (SparseIndexer::isIdentity)
+		{
+			return page[GetPageOffset(anElement)].load(std::memory_order_acquire);
+		}
+		else
+		{
+			//Only the dense buffer needs protecting, pages are never freed while the set lives.
+			ReadGuard guard(*this);
+			const Slot& slot = page[GetPageOffset(anElement)];
+			T denseIndex = slot.load(std::memory_order_acquire);
+			for (;;)
+			{
+				if (denseIndex == failureIndex)
+					return failureIndex;
+
+				const DenseBuffer* buffer = myDenseBuffer.load(std::memory_order_acquire);
+				if ((denseIndex < buffer->myCapacity) && (buffer->myElements[denseIndex].load(std::memory_order_acquire) == anElement))
+					return denseIndex;
+
+				//Another element in the dense slot can also mean this one was moved after its slot was loaded and Add reused the old place.
+				//A moved element's slot was stored before that Add, so it only counts as missing when its slot still holds the same index.
+				const T reloadedIndex = slot.load(std::memory_order_acquire);
+				if (reloadedIndex == denseIndex)
+					return failureIndex;
+
+				denseIndex = reloadedIndex;
+			}
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t ConcurrentSparseSet<T, SparseIndexer>::Size() const
+	{
+		return mySize.load(std::memory_order_acquire);
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t ConcurrentSparseSet<T, SparseIndexer>::GetRetiredBufferCount() const
+	{
+		return myRetiredBuffers.size();
+	}
+
+	template<class T, class SparseIndexer>
+	inline ConcurrentSparseSet<T, SparseIndexer>::ReadGuard::ReadGuard(const ConcurrentSparseSet& aSet)
+	{
+		//Re-checking the epoch after registering makes sure the writer saw the registration before it could advance twice.
+		ReaderStripe& stripe = aSet.myReaderStripes[GetReaderStripeIndex()];
+		for (;;)
+		{
+			myEpoch = aSet.myEpoch.load();
+			myActiveReaders = &stripe.myActiveReaders[myEpoch & 1];
+			myActiveReaders->fetch_add(1);
+			if (aSet.myEpoch.load() == myEpoch)
+				break;
+
+			myActiveReaders->fetch_sub(1);
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline ConcurrentSparseSet<T, SparseIndexer>::ReadGuard::~ReadGuard()
+	{
+		myActiveReaders->fetch_sub(1);
+	}
+
+	template<class T, class SparseIndexer>
+	inline typename ConcurrentSparseSet<T, SparseIndexer>::Slot& ConcurrentSparseSet<T, SparseIndexer>::AssureSparseSlot(const T anElement)
+	{
+		const size_t pageIndex = GetPageIndex(anElement);
+		assert(pageIndex < myPageCount && "Element exceeds the max sparse index the ConcurrentSparseSet was constructed with.");
+
+		Slot* page = myPageDirectory[pageIndex].load(std::memory_order_relaxed);
+		if (page == nullptr)
+		{
+			page = new Slot[pageSize];
+			for (size_t offset = 0; offset < pageSize; ++offset)
+			{
+				page[offset].store(failureIndex, std::memory_order_relaxed);
+			}
+			myPageDirectory[pageIndex].store(page, std::memory_order_release);
+		}
+
+		return page[GetPageOffset(anElement)];
+	}
+
+	template<class T, class SparseIndexer>
+	inline typename ConcurrentSparseSet<T, SparseIndexer>::Slot& ConcurrentSparseSet<T, SparseIndexer>::GetSparseSlot(const T anElement) const
+	{
+		return myPageDirectory[GetPageIndex(anElement)].load(std::memory_order_relaxed)[GetPageOffset(anElement)];
+	}
+
+	template<class T, class SparseIndexer>
+	inline void ConcurrentSparseSet<T, SparseIndexer>::Grow(const size_t aCapacity)
+	{
+		DenseBuffer* oldBuffer = myDenseBuffer.load(std::memory_order_relaxed);
+		DenseBuffer* newBuffer = new DenseBuffer(aCapacity);
+		const size_t size = mySize.load(std::memory_order_relaxed);
+		for (size_t denseIndex = 0; denseIndex < size; ++denseIndex)
+		{
+			newBuffer->myElements[denseIndex].store(oldBuffer->myElements[denseIndex].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		myDenseBuffer.store(newBuffer, std::memory_order_release);
+		myRetiredBuffers.push_back({ oldBuffer, myEpoch.load() });
+		Reclaim();
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t ConcurrentSparseSet<T, SparseIndexer>::GetReaderStripeIndex()
+	{
+		static thread_local const size_t stripeIndex = std::hash<std::thread::id>()(std::this_thread::get_id()) % readerStripeCount;
+		return stripeIndex;
+	}
+
+	template<class T, class SparseIndexer>
+	inline void ConcurrentSparseSet<T, SparseIndexer>::Reclaim()
+	{
+		if (myRetiredBuffers.empty())
+			return;
+
+		//Readers of the previous epoch have all left, so nobody can still register there once the epoch moves on.
+		const unsigned long long epoch = myEpoch.load();
+		bool hasDrained = true;
+		for (size_t stripeIndex = 0; (stripeIndex < readerStripeCount) && hasDrained; ++stripeIndex)
+		{
+			hasDrained = (myReaderStripes[stripeIndex].myActiveReaders[(epoch + 1) & 1].load() == 0);
+		}
+		if (hasDrained)
+		{
+			myEpoch.store(epoch + 1);
+		}
+
+		const unsigned long long currentEpoch = myEpoch.load();
+		size_t keptCount = 0;
+		for (const RetiredBuffer& retiredBuffer : myRetiredBuffers)
+		{
+			if ((retiredBuffer.myEpoch + 2) <= currentEpoch)
+			{
+				delete retiredBuffer.myBuffer;
+			}
+			else
+			{
+				myRetiredBuffers[keptCount++] = retiredBuffer;
+			}
+		}
+		myRetiredBuffers.resize(keptCount);
+	}
+}
+
+namespace CU = CommonUtility;
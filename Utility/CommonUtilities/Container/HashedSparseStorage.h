@@ -0,0 +1,314 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <assert.h>
+
+#include "SparseSet.h"
+
+/*
+	Sparse storage policy for SparseSet when elements come from a huge or hashed id space, e.g. 64-bit network ids
+	or CTTI::Cexpr_TypeID hashes, where a paged sparse side would allocate one page per element.
+
+		CU::SparseSet<unsigned long long, CU::SparseIdentity<unsigned long long>, CU::HashedSparseStorage<unsigned long long>> objects;
+
+	Open addressing table in the style of Swiss tables. Every slot has a control byte, either empty or the low 7 bits
+	of the key's hash. Slots are probed a group of 16 control bytes at a time, compared against the hash bits with SSE2
+	when available, so most lookups test one group and compare a single key.
+	Memory is bounded by the amount of elements: the table holds at most 7/8 used slots and removed elements are dropped
+	whenever it is rebuilt.
+
+	A slot holding failureIndex is a removed element. It keeps its key so probe chains stay intact, and the next insertion
+	passing by reuses it.
+*/
+
+namespace CommonUtility
+{
+	template<class T, class SparseIndexer = SparseIdentity<T>>
+	class HashedSparseStorage
+	{
+	public:
+		static constexpr T failureIndex = std::numeric_limits<T>::max();
+		static constexpr bool supportsPresenceBitmap = false;
+		static constexpr bool hasDirectLookup = false;
+
+		T* FindSlot(const T anElement);
+		const T* FindSlot(const T anElement) const;
+		T& AssureSlot(const T anElement);
+
+		void PrepareFor(const T* someElements, const size_t aCount);
+		void Reserve(const size_t aCount, const T aMaxElement);
+		void ShrinkToFit(const std::vector<T>& someLiveElements);
+		void Clear();
+		size_t GetAllocatedBytes() const;
+		void Prefetch(const T anElement) const;
+
+	private:
+		static constexpr size_t groupSize = 16;
+		static constexpr size_t notFound = std::numeric_limits<size_t>::max();
+		static constexpr unsigned char emptyControl = 0x80;//The only control value with the high bit set, so a group's empty slots are its sign bits.
+
+		static size_t Hash(const T aKey);
+		static unsigned char ToControl(const size_t aHash) { return static_cast<unsigned char>(aHash & 0x7F); }
+		static unsigned int MatchGroup(const unsigned char* aGroup, const unsigned char aControl);
+		static unsigned int MatchEmpty(const unsigned char* aGroup);
+		static unsigned int CountTrailingZeros(const unsigned int aMask);
+
+		size_t FindIndex(const T aKey, const size_t aHash) const;
+		size_t GetCapacity() const { return myControls.size(); }
+		size_t CountLive() const;
+		void Rehash(const size_t aMinimumCount);
+
+		std::vector<unsigned char> myControls;
+		std::vector<T> myKeys;
+		std::vector<T> myValues;
+		size_t myUsedCount = 0;//Slots with a key, including removed elements.
+	};
+
+	template<class T, class SparseIndexer>
+	inline T * HashedSparseStorage<T, SparseIndexer>::FindSlot(const T anElement)
+	{
+		return const_cast<T*>(static_cast<const HashedSparseStorage*>(this)->FindSlot(anElement));
+	}
+
+	template<class T, class SparseIndexer>
+	inline const T * HashedSparseStorage<T, SparseIndexer>::FindSlot(const T anElement) const
+	{
+		const T key = SparseIndexer::ToSparse(anElement);
+		const size_t index = FindIndex(key, Hash(key));
+		return (index == notFound) ? nullptr : &myValues[index];
+	}
+
+	template<class T, class SparseIndexer>
+	inline T & HashedSparseStorage<T, SparseIndexer>::AssureSlot(const T anElement)
+	{
+		const T key = SparseIndexer::ToSparse(anElement);
+		const size_t hash = Hash(key);
+		const size_t existingIndex = FindIndex(key, hash);
+		if (existingIndex != notFound)
+			return myValues[existingIndex];
+
+		if (((myUsedCount + 1) * 8) > (GetCapacity() * 7))
+		{
+			Rehash(CountLive() + 1);
+		}
+
+		//Takes the first removed or empty slot on the key's probe sequence, the key is known not to be further along it.
+		const size_t groupMask = (GetCapacity() / groupSize) - 1;
+		size_t groupIndex = (hash >> 7) & groupMask;
+		for (size_t probe = 1;; ++probe)
+		{
+			const unsigned char* group = myControls.data() + groupIndex * groupSize;
+			for (unsigned int slot = 0; slot < groupSize; ++slot)
+			{
+				const size_t index = groupIndex * groupSize + slot;
+				const bool isEmpty = (group[slot] == emptyControl);
+				if (isEmpty || (myValues[index] == failureIndex))
+				{
+					myUsedCount += isEmpty;
+					myControls[index] = ToControl(hash);
+					myKeys[index] = key;
+					myValues[index] = failureIndex;
+					return myValues[index];
+				}
+			}
+			groupIndex = (groupIndex + probe) & groupMask;
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline void HashedSparseStorage<T, SparseIndexer>::PrepareFor(const T * someElements, const size_t aCount)
+	{
+		someElements;
+		Reserve(CountLive() + aCount, 0);
+	}
+
+	template<class T, class SparseIndexer>
+	inline void HashedSparseStorage<T, SparseIndexer>::Reserve(const size_t aCount, const T aMaxElement)
+	{
+		aMaxElement;
+		if ((aCount * 8) > (GetCapacity() * 7))
+		{
+			Rehash(aCount);
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline void HashedSparseStorage<T, SparseIndexer>::ShrinkToFit(const std::vector<T>& someLiveElements)
+	{
+		if (someLiveElements.empty())
+		{
+			myControls = std::vector<unsigned char>();
+			myKeys = std::vector<T>();
+			myValues = std::vector<T>();
+			myUsedCount = 0;
+			return;
+		}
+
+		Rehash(someLiveElements.size());
+	}
+
+	template<class T, class SparseIndexer>
+	inline void HashedSparseStorage<T, SparseIndexer>::Clear()
+	{
+		std::fill(myControls.begin(), myControls.end(), emptyControl);
+		myUsedCount = 0;
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t HashedSparseStorage<T, SparseIndexer>::GetAllocatedBytes() const
+	{
+		return myControls.capacity() + ((myKeys.capacity() + myValues.capacity()) * sizeof(T));
+	}
+
+	template<class T, class SparseIndexer>
+	inline void HashedSparseStorage<T, SparseIndexer>::Prefetch(const T anElement) const
+	{
+		if (myControls.empty())
+			return;
+
+		const size_t hash = Hash(SparseIndexer::ToSparse(anElement));
+		const size_t groupIndex = (hash >> 7) & ((GetCapacity() / groupSize) - 1);
+		const unsigned char* group = myControls.data() + groupIndex * groupSize;
+#if defined(SPARSESET_AVX2) || defined(SPARSESET_SSE2)
+		_mm_prefetch(reinterpret_cast<const char*>(group), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(group);
+#endif
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t HashedSparseStorage<T, SparseIndexer>::Hash(const T aKey)
+	{
+		//64-bit finaliser of MurmurHash3, every input bit affects both the group index and the 7 control bits.
+		unsigned long long hash = static_cast<unsigned long long>(aKey);
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ull;
+		hash ^= hash >> 33;
+		return static_cast<size_t>(hash);
+	}
+
+	template<class T, class SparseIndexer>
+	inline unsigned int HashedSparseStorage<T, SparseIndexer>::MatchGroup(const unsigned char * aGroup, const unsigned char aControl)
+	{
+#if defined(SPARSESET_AVX2) || defined(SPARSESET_SSE2)
+		const __m128i controls = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aGroup));
+		return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8(static_cast<char>(aControl)))));
+#else
+		unsigned int mask = 0;
+		for (unsigned int slot = 0; slot < groupSize; ++slot)
+		{
+			mask |= static_cast<unsigned int>(aGroup[slot] == aControl) << slot;
+		}
+		return mask;
+#endif
+	}
+
+	template<class T, class SparseIndexer>
+	inline unsigned int HashedSparseStorage<T, SparseIndexer>::MatchEmpty(const unsigned char * aGroup)
+	{
+#if defined(SPARSESET_AVX2) || defined(SPARSESET_SSE2)
+		return static_cast<unsigned int>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(aGroup))));
+#else
+		return MatchGroup(aGroup, emptyControl);
+#endif
+	}
+
+	template<class T, class SparseIndexer>
+	inline unsigned int HashedSparseStorage<T, SparseIndexer>::CountTrailingZeros(const unsigned int aMask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, aMask);
+		return static_cast<unsigned int>(index);
+#else
+		return static_cast<unsigned int>(__builtin_ctz(aMask));
+#endif
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t HashedSparseStorage<T, SparseIndexer>::FindIndex(const T aKey, const size_t aHash) const
+	{
+		if (myControls.empty())
+			return notFound;
+
+		//Triangular steps over a power of two amount of groups visit every group once.
+		const size_t groupMask = (GetCapacity() / groupSize) - 1;
+		const unsigned char control = ToControl(aHash);
+		size_t groupIndex = (aHash >> 7) & groupMask;
+		for (size_t probe = 1; probe <= (groupMask + 1); ++probe)
+		{
+			const unsigned char* group = myControls.data() + groupIndex * groupSize;
+			for (unsigned int matches = MatchGroup(group, control); matches != 0; matches &= (matches - 1))
+			{
+				const size_t index = groupIndex * groupSize + CountTrailingZeros(matches);
+				if (myKeys[index] == aKey)
+					return index;
+			}
+
+			if (MatchEmpty(group) != 0)
+				return notFound;
+
+			groupIndex = (groupIndex + probe) & groupMask;
+		}
+
+		return notFound;
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t HashedSparseStorage<T, SparseIndexer>::CountLive() const
+	{
+		size_t liveCount = 0;
+		for (size_t index = 0; index < GetCapacity(); ++index)
+		{
+			liveCount += (myControls[index] != emptyControl) && (myValues[index] != failureIndex);
+		}
+		return liveCount;
+	}
+
+	template<class T, class SparseIndexer>
+	inline void HashedSparseStorage<T, SparseIndexer>::Rehash(const size_t aMinimumCount)
+	{
+		size_t capacity = groupSize;
+		while ((capacity * 7) < (aMinimumCount * 8))
+		{
+			capacity *= 2;
+		}
+
+		std::vector<unsigned char> oldControls(capacity, emptyControl);
+		std::vector<T> oldKeys(capacity);
+		std::vector<T> oldValues(capacity, failureIndex);
+		oldControls.swap(myControls);
+		oldKeys.swap(myKeys);
+		oldValues.swap(myValues);
+		myUsedCount = 0;
+
+		//Removed elements are not carried over, only slots holding a dense index.
+		const size_t groupMask = (capacity / groupSize) - 1;
+		for (size_t oldIndex = 0; oldIndex < oldControls.size(); ++oldIndex)
+		{
+			if ((oldControls[oldIndex] == emptyControl) || (oldValues[oldIndex] == failureIndex))
+				continue;
+
+			const size_t hash = Hash(oldKeys[oldIndex]);
+			size_t groupIndex = (hash >> 7) & groupMask;
+			for (size_t probe = 1;; ++probe)
+			{
+				const unsigned int empties = MatchEmpty(myControls.data() + groupIndex * groupSize);
+				if (empties != 0)
+				{
+					const size_t index = groupIndex * groupSize + CountTrailingZeros(empties);
+					myControls[index] = ToControl(hash);
+					myKeys[index] = oldKeys[oldIndex];
+					myValues[index] = oldValues[oldIndex];
+					++myUsedCount;
+					break;
+				}
+				groupIndex = (groupIndex + probe) & groupMask;
+			}
+		}
+	}
+}
+
+namespace CU = CommonUtility;
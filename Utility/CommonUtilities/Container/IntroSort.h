@@ -1,108 +1,116 @@
 #pragma once
 #include <vector>
 #include <functional>
+#include <cmath>
+#include <utility>
 
 namespace CommonUtility
 {
+	//Type erased comparator for callers that need to store one, every function below takes any callable and only pays for the indirection when handed this.
 	template<class T>
-	void InsertionSort(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const std::function<const bool(const T&, const T&)>& aCompFunc, const size_t aVecSize)
+	using SortPredicate = std::function<const bool(const T&, const T&)>;
+
+	constexpr size_t IntroSortInsertionThreshold = 16;//Ranges up to this many elements are insertion sorted.
+
+	template<class T, class Compare>
+	void InsertionSort(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const Compare& aCompFunc, const size_t aVecSize)
 	{
-		size_t i, j;
-		T tempStore;
-		for (i = aBegin + 1; i < anEnd; ++i)
+		aVecSize;
+		for (size_t i = aBegin + 1; i < anEnd; ++i)
 		{
-			tempStore = aVec[i];
-			j = i - 1;
-			while ((j < aVecSize) && (j >= aBegin) && aCompFunc(tempStore, aVec[j]))
+			T tempStore = std::move(aVec[i]);
+			size_t j = i;
+			for (; (aBegin < j) && aCompFunc(tempStore, aVec[j - 1]); --j)
 			{
-				aVec[j + 1] = aVec[j];
-				--j;
+				aVec[j] = std::move(aVec[j - 1]);
 			}
-			aVec[j + 1] = tempStore;
+			aVec[j] = std::move(tempStore);
 		}
 	}
 
-	template<class T>
-	const size_t MedianOfThree(const std::vector<T>& aVec, const size_t aFirst, const size_t aSecond, const size_t aLast)
+	template<class T, class Compare>
+	const size_t MedianOfThree(const std::vector<T>& aVec, const size_t aFirst, const size_t aSecond, const size_t aLast, const Compare& aCompFunc)
 	{
-		if (aVec[aFirst] < aVec[aSecond] && aVec[aSecond] < aVec[aLast])
-			return aSecond;
-
-		if (aVec[aFirst] < aVec[aLast] && aVec[aLast] <= aVec[aSecond])
-			return aLast;
-
-		if (aVec[aSecond] <= aVec[aFirst] && aVec[aFirst] < aVec[aLast])
-			return aFirst;
+		if (aCompFunc(aVec[aSecond], aVec[aFirst]))
+		{
+			if (aCompFunc(aVec[aLast], aVec[aSecond]))
+				return aSecond;
 
-		if (aVec[aSecond] < aVec[aLast] && aVec[aLast] <= aVec[aFirst])
-			return aLast;
+			return aCompFunc(aVec[aLast], aVec[aFirst]) ? aLast : aFirst;
+		}
 
-		if (aVec[aLast] <= aVec[aFirst] && aVec[aFirst] < aVec[aSecond])
+		if (aCompFunc(aVec[aLast], aVec[aFirst]))
 			return aFirst;
 
-		if (aVec[aLast] <= aVec[aSecond] && aVec[aSecond] <= aVec[aLast])
-			return aSecond;
-
-		return aFirst;
+		return aCompFunc(aVec[aLast], aVec[aSecond]) ? aLast : aSecond;
 	}
 
-	template<class T>
-	inline const size_t Partition2(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const std::function<const bool(const T&, const T&)>& aCompFunc)
+	//Lomuto partition of [aBegin, anEnd] around the pivot stored at anEnd.
+	template<class T, class Compare>
+	inline const size_t Partition2(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const Compare& aCompFunc)
 	{
-		const auto& pivot = aVec[anEnd];
-		size_t i = (aBegin - 1);
+		const T& pivot = aVec[anEnd];
+		size_t i = aBegin;
 
-		for (size_t j = aBegin; j <= anEnd - 1; j++)
+		for (size_t j = aBegin; j < anEnd; j++)
 		{
 			if (aCompFunc(aVec[j], pivot))
 			{
-				i++;
 				std::swap(aVec[i], aVec[j]);
+				i++;
 			}
 		}
-		std::swap(aVec[i + 1], aVec[anEnd]);
-		return (i + 1);
+		std::swap(aVec[i], aVec[anEnd]);
+		return i;
 	}
 
-	template<class T>
-	void BuildHeap(std::vector<T>& aVec, const size_t anEnd, const size_t aStart, const std::function<const bool(const T&, const T&)>& aCompFunc)
+	//Sifts aStart down the heap stored in [aBegin, anEnd), heap positions are relative to aBegin.
+	template<class T, class Compare>
+	void BuildHeap(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, size_t aStart, const Compare& aCompFunc)
 	{
-		size_t risingIndex = aStart;
-		size_t left = 2 * aStart + 1;
-		size_t right = 2 * aStart + 2;
-
-		if ((left < anEnd) && aCompFunc(aVec[risingIndex], aVec[left]))
+		const size_t heapSize = anEnd - aBegin;
+		for (;;)
 		{
-			risingIndex = left;
-		}
+			size_t risingIndex = aStart;
+			const size_t left = 2 * aStart + 1;
+			const size_t right = 2 * aStart + 2;
 
-		if ((right < anEnd) && aCompFunc(aVec[risingIndex], aVec[right]))
-		{
-			risingIndex = right;
-		}
+			if ((left < heapSize) && aCompFunc(aVec[aBegin + risingIndex], aVec[aBegin + left]))
+			{
+				risingIndex = left;
+			}
 
-		if (risingIndex != aStart)
-		{
-			std::swap(aVec[aStart], aVec[risingIndex]);
-			BuildHeap<T>(aVec, anEnd, risingIndex, aCompFunc);
+			if ((right < heapSize) && aCompFunc(aVec[aBegin + risingIndex], aVec[aBegin + right]))
+			{
+				risingIndex = right;
+			}
+
+			if (risingIndex == aStart)
+				return;
+
+			std::swap(aVec[aBegin + aStart], aVec[aBegin + risingIndex]);
+			aStart = risingIndex;
 		}
 	}
 
-	template<class T>
-	inline void HeapSort(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const std::function<const bool(const T&, const T&)>& aCompFunc, const size_t aVecSize)
+	template<class T, class Compare>
+	inline void HeapSort(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const Compare& aCompFunc, const size_t aVecSize)
 	{
+		aVecSize;
+		if (anEnd - aBegin < 2)
+			return;
+
 		// Build heap (rearrange array) 
-		for (size_t i = (anEnd / 2) - 1; (i >= aBegin) && (i < aVecSize); i--)
+		for (size_t i = (anEnd - aBegin) / 2; 0 < i;)
 		{
-			BuildHeap<T>(aVec, anEnd, i, aCompFunc);
+			BuildHeap(aVec, aBegin, anEnd, --i, aCompFunc);
 		}
 
 		// One by one extract an element from heap 
-		for (size_t i = anEnd - 1; (i >= aBegin) && (i < aVecSize); i--)
+		for (size_t i = anEnd - 1; aBegin < i; i--)
 		{
 			std::swap(aVec[aBegin], aVec[i]);
-
-			BuildHeap<T>(aVec, i, aBegin, aCompFunc);
+			BuildHeap(aVec, aBegin, i, 0, aCompFunc);
 		}
 	}
 
@@ -138,40 +146,46 @@ namespace CommonUtility
 		return i - 1;
 	}
 
-	template<class T>
-	inline void IntroSortImpl(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const std::function<const bool(const T&, const T&)>& aCompFunc, const int aDepthLim, const size_t aVecSize)
+	//Sorts the inclusive range [aBegin, anEnd].
+	template<class T, class Compare>
+	inline void IntroSortImpl(std::vector<T>& aVec, size_t aBegin, const size_t anEnd, const Compare& aCompFunc, int aDepthLim, const size_t aVecSize)
 	{
-		size_t size = anEnd - aBegin;
-		if (size > aVecSize)
+		while (IntroSortInsertionThreshold < (anEnd - aBegin + 1))
 		{
-			return;
-		}
-		if (size <= 2)//insertion sort threshold.
-		{
-			InsertionSort<T>(aVec, aBegin, anEnd, aCompFunc, aVecSize);
-			return;
-		}
+			if (aDepthLim <= 0)
+			{
+				HeapSort(aVec, aBegin, anEnd + 1, aCompFunc, aVecSize);
+				return;
+			}
+			--aDepthLim;
 
-		if (aDepthLim <= 0)
-		{
-			HeapSort<T>(aVec, aBegin, anEnd + 1, aCompFunc, aVecSize);
-			return;
-		}
+			const size_t size = anEnd - aBegin;
+			const size_t pivot = MedianOfThree(aVec, aBegin, aBegin + (size / 2), anEnd, aCompFunc);
+			std::swap(aVec[pivot], aVec[anEnd]);
 
-		const size_t pivot = MedianOfThree<T>(aVec, aBegin, aBegin + (size / 2), anEnd);
+			//Recurses into the lower part and loops on the upper one.
+			const size_t partitionPoint = Partition2(aVec, aBegin, anEnd, aCompFunc);
+			if (aBegin < partitionPoint)
+			{
+				IntroSortImpl(aVec, aBegin, partitionPoint - 1, aCompFunc, aDepthLim, aVecSize);
+			}
+			if (anEnd <= partitionPoint)
+				return;
 
-		std::swap(aVec[pivot], aVec[anEnd]);
+			aBegin = partitionPoint + 1;
+		}
 
-		const size_t partitionPoint = Partition2<T>(aVec, aBegin, anEnd, aCompFunc);
-		IntroSortImpl<T>(aVec, aBegin, partitionPoint - 1, aCompFunc, aDepthLim - 1, aVecSize);
-		IntroSortImpl<T>(aVec, partitionPoint + 1, anEnd, aCompFunc, aDepthLim - 1, aVecSize);
+		InsertionSort(aVec, aBegin, anEnd + 1, aCompFunc, aVecSize);
 	}
 
-	template<class T>
-	inline void IntroSort(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const std::function<const bool(const T&, const T&)>& aCompFunc)
+	template<class T, class Compare>
+	inline void IntroSort(std::vector<T>& aVec, const size_t aBegin, const size_t anEnd, const Compare& aCompFunc)
 	{
-		int depthLimit = static_cast<int>(1.5 * std::log(anEnd - aBegin));
-		IntroSortImpl<T>(aVec, aBegin, anEnd - 1, aCompFunc, depthLimit, aVec.size());
+		if (anEnd - aBegin < 2)
+			return;
+
+		int depthLimit = static_cast<int>(2 * std::log2(anEnd - aBegin));
+		IntroSortImpl(aVec, aBegin, anEnd - 1, aCompFunc, depthLimit, aVec.size());
 	}
 
 	template<class T>
@@ -2,36 +2,108 @@
 #include <tuple>
 #include <vector>
 #include <functional>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <assert.h>
+#include "SoACStorage.h"
+#include "ColumnKernels.h"
 
 using HashType = unsigned int;
 using TypeIndexType = unsigned int;
 
 namespace CommonUtility
 {
-	template<TypeIndexType PredicateIndex, class PredSigType, class ... TypeList>
-	struct ISortLite;
-
-	template<class ... TypeList>
-	class SoAC
+	/*
+		Structure of arrays container, element anIndex is the row of every column's anIndex'th value.
+		ColumnStorage decides how the columns are held, see SoACStorage.h. SoAC keeps all columns in one allocation,
+		AlignedSoAC additionally aligns every column to 64 bytes with SIMD padded tails.
+	*/
+	template<class ColumnStorage, class ... TypeList>
+	class BasicSoAC
 	{
 	public:
-		SoAC() {}
-		~SoAC() {}
+		/*
+			Random access iterator walking all columns in lockstep. It keeps one pointer per column and an index,
+			dereferencing yields a std::tuple of references straight from those pointers(structured bindings work on it).
+			The reference is a proxy, so it suits non-mutating and element-wise algorithms(for_each, transform, count_if, ...),
+			but not std::sort or other algorithms that swap through the iterator.
+		*/
+		template<bool IsConst>
+		class BasicIterator
+		{
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = std::tuple<TypeList...>;
+			using difference_type = std::ptrdiff_t;
+			using reference = std::conditional_t<IsConst, std::tuple<const TypeList&...>, std::tuple<TypeList&...>>;
+			using pointer = void;
+			using ColumnPointers = std::conditional_t<IsConst, std::tuple<const TypeList*...>, std::tuple<TypeList*...>>;
+
+			BasicIterator() {}
+			BasicIterator(const ColumnPointers& someColumns, const difference_type anIndex) : myColumns(someColumns), myIndex(anIndex) {}
+
+			inline reference operator*() const { return Dereference(myIndex, std::make_index_sequence<sizeof...(TypeList)>{}); }
+			inline reference operator[](const difference_type anOffset) const { return Dereference(myIndex + anOffset, std::make_index_sequence<sizeof...(TypeList)>{}); }
+
+			template<TypeIndexType TypeIndex>
+			inline auto& Get() const { return std::get<TypeIndex>(myColumns)[myIndex]; }//Single column access without forming the tuple.
+
+			inline BasicIterator& operator++() { ++myIndex; return *this; }
+			inline BasicIterator operator++(int) { BasicIterator previous = *this; ++myIndex; return previous; }
+			inline BasicIterator& operator--() { --myIndex; return *this; }
+			inline BasicIterator operator--(int) { BasicIterator previous = *this; --myIndex; return previous; }
+			inline BasicIterator& operator+=(const difference_type anOffset) { myIndex += anOffset; return *this; }
+			inline BasicIterator& operator-=(const difference_type anOffset) { myIndex -= anOffset; return *this; }
+			inline BasicIterator operator+(const difference_type anOffset) const { return BasicIterator(myColumns, myIndex + anOffset); }
+			inline BasicIterator operator-(const difference_type anOffset) const { return BasicIterator(myColumns, myIndex - anOffset); }
+			inline friend BasicIterator operator+(const difference_type anOffset, const BasicIterator& anIterator) { return anIterator + anOffset; }
+			inline difference_type operator-(const BasicIterator& anOther) const { return myIndex - anOther.myIndex; }
+
+			inline bool operator==(const BasicIterator& anOther) const { return myIndex == anOther.myIndex; }
+			inline bool operator!=(const BasicIterator& anOther) const { return myIndex != anOther.myIndex; }
+			inline bool operator<(const BasicIterator& anOther) const { return myIndex < anOther.myIndex; }
+			inline bool operator>(const BasicIterator& anOther) const { return myIndex > anOther.myIndex; }
+			inline bool operator<=(const BasicIterator& anOther) const { return myIndex <= anOther.myIndex; }
+			inline bool operator>=(const BasicIterator& anOther) const { return myIndex >= anOther.myIndex; }
+
+		private:
+			template<size_t ... IndexSequence>
+			inline reference Dereference(const difference_type anIndex, const std::index_sequence<IndexSequence...>&) const
+			{
+				return reference(std::get<IndexSequence>(myColumns)[anIndex]...);
+			}
+
+			ColumnPointers myColumns;
+			difference_type myIndex = 0;
+		};
+
+		using Iterator = BasicIterator<false>;
+		using ConstIterator = BasicIterator<true>;
+
+		BasicSoAC() {}
+		BasicSoAC(const BasicSoAC& anOther) = default;
+		BasicSoAC(BasicSoAC&& anOther) = default;
+		~BasicSoAC() {}
+
+		BasicSoAC& operator=(const BasicSoAC& anOther) = default;
+		BasicSoAC& operator=(BasicSoAC&& anOther) = default;
 
 		template<class...ArgTypes>
 		inline void Add(ArgTypes&& ... someArgs)
 		{
-			Add<0, ArgTypes...>(std::forward<ArgTypes>(someArgs)...);
+			myColumns.EmplaceBack(std::forward<ArgTypes>(someArgs)...);
 		}
 
 		inline void Resize(const size_t aVectorSize)
 		{
-			Resize<0>(aVectorSize);
+			myColumns.Resize(aVectorSize);
 		}
 
+		//Allocates room for aVectorSize elements without constructing any.
 		inline void Reserve(const size_t aVectorSize)
 		{
-			Reserve<0>(aVectorSize);
+			myColumns.Reserve(aVectorSize);
 		}
 
 		inline void Swap(const size_t aFirstIndex, const size_t aSecondIndex)
@@ -42,13 +114,13 @@ namespace CommonUtility
 		template<TypeIndexType TypeIndex>
 		inline auto& Get(const size_t anElementIndex)
 		{
-			return GetTypeArray<TypeIndex>()[anElementIndex];
+			return Data<TypeIndex>()[anElementIndex];
 		}
 
 		template<TypeIndexType TypeIndex>
 		inline const auto& Get(const size_t anElementIndex) const
 		{
-			return GetTypeArray<TypeIndex>()[anElementIndex];
+			return Data<TypeIndex>()[anElementIndex];
 		}
 
 		inline std::tuple<TypeList& ...> operator[](const size_t anIndex)
@@ -61,53 +133,248 @@ namespace CommonUtility
 			return GetTuple(anIndex, std::make_index_sequence<sizeof...(TypeList)>{});
 		}
 
-		inline constexpr TypeIndexType GetTypeAmount() const
+		inline Iterator begin() { return Iterator(GetColumnPointers(std::make_index_sequence<sizeof...(TypeList)>{}), 0); }
+		inline Iterator end() { return begin() + static_cast<std::ptrdiff_t>(Size()); }
+		inline ConstIterator begin() const { return ConstIterator(GetColumnPointers(std::make_index_sequence<sizeof...(TypeList)>{}), 0); }
+		inline ConstIterator end() const { return begin() + static_cast<std::ptrdiff_t>(Size()); }
+
+		//Contiguous storage of a single column, valid until the container grows.
+		template<TypeIndexType TypeIndex>
+		inline auto* Data()
 		{
-			return sizeof...(TypeList);
+			return myColumns.template Data<TypeIndex>();
 		}
 
-		inline size_t Size()
+		template<TypeIndexType TypeIndex>
+		inline const auto* Data() const
 		{
-			return GetTypeArray<0>().size();
+			return myColumns.template Data<TypeIndex>();
 		}
 
-		inline size_t Size() const
+		//Size() rounded up to the SIMD padding of the column, elements in [Size(), GetPaddedSize()) are scratch. Equals Size() unless the storage pads.
+		template<TypeIndexType TypeIndex>
+		inline size_t GetPaddedSize() const
 		{
-			return GetTypeArray<0>().size();
+			return myColumns.template GetPaddedSize<TypeIndex>();
 		}
 
-	private:
-		template<TypeIndexType PredicateIndex, class PredSigType, class ... TypeList>
-		friend struct ISortLite;
+		inline size_t Capacity() const
+		{
+			return myColumns.Capacity();
+		}
 
-		template<TypeIndexType TypeIndex, class HeadType, class...TrailTypes>
-		inline void Add(HeadType&& anArg, TrailTypes&& ... someArgs)
+		/*
+			Runs aFunction over columns TypeIndices... with the column pointers fetched once.
+			A callable taking ColumnSpan<T>... gets every column as one span, otherwise it is called per row with T&...
+				particles.Transform<0, 1>([aDeltaTime](CU::ColumnSpan<float> aPositions, CU::ColumnSpan<const float> aVelocities) { CU::ColumnKernels::Axpy(aDeltaTime, aVelocities, aPositions); });
+				particles.Transform<2>([](float& aLifeTime) { aLifeTime -= 1.f; });
+		*/
+		template<TypeIndexType ... TypeIndices, class Function>
+		inline void Transform(const Function& aFunction)
 		{
-			GetTypeArray<TypeIndex>().emplace_back(std::forward<HeadType>(anArg));
-			if constexpr (sizeof...(TrailTypes) > 0)
-				Add<TypeIndex + 1, TrailTypes...>(std::forward<TrailTypes>(someArgs)...);
+			if constexpr (std::is_invocable<const Function&, ColumnSpan<std::remove_pointer_t<decltype(Data<TypeIndices>())>>...>::value)
+			{
+				aFunction(ColumnSpan<std::remove_pointer_t<decltype(Data<TypeIndices>())>>(Data<TypeIndices>(), Size())...);
+			}
+			else
+			{
+				const auto columns = std::make_tuple(Data<TypeIndices>()...);
+				const size_t size = Size();
+				for (size_t index = 0; index < size; ++index)
+				{
+					std::apply([&aFunction, index](auto* ... someColumns) { aFunction(someColumns[index]...); }, columns);
+				}
+			}
 		}
 
-		template<TypeIndexType TypeIndex>
-		inline void Resize(const size_t aVectorSize)
+		//Folds column TypeIndex into anInitial with anOperation(accumulated, const T&).
+		template<TypeIndexType TypeIndex, class Value, class Operation>
+		inline Value Reduce(Value anInitial, const Operation& anOperation) const
 		{
-			GetTypeArray<TypeIndex>().resize(aVectorSize);
-			if constexpr ((TypeIndex + 1) < sizeof...(TypeList))
-				Resize<TypeIndex + 1>(aVectorSize);
+			const auto* column = Data<TypeIndex>();
+			const size_t size = Size();
+			for (size_t index = 0; index < size; ++index)
+			{
+				anInitial = anOperation(std::move(anInitial), column[index]);
+			}
+			return anInitial;
 		}
 
-		template<TypeIndexType TypeIndex>
-		inline void Reserve(const size_t aVectorSize)
+		//Appends, in order, the index of every row whose column TypeIndex satisfies aPredicate(const T&).
+		template<TypeIndexType TypeIndex, class Predicate>
+		inline void Filter(const Predicate& aPredicate, std::vector<size_t>& someIndicesOut) const
+		{
+			//Indices are gathered a block at a time without branching on the predicate, four rows a step, then appended in one insert.
+			constexpr size_t blockSize = 256;
+			size_t block[blockSize];
+			const auto* column = Data<TypeIndex>();
+			const size_t size = Size();
+			for (size_t first = 0; first < size; first += blockSize)
+			{
+				const size_t end = (std::min)(first + blockSize, size);
+				size_t count = 0;
+				size_t index = first;
+				for (; index + 4 <= end; index += 4)
+				{
+					block[count] = index;
+					count += static_cast<bool>(aPredicate(column[index]));
+					block[count] = index + 1;
+					count += static_cast<bool>(aPredicate(column[index + 1]));
+					block[count] = index + 2;
+					count += static_cast<bool>(aPredicate(column[index + 2]));
+					block[count] = index + 3;
+					count += static_cast<bool>(aPredicate(column[index + 3]));
+				}
+				for (; index < end; ++index)
+				{
+					block[count] = index;
+					count += static_cast<bool>(aPredicate(column[index]));
+				}
+				someIndicesOut.insert(someIndicesOut.end(), block, block + count);
+			}
+		}
+
+		//Keeps the rows whose column TypeIndex satisfies aPredicate(const T&), in order. Returns the new size.
+		template<TypeIndexType TypeIndex, class Predicate>
+		inline size_t Compact(const Predicate& aPredicate)
+		{
+			RemoveRows<TypeIndex>(aPredicate, false);
+			return Size();
+		}
+
+		/*
+			Removes the rows whose column TypeIndex satisfies aPredicate(const T&), the rest keep their order. Returns the amount removed.
+			The predicate runs once per row into a keep mask, then each column is compacted in one pass over it,
+			4 and 8-byte trivially copyable columns with AVX2 left-pack(see ColumnKernels::CompactByMask).
+				particles.EraseIf<3>([](const float aLifeTime) { return aLifeTime <= 0.f; });
+		*/
+		template<TypeIndexType TypeIndex, class Predicate>
+		inline size_t EraseIf(const Predicate& aPredicate)
 		{
-			GetTypeArray<TypeIndex>().resize(aVectorSize);
-			if constexpr ((TypeIndex + 1) < sizeof...(TypeList))
-				Reserve<TypeIndex + 1>(aVectorSize);
+			const size_t size = Size();
+			RemoveRows<TypeIndex>(aPredicate, true);
+			return size - Size();
 		}
 
+		/*
+			Removes the rows at someIndices by moving the last rows into their place. Work follows the amount removed instead of
+			the size, but the order is not kept. Duplicate indices are removed once, ascending indices(as from Filter) are not copied.
+			Keep the index buffer around so Filter doesn't grow it from scratch every frame:
+				myDeadRows.clear();
+				particles.Filter<3>([](const float aLifeTime) { return aLifeTime <= 0.f; }, myDeadRows);
+				particles.SwapRemove(myDeadRows);
+		*/
+		inline void SwapRemove(const std::vector<size_t>& someIndices)
+		{
+			//One pass checks the order and counts the distinct indices, the count is only used when they are sorted.
+			size_t removedCount = someIndices.empty() ? 0 : 1;
+			bool isSorted = true;
+			for (size_t position = 1; position < someIndices.size(); ++position)
+			{
+				isSorted = isSorted && (someIndices[position - 1] <= someIndices[position]);
+				removedCount += (someIndices[position - 1] != someIndices[position]);
+			}
+
+			if (isSorted)
+			{
+				SwapRemoveSorted(someIndices, removedCount, std::make_index_sequence<sizeof...(TypeList)>{});
+				return;
+			}
+
+			std::vector<size_t> indices(someIndices);
+			std::sort(indices.begin(), indices.end());
+			indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+			SwapRemoveSorted(indices, indices.size(), std::make_index_sequence<sizeof...(TypeList)>{});
+		}
+
+		inline constexpr TypeIndexType GetTypeAmount() const
+		{
+			return sizeof...(TypeList);
+		}
+
+		inline size_t Size() const
+		{
+			return myColumns.Size();
+		}
+
+	private:
 		template<size_t ... IndexSequence>
 		inline void Swap(const size_t aFirstIndex, const size_t aSecondIndex, const std::index_sequence<IndexSequence...>&)
 		{
-			(std::swap(GetTypeArray<IndexSequence>()[aFirstIndex], GetTypeArray<IndexSequence>()[aSecondIndex]), ...);
+			(std::swap(Get<IndexSequence>(aFirstIndex), Get<IndexSequence>(aSecondIndex)), ...);
+		}
+
+		template<TypeIndexType TypeIndex, class Predicate>
+		inline void RemoveRows(const Predicate& aPredicate, const bool anEraseMatches)
+		{
+			const auto* column = Data<TypeIndex>();
+			const size_t size = Size();
+			std::vector<unsigned char> keepMask((size + 7) / 8, 0);
+			size_t keptCount = 0;
+			for (size_t index = 0; index < size; ++index)
+			{
+				const bool keep = (static_cast<bool>(aPredicate(column[index])) != anEraseMatches);
+				keepMask[index / 8] |= static_cast<unsigned char>(keep << (index % 8));
+				keptCount += keep;
+			}
+
+			if (keptCount != size)
+			{
+				CompactColumns(keepMask.data(), std::make_index_sequence<sizeof...(TypeList)>{});
+				Resize(keptCount);
+			}
+		}
+
+		template<size_t ... IndexSequence>
+		inline void CompactColumns(const unsigned char* aKeepMask, const std::index_sequence<IndexSequence...>&)
+		{
+			(ColumnKernels::CompactByMask(Data<IndexSequence>(), aKeepMask, Size()), ...);
+		}
+
+		//Only holes below the new size are filled, in ascending order with the surviving rows above it, so every row moves at
+		//most once and the holes and index list are walked once for all columns. The moves wait on cache misses at the holes,
+		//so the rows of the hole prefetchDistance ahead are prefetched.
+		template<size_t ... IndexSequence>
+		inline void SwapRemoveSorted(const std::vector<size_t>& someAscendingIndices, const size_t aRemovedCount, const std::index_sequence<IndexSequence...>&)
+		{
+			assert((someAscendingIndices.empty() || someAscendingIndices.back() < Size()) && "SoAC::SwapRemove index out of range.");
+			constexpr size_t prefetchDistance = 16;
+			const size_t newSize = Size() - aRemovedCount;
+			const size_t holeCount = std::lower_bound(someAscendingIndices.begin(), someAscendingIndices.end(), newSize) - someAscendingIndices.begin();
+			size_t upper = holeCount;
+			size_t source = newSize;
+			for (size_t position = 0; position < holeCount; ++position)
+			{
+				const size_t hole = someAscendingIndices[position];
+				if ((position > 0) && (someAscendingIndices[position - 1] == hole))
+					continue;
+
+				if ((position + prefetchDistance) < holeCount)
+				{
+					const size_t nextHole = someAscendingIndices[position + prefetchDistance];
+					(Prefetch(Data<IndexSequence>() + nextHole), ...);
+				}
+
+				//Next row from newSize up that isn't removed itself.
+				while ((upper < someAscendingIndices.size()) && (someAscendingIndices[upper] <= source))
+				{
+					source += (someAscendingIndices[upper] == source);
+					++upper;
+				}
+				(std::swap(Data<IndexSequence>()[hole], Data<IndexSequence>()[source]), ...);
+				++source;
+			}
+			Resize(newSize);
+		}
+
+		template<class T>
+		inline static void Prefetch(const T* anAddress)
+		{
+#if defined(COLUMNKERNELS_X64)
+			_mm_prefetch(reinterpret_cast<const char*>(anAddress), _MM_HINT_T0);
+#elif defined(__GNUC__)
+			__builtin_prefetch(anAddress);
+#endif
 		}
 
 		template<size_t ... IndexSequence>
@@ -122,20 +389,26 @@ namespace CommonUtility
 			return std::tuple<const TypeList& ...>(Get<IndexSequence>(anIndex)...);
 		}
 
-		template<TypeIndexType TypeIndex>
-		inline auto& GetTypeArray()
+		template<size_t ... IndexSequence>
+		inline typename Iterator::ColumnPointers GetColumnPointers(const std::index_sequence<IndexSequence...>&)
 		{
-			return std::get<TypeIndex>(myTypes);
+			return typename Iterator::ColumnPointers(Data<IndexSequence>()...);
 		}
 
-		template<TypeIndexType TypeIndex>
-		inline const auto& GetTypeArray() const
+		template<size_t ... IndexSequence>
+		inline typename ConstIterator::ColumnPointers GetColumnPointers(const std::index_sequence<IndexSequence...>&) const
 		{
-			return std::get<TypeIndex>(myTypes);
+			return typename ConstIterator::ColumnPointers(Data<IndexSequence>()...);
 		}
 
-		std::tuple<std::vector<TypeList>...> myTypes;
+		typename ColumnStorage::template Columns<TypeList...> myColumns;
 	};
+
+	template<class ... TypeList>
+	using SoAC = BasicSoAC<BlockColumnStorage<>, TypeList...>;
+
+	template<class ... TypeList>
+	using AlignedSoAC = BasicSoAC<AlignedColumnStorage<64>, TypeList...>;
 }
 
 namespace CU = CommonUtility;
\ No newline at end of file
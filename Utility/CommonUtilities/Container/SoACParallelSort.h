@@ -0,0 +1,388 @@
+#pragma once
+#include <vector>
+#include <tuple>
+#include <random>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+#include <assert.h>
+
+#include "SoAC.h"
+#include "IntroSort.h"
+#include "TemplateUtility/ChooseType.h"
+#include "Threading/ThreadPool.h"
+
+/*
+	Multi-threaded sorts of a SoAC(any column storage) on one key column. Both sort (key, position) entries built from the key column alone,
+	then gather every column into the sorted order, split in chunks over the thread pool.
+	- ParallelSort takes any predicate over the key type. Sample sort: splitters taken from a sorted sample spread the entries
+	  over buckets in parallel, then the buckets are intro sorted in parallel. Not stable.
+	- RadixSort sorts integral or floating point keys ascending. Stable LSD radix sort on 8-bit digits, each pass counts
+	  and scatters in parallel chunks, passes where every key has the same digit are skipped.
+	  Floats are ordered by their bits with negative values flipped: -0.0 sorts before 0.0 and NaNs sort past the infinity of their sign.
+	Ranges below parallelSortMinCount stay on the calling thread. Without a pool the default pool is used, it is only started by larger ranges.
+	Columns must be default constructible, as for SoAC::Resize.
+
+		CU::RadixSort<0>(drawQueue, 0, drawQueue.Size());
+		CU::ParallelSort<1>(drawQueue, 0, drawQueue.Size(), [](const float aLHS, const float aRHS) { return aLHS > aRHS; });
+*/
+
+namespace CommonUtility
+{
+	constexpr size_t parallelSortMinCount = 1 << 15;
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	struct ParallelSoACSort
+	{
+	public:
+		using KeyType = typename TemplateUtility::ChooseType<KeyIndex, TypeList...>;
+
+		template<class ColumnStorage, class Predicate>
+		static void Sort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, const size_t aFirst, const size_t aLast, const Predicate& aPredicate, ThreadPool* aThreadPool);
+		template<class ColumnStorage>
+		static void RadixSort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, const size_t aFirst, const size_t aLast, ThreadPool* aThreadPool);
+
+	private:
+		static constexpr size_t bucketsPerChunk = 4;
+		static constexpr size_t samplesPerBucket = 32;
+		static constexpr size_t radixDigitValues = 256;
+
+		using KeyBits = std::conditional_t<sizeof(KeyType) == 1, std::uint8_t,
+			std::conditional_t<sizeof(KeyType) == 2, std::uint16_t,
+			std::conditional_t<sizeof(KeyType) == 4, std::uint32_t, std::uint64_t>>>;
+
+		struct KeyEntry
+		{
+			KeyType myKey;
+			unsigned int myIndex;//Position relative to aFirst before sorting.
+		};
+
+		struct RadixEntry
+		{
+			KeyBits myBits;
+			unsigned int myIndex;
+		};
+
+		static KeyBits ToRadixBits(const KeyType aKey);
+		static KeyType FromRadixBits(const KeyBits someBits);
+		static const KeyType& GetSortedKey(const KeyEntry& anEntry) { return anEntry.myKey; }
+		static KeyType GetSortedKey(const RadixEntry& anEntry) { return FromRadixBits(anEntry.myBits); }
+		static size_t GetChunkCount(const size_t aCount, ThreadPool* aThreadPool);
+		static size_t GetChunkBegin(const size_t aChunk, const size_t aChunkCount, const size_t aCount) { return (aChunk * aCount) / aChunkCount; }
+
+		template<class Function>
+		static void RunChunks(const size_t aChunkCount, ThreadPool* aThreadPool, const Function& aFunction);
+
+		template<class Container, class Entry>
+		static void ApplyOrder(Container& aContainerToSort, const size_t aFirst, const std::vector<Entry>& someSortedEntries, ThreadPool* aThreadPool);
+
+		template<class Container, class Entry, size_t ... IndexSequence>
+		static void GatherColumns(Container& aContainerToSort, const size_t aFirst, const std::vector<Entry>& someSortedEntries, std::tuple<std::vector<TypeList>...>& someSortedColumns,
+			const size_t aBegin, const size_t anEnd, const std::index_sequence<IndexSequence...>&);
+
+		template<class Container, size_t ... IndexSequence>
+		static void MoveColumnsBack(Container& aContainerToSort, const size_t aFirst, std::tuple<std::vector<TypeList>...>& someSortedColumns,
+			const size_t aBegin, const size_t anEnd, const std::index_sequence<IndexSequence...>&);
+	};
+
+	//Sorts [aFirst, aLast) of aContainerToSort on column KeyIndex by aPredicate(const KeyType&, const KeyType&).
+	template<TypeIndexType KeyIndex, class Predicate, class ColumnStorage, class ... TypeList>
+	inline void ParallelSort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, const size_t aFirst, const size_t aLast, const Predicate& aPredicate, ThreadPool* aThreadPool = nullptr)
+	{
+		ParallelSoACSort<KeyIndex, TypeList...>::Sort(aContainerToSort, aFirst, aLast, aPredicate, aThreadPool);
+	}
+
+	//Sorts [aFirst, aLast) of aContainerToSort ascending on the integral or floating point column KeyIndex.
+	template<TypeIndexType KeyIndex, class ColumnStorage, class ... TypeList>
+	inline void RadixSort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, const size_t aFirst, const size_t aLast, ThreadPool* aThreadPool = nullptr)
+	{
+		ParallelSoACSort<KeyIndex, TypeList...>::RadixSort(aContainerToSort, aFirst, aLast, aThreadPool);
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	template<class ColumnStorage, class Predicate>
+	inline void ParallelSoACSort<KeyIndex, TypeList...>::Sort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, const size_t aFirst, const size_t aLast, const Predicate& aPredicate, ThreadPool* aThreadPool)
+	{
+		const size_t count = aLast - aFirst;
+		assert(aFirst <= aLast && aLast <= aContainerToSort.Size() && "ParallelSort range outside of the container.");
+		assert(count <= std::numeric_limits<unsigned int>::max() && "ParallelSort range too large for 32-bit entry indices.");
+		if (count < 2)
+			return;
+
+		const KeyType* keys = aContainerToSort.template Data<KeyIndex>() + aFirst;
+		const auto compareEntries = [&aPredicate](const KeyEntry& aLHS, const KeyEntry& aRHS) { return aPredicate(aLHS.myKey, aRHS.myKey); };
+		const size_t chunkCount = GetChunkCount(count, aThreadPool);
+
+		std::vector<KeyEntry> entries(count);
+		RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+		{
+			for (size_t index = GetChunkBegin(aChunk, chunkCount, count); index < GetChunkBegin(aChunk + 1, chunkCount, count); ++index)
+			{
+				entries[index] = KeyEntry{ keys[index], static_cast<unsigned int>(index) };
+			}
+		});
+
+		if (chunkCount == 1)
+		{
+			IntroSort(entries, 0, count, compareEntries);
+			ApplyOrder(aContainerToSort, aFirst, entries, aThreadPool);
+			return;
+		}
+
+		//Splitters are every samplesPerBucket'th key of a sorted sample, drawn at a random position inside each stratum so periodic input can not fool it.
+		const size_t bucketCount = chunkCount * bucketsPerChunk;
+		const size_t sampleCount = bucketCount * samplesPerBucket;
+		std::vector<KeyEntry> samples;
+		samples.reserve(sampleCount);
+		std::minstd_rand generator(static_cast<unsigned int>(count));
+		for (size_t sample = 0; sample < sampleCount; ++sample)
+		{
+			const size_t stratumBegin = GetChunkBegin(sample, sampleCount, count);
+			const size_t stratumSize = (std::max)(GetChunkBegin(sample + 1, sampleCount, count) - stratumBegin, size_t(1));
+			samples.push_back(entries[stratumBegin + (generator() % stratumSize)]);
+		}
+		IntroSort(samples, 0, samples.size(), compareEntries);
+
+		std::vector<KeyType> splitters;
+		for (size_t bucket = 1; bucket < bucketCount; ++bucket)
+		{
+			splitters.push_back(samples[bucket * samplesPerBucket].myKey);
+		}
+
+		//Per chunk bucket counts, then each chunk scatters into its own slice of every bucket.
+		std::vector<unsigned int> bucketOfEntry(count);
+		std::vector<size_t> chunkBucketOffsets(chunkCount * bucketCount, 0);
+		RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+		{
+			size_t* bucketCounts = chunkBucketOffsets.data() + aChunk * bucketCount;
+			for (size_t index = GetChunkBegin(aChunk, chunkCount, count); index < GetChunkBegin(aChunk + 1, chunkCount, count); ++index)
+			{
+				const size_t bucket = std::upper_bound(splitters.begin(), splitters.end(), entries[index].myKey, aPredicate) - splitters.begin();
+				bucketOfEntry[index] = static_cast<unsigned int>(bucket);
+				++bucketCounts[bucket];
+			}
+		});
+
+		std::vector<size_t> bucketBegins(bucketCount + 1);
+		size_t runningOffset = 0;
+		for (size_t bucket = 0; bucket < bucketCount; ++bucket)
+		{
+			bucketBegins[bucket] = runningOffset;
+			for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				const size_t bucketCountInChunk = chunkBucketOffsets[chunk * bucketCount + bucket];
+				chunkBucketOffsets[chunk * bucketCount + bucket] = runningOffset;
+				runningOffset += bucketCountInChunk;
+			}
+		}
+		bucketBegins[bucketCount] = count;
+
+		std::vector<KeyEntry> bucketedEntries(count);
+		RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+		{
+			size_t* bucketOffsets = chunkBucketOffsets.data() + aChunk * bucketCount;
+			for (size_t index = GetChunkBegin(aChunk, chunkCount, count); index < GetChunkBegin(aChunk + 1, chunkCount, count); ++index)
+			{
+				bucketedEntries[bucketOffsets[bucketOfEntry[index]]++] = std::move(entries[index]);
+			}
+		});
+
+		ThreadPool::GetOrDefault(aThreadPool).ParallelFor(bucketCount, [&](const size_t aBucket)
+		{
+			IntroSort(bucketedEntries, bucketBegins[aBucket], bucketBegins[aBucket + 1], compareEntries);
+		});
+
+		ApplyOrder(aContainerToSort, aFirst, bucketedEntries, aThreadPool);
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	template<class ColumnStorage>
+	inline void ParallelSoACSort<KeyIndex, TypeList...>::RadixSort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, const size_t aFirst, const size_t aLast, ThreadPool* aThreadPool)
+	{
+		static_assert(std::is_integral<KeyType>::value || std::is_floating_point<KeyType>::value, "RadixSort needs an integral or floating point key column.");
+		static_assert(sizeof(KeyType) == sizeof(KeyBits), "RadixSort key type has no unsigned integer of the same size.");
+
+		const size_t count = aLast - aFirst;
+		assert(aFirst <= aLast && aLast <= aContainerToSort.Size() && "RadixSort range outside of the container.");
+		assert(count <= std::numeric_limits<unsigned int>::max() && "RadixSort range too large for 32-bit entry indices.");
+		if (count < 2)
+			return;
+
+		const KeyType* keys = aContainerToSort.template Data<KeyIndex>() + aFirst;
+		const size_t chunkCount = GetChunkCount(count, aThreadPool);
+
+		std::vector<RadixEntry> entries(count);
+		std::vector<RadixEntry> scatteredEntries(count);
+		RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+		{
+			for (size_t index = GetChunkBegin(aChunk, chunkCount, count); index < GetChunkBegin(aChunk + 1, chunkCount, count); ++index)
+			{
+				entries[index] = RadixEntry{ ToRadixBits(keys[index]), static_cast<unsigned int>(index) };
+			}
+		});
+
+		//Chunk-major counts of every digit value, turned into each chunk's scatter offsets in place.
+		std::vector<size_t> chunkDigitOffsets(chunkCount * radixDigitValues);
+		for (size_t digit = 0; digit < sizeof(KeyBits); ++digit)
+		{
+			const unsigned int shift = static_cast<unsigned int>(digit * 8);
+			std::fill(chunkDigitOffsets.begin(), chunkDigitOffsets.end(), 0);
+			RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+			{
+				size_t* digitCounts = chunkDigitOffsets.data() + aChunk * radixDigitValues;
+				for (size_t index = GetChunkBegin(aChunk, chunkCount, count); index < GetChunkBegin(aChunk + 1, chunkCount, count); ++index)
+				{
+					++digitCounts[(entries[index].myBits >> shift) & (radixDigitValues - 1)];
+				}
+			});
+
+			bool isDigitShared = false;
+			size_t runningOffset = 0;
+			for (size_t digitValue = 0; digitValue < radixDigitValues; ++digitValue)
+			{
+				const size_t digitBegin = runningOffset;
+				for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+				{
+					const size_t digitCountInChunk = chunkDigitOffsets[chunk * radixDigitValues + digitValue];
+					chunkDigitOffsets[chunk * radixDigitValues + digitValue] = runningOffset;
+					runningOffset += digitCountInChunk;
+				}
+				isDigitShared |= ((runningOffset - digitBegin) == count);
+			}
+			if (isDigitShared)
+				continue;
+
+			RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+			{
+				size_t* digitOffsets = chunkDigitOffsets.data() + aChunk * radixDigitValues;
+				for (size_t index = GetChunkBegin(aChunk, chunkCount, count); index < GetChunkBegin(aChunk + 1, chunkCount, count); ++index)
+				{
+					scatteredEntries[digitOffsets[(entries[index].myBits >> shift) & (radixDigitValues - 1)]++] = entries[index];
+				}
+			});
+			entries.swap(scatteredEntries);
+		}
+
+		ApplyOrder(aContainerToSort, aFirst, entries, aThreadPool);
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	inline typename ParallelSoACSort<KeyIndex, TypeList...>::KeyBits ParallelSoACSort<KeyIndex, TypeList...>::ToRadixBits(const KeyType aKey)
+	{
+		constexpr KeyBits signBit = static_cast<KeyBits>(KeyBits(1) << (sizeof(KeyBits) * 8 - 1));
+		KeyBits bits;
+		std::memcpy(&bits, &aKey, sizeof(KeyBits));
+
+		if constexpr (std::is_floating_point<KeyType>::value)
+		{
+			return static_cast<KeyBits>((bits & signBit) ? ~bits : (bits | signBit));
+		}
+		else if constexpr (std::is_signed<KeyType>::value)
+		{
+			return static_cast<KeyBits>(bits ^ signBit);
+		}
+		else
+		{
+			return bits;
+		}
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	inline typename ParallelSoACSort<KeyIndex, TypeList...>::KeyType ParallelSoACSort<KeyIndex, TypeList...>::FromRadixBits(const KeyBits someBits)
+	{
+		constexpr KeyBits signBit = static_cast<KeyBits>(KeyBits(1) << (sizeof(KeyBits) * 8 - 1));
+		KeyBits bits = someBits;
+		if constexpr (std::is_floating_point<KeyType>::value)
+		{
+			bits = static_cast<KeyBits>((bits & signBit) ? (bits ^ signBit) : ~bits);
+		}
+		else if constexpr (std::is_signed<KeyType>::value)
+		{
+			bits = static_cast<KeyBits>(bits ^ signBit);
+		}
+
+		KeyType key;
+		std::memcpy(&key, &bits, sizeof(KeyType));
+		return key;
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	inline size_t ParallelSoACSort<KeyIndex, TypeList...>::GetChunkCount(const size_t aCount, ThreadPool* aThreadPool)
+	{
+		return (aCount < parallelSortMinCount) ? 1 : ThreadPool::GetOrDefault(aThreadPool).GetParticipantCount();
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	template<class Function>
+	inline void ParallelSoACSort<KeyIndex, TypeList...>::RunChunks(const size_t aChunkCount, ThreadPool* aThreadPool, const Function& aFunction)
+	{
+		if (aChunkCount == 1)
+		{
+			aFunction(0);
+			return;
+		}
+
+		ThreadPool::GetOrDefault(aThreadPool).ParallelFor(aChunkCount, aFunction);
+	}
+
+	//Gathers every column into the order of someSortedEntries, then moves the sorted columns back over [aFirst, aFirst + count).
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	template<class Container, class Entry>
+	inline void ParallelSoACSort<KeyIndex, TypeList...>::ApplyOrder(Container& aContainerToSort, const size_t aFirst, const std::vector<Entry>& someSortedEntries, ThreadPool* aThreadPool)
+	{
+		const size_t count = someSortedEntries.size();
+		const size_t chunkCount = GetChunkCount(count, aThreadPool);
+		std::tuple<std::vector<TypeList>...> sortedColumns;
+		std::apply([count](auto& ... someColumns) { (someColumns.resize(count), ...); }, sortedColumns);
+
+		RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+		{
+			GatherColumns(aContainerToSort, aFirst, someSortedEntries, sortedColumns, GetChunkBegin(aChunk, chunkCount, count), GetChunkBegin(aChunk + 1, chunkCount, count),
+				std::make_index_sequence<sizeof...(TypeList)>{});
+		});
+
+		RunChunks(chunkCount, aThreadPool, [&](const size_t aChunk)
+		{
+			MoveColumnsBack(aContainerToSort, aFirst, sortedColumns, GetChunkBegin(aChunk, chunkCount, count), GetChunkBegin(aChunk + 1, chunkCount, count),
+				std::make_index_sequence<sizeof...(TypeList)>{});
+		});
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	template<class Container, class Entry, size_t ... IndexSequence>
+	inline void ParallelSoACSort<KeyIndex, TypeList...>::GatherColumns(Container& aContainerToSort, const size_t aFirst, const std::vector<Entry>& someSortedEntries,
+		std::tuple<std::vector<TypeList>...>& someSortedColumns, const size_t aBegin, const size_t anEnd, const std::index_sequence<IndexSequence...>&)
+	{
+		//One column at a time, reads are scattered but every write stream is sequential. The keys are already in order in the entries.
+		([&]()
+		{
+			auto* column = aContainerToSort.template Data<static_cast<TypeIndexType>(IndexSequence)>() + aFirst;
+			auto& sortedColumn = std::get<IndexSequence>(someSortedColumns);
+			for (size_t index = aBegin; index < anEnd; ++index)
+			{
+				if constexpr (IndexSequence == KeyIndex)
+				{
+					sortedColumn[index] = GetSortedKey(someSortedEntries[index]);
+				}
+				else
+				{
+					sortedColumn[index] = std::move(column[someSortedEntries[index].myIndex]);
+				}
+			}
+			column;
+		}(), ...);
+	}
+
+	template<TypeIndexType KeyIndex, class ... TypeList>
+	template<class Container, size_t ... IndexSequence>
+	inline void ParallelSoACSort<KeyIndex, TypeList...>::MoveColumnsBack(Container& aContainerToSort, const size_t aFirst, std::tuple<std::vector<TypeList>...>& someSortedColumns,
+		const size_t aBegin, const size_t anEnd, const std::index_sequence<IndexSequence...>&)
+	{
+		(std::move(std::get<IndexSequence>(someSortedColumns).begin() + aBegin, std::get<IndexSequence>(someSortedColumns).begin() + anEnd,
+			aContainerToSort.template Data<static_cast<TypeIndexType>(IndexSequence)>() + aFirst + aBegin), ...);
+	}
+}
+
+namespace CU = CommonUtility;
@@ -0,0 +1,404 @@
+#pragma once
+#include <tuple>
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <assert.h>
+
+/*
+	Column storage policies for BasicSoAC. A policy holds the columns in its nested Columns<TypeList...> template, which provides
+	Size(), Capacity(), Data<ColumnIndex>(), GetPaddedSize<ColumnIndex>(), EmplaceBack(someArgs...), Resize(aSize) and Reserve(aCapacity).
+
+	- VectorColumnStorage: one std::vector per column, each growing on its own.
+	- BlockColumnStorage<Alignment>: every column in one allocation at computed offsets, each starting on an Alignment boundary.
+	  Add checks the capacity once per row, growth allocates once and relocates every column into the new block,
+	  memcpy for trivially copyable columns, move construct and destroy for the rest. Reserve only allocates.
+	  Capacity is rounded so every trivially copyable column whose element size divides Alignment also ends on an Alignment boundary.
+	  GetPaddedSize<ColumnIndex>() rounds Size() up to whole Alignment blocks of such a column, SIMD kernels may read and write
+	  up to it without a scalar epilogue. Padding elements hold unspecified values.
+	- AlignedColumnStorage<Alignment>: BlockColumnStorage with a 64-byte default, cache line and AVX-512 width.
+*/
+
+namespace CommonUtility
+{
+	struct VectorColumnStorage
+	{
+		template<class ... TypeList>
+		class Columns
+		{
+		public:
+			template<class ... ArgTypes>
+			inline void EmplaceBack(ArgTypes&& ... someArgs)
+			{
+				static_assert(sizeof...(ArgTypes) == sizeof...(TypeList), "SoAC::Add needs one argument per column.");
+				EmplaceColumns(std::make_index_sequence<sizeof...(TypeList)>{}, std::forward<ArgTypes>(someArgs)...);
+			}
+
+			inline void Resize(const size_t aSize) { std::apply([aSize](auto& ... someColumns) { (someColumns.resize(aSize), ...); }, myColumns); }
+			inline void Reserve(const size_t aCapacity) { std::apply([aCapacity](auto& ... someColumns) { (someColumns.reserve(aCapacity), ...); }, myColumns); }
+
+			template<size_t ColumnIndex>
+			inline auto* Data() { return std::get<ColumnIndex>(myColumns).data(); }
+
+			template<size_t ColumnIndex>
+			inline const auto* Data() const { return std::get<ColumnIndex>(myColumns).data(); }
+
+			template<size_t ColumnIndex>
+			inline size_t GetPaddedSize() const { return Size(); }
+
+			inline size_t Size() const { return std::get<0>(myColumns).size(); }
+			inline size_t Capacity() const { return std::apply([](const auto& ... someColumns) { return (std::min)({ someColumns.capacity()... }); }, myColumns); }
+
+		private:
+			template<size_t ... IndexSequence, class ... ArgTypes>
+			inline void EmplaceColumns(const std::index_sequence<IndexSequence...>&, ArgTypes&& ... someArgs)
+			{
+				(std::get<IndexSequence>(myColumns).emplace_back(std::forward<ArgTypes>(someArgs)), ...);
+			}
+
+			std::tuple<std::vector<TypeList>...> myColumns;
+		};
+	};
+
+	template<size_t Alignment = alignof(std::max_align_t)>
+	struct BlockColumnStorage
+	{
+		static_assert((Alignment != 0) && ((Alignment & (Alignment - 1)) == 0), "BlockColumnStorage Alignment must be a power of two.");
+
+		template<class ... TypeList>
+		class Columns
+		{
+		public:
+			Columns() {}
+			Columns(const Columns& anOther);
+			Columns(Columns&& anOther) noexcept;
+			~Columns();
+
+			Columns& operator=(const Columns& anOther);
+			Columns& operator=(Columns&& anOther) noexcept;
+
+			template<class ... ArgTypes>
+			inline void EmplaceBack(ArgTypes&& ... someArgs);
+			inline void Resize(const size_t aSize);
+			inline void Reserve(const size_t aCapacity);
+
+			template<size_t ColumnIndex>
+			inline auto* Data() { return reinterpret_cast<ColumnType<ColumnIndex>*>(myBuffer + myColumnOffsets[ColumnIndex]); }
+
+			template<size_t ColumnIndex>
+			inline const auto* Data() const { return reinterpret_cast<const ColumnType<ColumnIndex>*>(myBuffer + myColumnOffsets[ColumnIndex]); }
+
+			template<size_t ColumnIndex>
+			inline size_t GetPaddedSize() const { return RoundUp(mySize, GetColumnPadding<ColumnType<ColumnIndex>>()); }
+
+			inline size_t Size() const { return mySize; }
+			inline size_t Capacity() const { return myCapacity; }
+
+		private:
+			template<size_t ColumnIndex>
+			using ColumnType = std::tuple_element_t<ColumnIndex, std::tuple<TypeList...>>;
+
+			static constexpr size_t blockAlignment = (std::max)({ Alignment, alignof(TypeList)... });
+
+			//Elements per Alignment block of a column. 1 when the element size does not divide Alignment or the type is not
+			//trivially copyable, such columns get no tail padding.
+			template<class T>
+			static constexpr size_t GetColumnPadding() { return (std::is_trivially_copyable<T>::value && ((Alignment % sizeof(T)) == 0)) ? (Alignment / sizeof(T)) : 1; }
+			static constexpr size_t RoundUp(const size_t aValue, const size_t aGranularity) { return ((aValue + aGranularity - 1) / aGranularity) * aGranularity; }
+
+			//Every padding is a power of two dividing Alignment, so a capacity that is a multiple of the largest one pads every column.
+			static constexpr size_t capacityGranularity = (std::max)({ GetColumnPadding<TypeList>()... });
+
+			template<class T>
+			static void Relocate(T* someSource, T* someDestination, const size_t aCount);
+			template<class T>
+			static void CopyConstruct(const T* someSource, T* someDestination, const size_t aCount);
+			template<class T>
+			static void Destroy(T* someElements, const size_t aCount);
+
+			template<size_t ... IndexSequence, class ... ArgTypes>
+			inline void Construct(const size_t anIndex, const std::index_sequence<IndexSequence...>&, ArgTypes&& ... someArgs);
+			template<size_t ... IndexSequence>
+			inline void ValueInitialize(const size_t anIndex, const std::index_sequence<IndexSequence...>&);
+			template<size_t ... IndexSequence>
+			inline void DestroyRange(const size_t aFirst, const size_t aLast, const std::index_sequence<IndexSequence...>&);
+			template<size_t ... IndexSequence>
+			inline void RelocateColumns(char* aBuffer, const std::array<size_t, sizeof...(TypeList)>& someColumnOffsets, const std::index_sequence<IndexSequence...>&);
+			template<size_t ... IndexSequence>
+			inline void CopyColumns(const Columns& anOther, const std::index_sequence<IndexSequence...>&);
+			inline std::array<size_t, sizeof...(TypeList)> ComputeColumnOffsets(const size_t aCapacity, size_t& anAllocatedBytesOut) const;
+			inline void Reallocate(const size_t aCapacity);
+			inline void Release();
+
+			char* myBuffer = nullptr;
+			std::array<size_t, sizeof...(TypeList)> myColumnOffsets = {};
+			size_t mySize = 0;
+			size_t myCapacity = 0;
+		};
+	};
+
+	template<size_t Alignment = 64>
+	using AlignedColumnStorage = BlockColumnStorage<Alignment>;
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline BlockColumnStorage<Alignment>::Columns<TypeList...>::Columns(const Columns& anOther)
+	{
+		*this = anOther;
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline BlockColumnStorage<Alignment>::Columns<TypeList...>::Columns(Columns&& anOther) noexcept
+	{
+		*this = std::move(anOther);
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline BlockColumnStorage<Alignment>::Columns<TypeList...>::~Columns()
+	{
+		Release();
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline typename BlockColumnStorage<Alignment>::template Columns<TypeList...>& BlockColumnStorage<Alignment>::Columns<TypeList...>::operator=(const Columns& anOther)
+	{
+		if (this == &anOther)
+			return *this;
+
+		Release();
+		if (anOther.mySize != 0)
+		{
+			Reallocate(RoundUp(anOther.mySize, capacityGranularity));
+			CopyColumns(anOther, std::make_index_sequence<sizeof...(TypeList)>{});
+			mySize = anOther.mySize;
+		}
+		return *this;
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline typename BlockColumnStorage<Alignment>::template Columns<TypeList...>& BlockColumnStorage<Alignment>::Columns<TypeList...>::operator=(Columns&& anOther) noexcept
+	{
+		if (this == &anOther)
+			return *this;
+
+		Release();
+		myBuffer = std::exchange(anOther.myBuffer, nullptr);
+		myColumnOffsets = std::exchange(anOther.myColumnOffsets, {});
+		mySize = std::exchange(anOther.mySize, 0);
+		myCapacity = std::exchange(anOther.myCapacity, 0);
+		return *this;
+	}
+
+	//One capacity check for the whole row, every column is constructed in place after it.
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<class ... ArgTypes>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::EmplaceBack(ArgTypes&& ... someArgs)
+	{
+		static_assert(sizeof...(ArgTypes) == sizeof...(TypeList), "SoAC::Add needs one argument per column.");
+		if (mySize == myCapacity)
+		{
+			//The arguments may point into the old buffer, build the row before it is released.
+			std::tuple<TypeList...> row(std::forward<ArgTypes>(someArgs)...);
+			Reallocate(RoundUp((std::max)(myCapacity * 2, capacityGranularity), capacityGranularity));
+			std::apply([this](TypeList& ... someValues) { Construct(mySize, std::make_index_sequence<sizeof...(TypeList)>{}, std::move(someValues)...); }, row);
+		}
+		else
+		{
+			Construct(mySize, std::make_index_sequence<sizeof...(TypeList)>{}, std::forward<ArgTypes>(someArgs)...);
+		}
+		++mySize;
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Resize(const size_t aSize)
+	{
+		if (aSize < mySize)
+		{
+			DestroyRange(aSize, mySize, std::make_index_sequence<sizeof...(TypeList)>{});
+			mySize = aSize;
+			return;
+		}
+
+		if (myCapacity < aSize)
+		{
+			Reallocate(RoundUp((std::max)(aSize, myCapacity * 2), capacityGranularity));
+		}
+
+		for (; mySize < aSize; ++mySize)
+		{
+			ValueInitialize(mySize, std::make_index_sequence<sizeof...(TypeList)>{});
+		}
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Reserve(const size_t aCapacity)
+	{
+		if (myCapacity < aCapacity)
+		{
+			Reallocate(RoundUp(aCapacity, capacityGranularity));
+		}
+	}
+
+	//Moves aCount elements to uninitialised memory and ends the lifetime of the sources.
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<class T>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Relocate(T* someSource, T* someDestination, const size_t aCount)
+	{
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			if (aCount != 0)
+			{
+				std::memcpy(someDestination, someSource, aCount * sizeof(T));
+			}
+		}
+		else
+		{
+			for (size_t index = 0; index < aCount; ++index)
+			{
+				new (someDestination + index) T(std::move_if_noexcept(someSource[index]));
+				someSource[index].~T();
+			}
+		}
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<class T>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::CopyConstruct(const T* someSource, T* someDestination, const size_t aCount)
+	{
+		if constexpr (std::is_trivially_copyable<T>::value)
+		{
+			if (aCount != 0)
+			{
+				std::memcpy(someDestination, someSource, aCount * sizeof(T));
+			}
+		}
+		else
+		{
+			for (size_t index = 0; index < aCount; ++index)
+			{
+				new (someDestination + index) T(someSource[index]);
+			}
+		}
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<class T>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Destroy(T* someElements, const size_t aCount)
+	{
+		//For trivially destructible columns the loop body is empty and compiles away.
+		for (size_t index = 0; index < aCount; ++index)
+		{
+			if constexpr (!std::is_trivially_destructible<T>::value)
+			{
+				someElements[index].~T();
+			}
+		}
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<size_t ... IndexSequence, class ... ArgTypes>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Construct(const size_t anIndex, const std::index_sequence<IndexSequence...>&, ArgTypes&& ... someArgs)
+	{
+		((new (Data<IndexSequence>() + anIndex) TypeList(std::forward<ArgTypes>(someArgs))), ...);
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<size_t ... IndexSequence>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::ValueInitialize(const size_t anIndex, const std::index_sequence<IndexSequence...>&)
+	{
+		((new (Data<IndexSequence>() + anIndex) TypeList()), ...);
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<size_t ... IndexSequence>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::DestroyRange(const size_t aFirst, const size_t aLast, const std::index_sequence<IndexSequence...>&)
+	{
+		(Destroy(Data<IndexSequence>() + aFirst, aLast - aFirst), ...);
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<size_t ... IndexSequence>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::RelocateColumns(char* aBuffer, const std::array<size_t, sizeof...(TypeList)>& someColumnOffsets, const std::index_sequence<IndexSequence...>&)
+	{
+		(Relocate(Data<IndexSequence>(), reinterpret_cast<TypeList*>(aBuffer + someColumnOffsets[IndexSequence]), mySize), ...);
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	template<size_t ... IndexSequence>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::CopyColumns(const Columns& anOther, const std::index_sequence<IndexSequence...>&)
+	{
+		(CopyConstruct(anOther.template Data<IndexSequence>(), Data<IndexSequence>(), anOther.mySize), ...);
+	}
+
+	//Each column starts on the next blockAlignment boundary after the previous one.
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline std::array<size_t, sizeof...(TypeList)> BlockColumnStorage<Alignment>::Columns<TypeList...>::ComputeColumnOffsets(const size_t aCapacity, size_t& anAllocatedBytesOut) const
+	{
+		constexpr std::array<size_t, sizeof...(TypeList)> elementSizes = { sizeof(TypeList)... };
+		std::array<size_t, sizeof...(TypeList)> columnOffsets = {};
+		anAllocatedBytesOut = 0;
+		for (size_t column = 0; column < sizeof...(TypeList); ++column)
+		{
+			columnOffsets[column] = anAllocatedBytesOut;
+			anAllocatedBytesOut += RoundUp(aCapacity * elementSizes[column], blockAlignment);
+		}
+		return columnOffsets;
+	}
+
+	//The only growth path: one allocation for all columns, then every column relocated into it.
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Reallocate(const size_t aCapacity)
+	{
+		size_t allocatedBytes = 0;
+		const std::array<size_t, sizeof...(TypeList)> columnOffsets = ComputeColumnOffsets(aCapacity, allocatedBytes);
+		char* buffer = static_cast<char*>(::operator new(allocatedBytes, std::align_val_t(blockAlignment)));
+		if (myBuffer != nullptr)
+		{
+			RelocateColumns(buffer, columnOffsets, std::make_index_sequence<sizeof...(TypeList)>{});
+			::operator delete(myBuffer, std::align_val_t(blockAlignment));
+		}
+
+		myBuffer = buffer;
+		myColumnOffsets = columnOffsets;
+		myCapacity = aCapacity;
+	}
+
+	template<size_t Alignment>
+	template<class ... TypeList>
+	inline void BlockColumnStorage<Alignment>::Columns<TypeList...>::Release()
+	{
+		if (myBuffer != nullptr)
+		{
+			DestroyRange(0, mySize, std::make_index_sequence<sizeof...(TypeList)>{});
+			::operator delete(myBuffer, std::align_val_t(blockAlignment));
+		}
+		myBuffer = nullptr;
+		myColumnOffsets = {};
+		mySize = 0;
+		myCapacity = 0;
+	}
+}
+
+namespace CU = CommonUtility;
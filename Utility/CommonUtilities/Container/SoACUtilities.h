@@ -2,6 +2,10 @@
 #include "SoAC.h"
 #include "TemplateUtility/ChooseType.h"
 #include "TemplateUtility/TypeTraits.h"
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <assert.h>
 #define ISORT_MAX 32 //maximum size for insertion sort.
 
 //Since all iterator logic works as an indirection to indices indicises can be used(in my case at least).
@@ -31,30 +35,66 @@ namespace CommonUtility
 	struct ISort
 	{
 	public:
+		//Type erased predicate for callers that need to store one. The sort takes any callable and is only bound to an indirect call when handed this.
 		using PredicateSignature = std::function<const bool(const std::tuple<const TypeList&...>&, const std::tuple<const TypeList&...>&)>;
 
-		ISort(SoAC<TypeList...>& aContainerToSort, size_t aFirst, size_t aLast, const PredicateSignature& aPredicate) : myContainerToSort(aContainerToSort)
+		//aPredicate is called with the rows as tuples of references, a generic lambda(const auto&, const auto&) compiles down to the column accesses it makes.
+		template<class ColumnStorage, class Predicate>
+		ISort(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, size_t aFirst, size_t aLast, const Predicate& aPredicate)
+			: myContainerToSort{ GetColumns(aContainerToSort, std::make_index_sequence<sizeof...(TypeList)>{}), aContainerToSort.Size() }
 		{
 			IntroSort(aFirst, aLast, aLast - aFirst, aPredicate);
 		}
 
 	private:
+		//Rows of the sorted container through its column pointers, so the sort is the same for every column storage.
+		struct ColumnRows
+		{
+			std::tuple<TypeList*...> myColumns;
+			size_t mySize;
+
+			inline std::tuple<TypeList&...> operator[](const size_t anIndex) const
+			{
+				return std::apply([anIndex](TypeList* ... someColumns) { return std::tuple<TypeList&...>(someColumns[anIndex]...); }, myColumns);
+			}
+
+			inline void Swap(const size_t aFirstIndex, const size_t aSecondIndex) const
+			{
+				std::apply([aFirstIndex, aSecondIndex](TypeList* ... someColumns) { (std::swap(someColumns[aFirstIndex], someColumns[aSecondIndex]), ...); }, myColumns);
+			}
 
-		inline void IntroSort(size_t aFirst, size_t aLast, size_t anIdeal, const PredicateSignature& aPredicate);
-		inline std::pair<size_t, size_t> PartitionByMedianGuess(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate);
-		inline void GuessMedian(size_t aFirst, size_t aMid, size_t aLast, const PredicateSignature& aPredicate);
-		inline void MedianOfThree(size_t aFirst, size_t aMid, size_t aLast, const PredicateSignature& aPredicate);
-		inline void HeapSort(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate);
-		inline void BuildHeap(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate);
-		inline void InsertionSort(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate);
+			inline size_t Size() const { return mySize; }
+		};
 
-		SoAC<TypeList...>& myContainerToSort;
+		template<class Container, size_t ... IndexSequence>
+		static std::tuple<TypeList*...> GetColumns(Container& aContainer, const std::index_sequence<IndexSequence...>&)
+		{
+			return std::tuple<TypeList*...>(aContainer.template Data<IndexSequence>()...);
+		}
+
+		template<class Predicate>
+		inline void IntroSort(size_t aFirst, size_t aLast, size_t anIdeal, const Predicate& aPredicate);
+		template<class Predicate>
+		inline std::pair<size_t, size_t> PartitionByMedianGuess(size_t aFirst, size_t aLast, const Predicate& aPredicate);
+		template<class Predicate>
+		inline void GuessMedian(size_t aFirst, size_t aMid, size_t aLast, const Predicate& aPredicate);
+		template<class Predicate>
+		inline void MedianOfThree(size_t aFirst, size_t aMid, size_t aLast, const Predicate& aPredicate);
+		template<class Predicate>
+		inline void HeapSort(size_t aFirst, size_t aLast, const Predicate& aPredicate);
+		template<class Predicate>
+		inline void BuildHeap(size_t aFirst, size_t aLast, size_t aRoot, const Predicate& aPredicate);
+		template<class Predicate>
+		inline void InsertionSort(size_t aFirst, size_t aLast, const Predicate& aPredicate);
+
+		ColumnRows myContainerToSort;
 
 	};
 
-	//Intro sort implementation using indices instead of iterators. allows for complex predicate but will be slower. TODO: Implement intro sort with iterators, where the predicate only cares about a single type.
+	//Intro sort implementation using indices instead of iterators. allows for complex predicate but will be slower. ISortLite is cheaper when the predicate only cares about a single type.
 	template<class ... TypeList>
-	inline void ISort<TypeList...>::IntroSort(size_t aFirst, size_t aLast, size_t anIdeal, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline void ISort<TypeList...>::IntroSort(size_t aFirst, size_t aLast, size_t anIdeal, const Predicate& aPredicate)
 	{
 		size_t count;
 		while ((ISORT_MAX < (count = aLast - aFirst)) && (0 < anIdeal))
@@ -87,7 +127,8 @@ namespace CommonUtility
 
 	//partition [aFirst,aLast) using aPredicate. aka from aFirst(inclusive) to aLast(Exclusive).
 	template<class ... TypeList>
-	inline std::pair<size_t, size_t> ISort<TypeList...>::PartitionByMedianGuess(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline std::pair<size_t, size_t> ISort<TypeList...>::PartitionByMedianGuess(size_t aFirst, size_t aLast, const Predicate& aPredicate)
 	{
 		size_t mid = aFirst + ((aLast - aFirst) >> 1);//Here std uses bitshift instead of division.
 		GuessMedian(aFirst, mid, aLast - 1, aPredicate);//poor naming, actually does a median guess then sorts that elment to the middle.
@@ -188,7 +229,8 @@ namespace CommonUtility
 	}
 
 	template<class ... TypeList>
-	inline void ISort<TypeList...>::GuessMedian(size_t aFirst, size_t aMid, size_t aLast, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline void ISort<TypeList...>::GuessMedian(size_t aFirst, size_t aMid, size_t aLast, const Predicate& aPredicate)
 	{
 		size_t count = aLast - aFirst;
 		//Kind of arbitrarily picks a set of elements to move around for good pivots.
@@ -208,7 +250,8 @@ namespace CommonUtility
 	}
 
 	template<class ... TypeList>
-	inline void ISort<TypeList...>::MedianOfThree(size_t aFirst, size_t aMid, size_t aLast, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline void ISort<TypeList...>::MedianOfThree(size_t aFirst, size_t aMid, size_t aLast, const Predicate& aPredicate)
 	{
 		if (aPredicate(myContainerToSort[aMid], myContainerToSort[aFirst]))
 		{
@@ -226,57 +269,65 @@ namespace CommonUtility
 	}
 
 	template<class ... TypeList>
-	inline void ISort<TypeList...>::HeapSort(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline void ISort<TypeList...>::HeapSort(size_t aFirst, size_t aLast, const Predicate& aPredicate)
 	{
-		// Build heap (rearrange array) 
-		for (size_t i = (aLast / 2) - 1; (i >= aFirst) && (i < myContainerToSort.Size()); i--)
+		// Build heap (rearrange array), heap positions are relative to aFirst.
+		for (size_t i = (aLast - aFirst) / 2; 0 < i;)
 		{
-			BuildHeap(aLast, i, aPredicate);
+			BuildHeap(aFirst, aLast, --i, aPredicate);
 		}
 
 		// One by one extract an element from heap 
-		for (size_t i = aLast - 1; (i >= aFirst) && (i < myContainerToSort.Size()); i--)
+		for (size_t i = aLast - 1; aFirst < i; i--)
 		{
 			myContainerToSort.Swap(aFirst, i);
-			BuildHeap(i, aFirst, aPredicate);
+			BuildHeap(aFirst, i, 0, aPredicate);
 		}
 	}
 
+	//Sifts aRoot down the heap stored in [aFirst, aLast).
 	template<class ... TypeList>
-	inline void ISort<TypeList...>::BuildHeap(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline void ISort<TypeList...>::BuildHeap(size_t aFirst, size_t aLast, size_t aRoot, const Predicate& aPredicate)
 	{
-		size_t risingIndex = aFirst;
-		size_t left = 2 * aFirst + 1;
-		size_t right = 2 * aFirst + 2;
-
-		if ((left < aLast) && aPredicate(myContainerToSort.Get(risingIndex), myContainerToSort.Get(left)))
+		const size_t heapSize = aLast - aFirst;
+		for (;;)
 		{
-			risingIndex = left;
-		}
+			size_t risingIndex = aRoot;
+			size_t left = 2 * aRoot + 1;
+			size_t right = 2 * aRoot + 2;
 
-		if ((right < aLast) && aPredicate(myContainerToSort.Get(risingIndex), myContainerToSort.Get(right)))
-		{
-			risingIndex = right;
-		}
+			if ((left < heapSize) && aPredicate(myContainerToSort[aFirst + risingIndex], myContainerToSort[aFirst + left]))
+			{
+				risingIndex = left;
+			}
 
-		if (risingIndex != aFirst)
-		{
-			myContainerToSort.Swap(aFirst, risingIndex);
-			BuildHeap(aLast, risingIndex, aPredicate);
+			if ((right < heapSize) && aPredicate(myContainerToSort[aFirst + risingIndex], myContainerToSort[aFirst + right]))
+			{
+				risingIndex = right;
+			}
+
+			if (risingIndex == aRoot)
+				return;
+
+			myContainerToSort.Swap(aFirst + aRoot, aFirst + risingIndex);
+			aRoot = risingIndex;
 		}
 	}
 
 	template<class ... TypeList>
-	inline void ISort<TypeList...>::InsertionSort(size_t aFirst, size_t aLast, const PredicateSignature& aPredicate)
+	template<class Predicate>
+	inline void ISort<TypeList...>::InsertionSort(size_t aFirst, size_t aLast, const Predicate& aPredicate)
 	{
 		size_t i, j;
 		std::tuple<TypeList...> tempStore;
 		for (i = aFirst + 1; i < aLast; ++i)
 		{
-			tempStore = myContainerToSort.Get(i);
+			tempStore = myContainerToSort[i];
 			std::tuple<TypeList&...> comp = TupleUtil<TypeList...>::ConstructReference(tempStore);
 			j = i - 1;
-			while ((j < myContainerToSort.Size()) && (j >= aFirst) && aPredicate(comp, myContainerToSort.Get(j)))
+			while ((j < myContainerToSort.Size()) && (j >= aFirst) && aPredicate(comp, myContainerToSort[j]))
 			{
 				myContainerToSort[j + 1] = myContainerToSort[j];
 				--j;
@@ -286,44 +337,72 @@ namespace CommonUtility
 	}
 
 
+	/*
+		Intro sort on a single column of the SoAC. Only the keys, paired with their original positions, are moved while sorting,
+		so the predicate and every exchange touch one small contiguous array instead of swapping all columns through SoAC::Swap.
+		The other columns are then gathered into the sorted order once, one column at a time.
+	*/
 	template<TypeIndexType PredicateIndex, class PredSigType, class ... TypeList>
 	struct ISortLite
 	{
 	public:
 		using PredicateType = typename TemplateUtility::ChooseType<PredicateIndex, TypeList...>;
-
 		using PredicateSignature = PredSigType;
-		using IteratorType = typename std::vector<PredicateType>::iterator;
-		using IteratorDiffType = typename IteratorType::difference_type;
 
-		ISortLite(SoAC<TypeList...>& aContainerToSort, size_t aFirst, size_t aLast, const PredicateSignature& aPredicate) : myContainerToSort(aContainerToSort)
+		template<class ColumnStorage>
+		ISortLite(BasicSoAC<ColumnStorage, TypeList...>& aContainerToSort, size_t aFirst, size_t aLast, const PredicateSignature& aPredicate)
 		{
-			/*TODO: Implement std introsort much like ISort functor. Key here is that there should be considerably less overhead as only one array in the SoA needs accessing during Predicate.
-				only cache problem should be the need for container.Swap(a,b).  consider using iterators instead of indices for cache considerations during predicate operations. resolve index requirements by:
-				Iterator - container.begin() = index;*/
-			std::vector<PredicateType>& container = aContainerToSort.GetTypeArray<PredicateIndex>();
-			myContainerHead = container.begin();
-
-			IteratorType iteratorBegin = myContainerHead + aFirst;
-			IteratorType iteratorEnd = myContainerHead + aLast;
-			IteratorDiffType ideal = iteratorEnd - iteratorBegin;
-			IntroSort(iteratorBegin, iteratorEnd, ideal, aPredicate);
+			assert((aLast - aFirst) <= std::numeric_limits<unsigned int>::max() && "ISortLite range too large for 32-bit entry indices.");
+			PredicateType* keys = aContainerToSort.template Data<PredicateIndex>();
+			myEntries.reserve(aLast - aFirst);
+			for (size_t index = aFirst; index < aLast; ++index)
+			{
+				myEntries.push_back(KeyEntry{ std::move(keys[index]), static_cast<unsigned int>(index - aFirst) });
+			}
+
+			IntroSort(myEntries.begin(), myEntries.end(), myEntries.end() - myEntries.begin(), aPredicate);
+
+			for (size_t index = 0; index < myEntries.size(); ++index)
+			{
+				keys[aFirst + index] = std::move(myEntries[index].myKey);
+			}
+			PermuteColumns(aContainerToSort, aFirst, std::make_index_sequence<sizeof...(TypeList)>{});
 		}
 
 	private:
+		struct KeyEntry
+		{
+			PredicateType myKey;
+			unsigned int myIndex;//Position relative to aFirst before sorting, 32 bits keep small keys and their index in 8 bytes.
+		};
 
-		//inline IteratorType GetBegin() { return myContainerHead; }
+		using IteratorType = typename std::vector<KeyEntry>::iterator;
+		using IteratorDiffType = typename IteratorType::difference_type;
 
-		//inline void IntroSort(IteratorType aFirst, IteratorType aLast, size_t anIdeal, const PredicateSignature& aPredicate);
-		//inline std::pair<IteratorType, IteratorType> PartitionByMedianGuess(IteratorType aFirst, IteratorType aLast, const PredicateSignature& aPredicate);
-		//inline void GuessMedian(IteratorType aFirst, IteratorType aMid, IteratorType aLast, const PredicateSignature& aPredicate);
-		//inline void MedianOfThree(IteratorType aFirst, IteratorType aMid, IteratorType aLast, const PredicateSignature& aPredicate);
-		//inline void HeapSort(IteratorType aFirst, IteratorType aLast, const PredicateSignature& aPredicate);
-		//inline void BuildHeap(IteratorType aFirst, IteratorType aLast, const PredicateSignature& aPredicate);
-		//inline void InsertionSort(IteratorType aFirst, IteratorType aLast, const PredicateSignature& aPredicate);
+		std::vector<KeyEntry> myEntries;
+
+		template<class Container, size_t ... IndexSequence>
+		inline void PermuteColumns(Container& aContainerToSort, const size_t aFirst, const std::index_sequence<IndexSequence...>&)
+		{
+			(PermuteColumn<static_cast<TypeIndexType>(IndexSequence)>(aContainerToSort, aFirst), ...);
+		}
 
-		SoAC<TypeList...>& myContainerToSort;
-		IteratorType myContainerHead;
+		template<TypeIndexType TypeIndex, class Container>
+		inline void PermuteColumn(Container& aContainerToSort, const size_t aFirst)
+		{
+			if constexpr (TypeIndex != PredicateIndex)
+			{
+				using ColumnType = typename TemplateUtility::ChooseType<TypeIndex, TypeList...>;
+				ColumnType* column = aContainerToSort.template Data<TypeIndex>() + aFirst;
+				std::vector<ColumnType> sortedColumn;
+				sortedColumn.reserve(myEntries.size());
+				for (const KeyEntry& entry : myEntries)
+				{
+					sortedColumn.push_back(std::move(column[entry.myIndex]));
+				}
+				std::move(sortedColumn.begin(), sortedColumn.end(), column);
+			}
+		}
 
 		inline void IntroSort(IteratorType aFirst, IteratorType aLast, IteratorDiffType anIdeal, const PredicateSignature & aPredicate)
 		{
@@ -363,15 +442,15 @@ namespace CommonUtility
 			IteratorType last = first + 1;
 
 			while ((aFirst < first)
-				&& (!aPredicate(*(first - 1), *first))
-				&& (!aPredicate(*first, *(first - 1))))
+				&& (!aPredicate((first - 1)->myKey, first->myKey))
+				&& (!aPredicate(first->myKey, (first - 1)->myKey)))
 			{
 				--first;
 			}
 
 			while ((last < aLast)
-				&& !aPredicate(*last, *first)
-				&& !aPredicate(*first, *last))
+				&& !aPredicate(last->myKey, first->myKey)
+				&& !aPredicate(first->myKey, last->myKey))
 			{
 				++last;
 			}
@@ -383,17 +462,17 @@ namespace CommonUtility
 			{
 				for (; gFirst < aLast; ++gFirst)
 				{
-					if (aPredicate(*first, *gFirst))
+					if (aPredicate(first->myKey, gFirst->myKey))
 					{
 
 					}
-					else if (aPredicate(*gFirst, *first))
+					else if (aPredicate(gFirst->myKey, first->myKey))
 					{
 						break;
 					}
 					else if (last != gFirst)
 					{
-						myContainerToSort.Swap(last - myContainerHead, gFirst - myContainerHead);
+						std::iter_swap(last, gFirst);
 						++last;
 					}
 					else
@@ -404,17 +483,17 @@ namespace CommonUtility
 
 				for (; aFirst < gLast; --gLast)
 				{
-					if (aPredicate(*(gLast - 1), *first))
+					if (aPredicate((gLast - 1)->myKey, first->myKey))
 					{
 
 					}
-					else if (aPredicate(*first, *(gLast - 1)))
+					else if (aPredicate(first->myKey, (gLast - 1)->myKey))
 					{
 						break;
 					}
 					else if ((--first) != (gLast - 1))
 					{
-						myContainerToSort.Swap(first - myContainerHead, (gLast - 1) - myContainerHead);
+						std::iter_swap(first, gLast - 1);
 					}
 				}
 
@@ -427,11 +506,11 @@ namespace CommonUtility
 				{
 					if (last != gFirst)
 					{
-						myContainerToSort.Swap(first - myContainerHead, last - myContainerHead);
+						std::iter_swap(first, last);
 					}
 
 					++last;
-					myContainerToSort.Swap(first - myContainerHead, gFirst - myContainerHead);
+					std::iter_swap(first, gFirst);
 					++first;
 					++gFirst;
 				}
@@ -439,13 +518,13 @@ namespace CommonUtility
 				{
 					if ((--gLast) != (--first))
 					{
-						myContainerToSort.Swap(gLast - myContainerHead, first - myContainerHead);
+						std::iter_swap(gLast, first);
 					}
-					myContainerToSort.Swap(first - myContainerHead, (--last) - myContainerHead);
+					std::iter_swap(first, --last);
 				}
 				else
 				{
-					myContainerToSort.Swap(gFirst - myContainerHead, (--gLast) - myContainerHead);
+					std::iter_swap(gFirst, --gLast);
 					++gFirst;
 				}
 			}
@@ -453,11 +532,11 @@ namespace CommonUtility
 
 		inline void GuessMedian(IteratorType aFirst, IteratorType aMid, IteratorType aLast, const PredicateSignature & aPredicate)
 		{
-			size_t count = aLast - aFirst;
+			IteratorDiffType count = aLast - aFirst;
 			if (40 < count)
 			{
-				size_t step = (count + 1) >> 3;
-				size_t twoStep = step << 1;
+				IteratorDiffType step = (count + 1) >> 3;
+				IteratorDiffType twoStep = step << 1;
 				MedianOfThree(aFirst, aFirst + step, aFirst + twoStep, aPredicate);
 				MedianOfThree(aMid - step, aMid, aMid + step, aPredicate);
 				MedianOfThree(aLast - twoStep, aLast - step, aLast, aPredicate);
@@ -471,80 +550,76 @@ namespace CommonUtility
 
 		inline void MedianOfThree(IteratorType aFirst, IteratorType aMid, IteratorType aLast, const PredicateSignature & aPredicate)
 		{
-			if (aPredicate(*aMid, *aFirst))
+			if (aPredicate(aMid->myKey, aFirst->myKey))
 			{
-				myContainerToSort.Swap(aMid - myContainerHead, aFirst - myContainerHead);
+				std::iter_swap(aMid, aFirst);
 			}
 
-			if (aPredicate(*aLast, *aMid))
+			if (aPredicate(aLast->myKey, aMid->myKey))
 			{
-				myContainerToSort.Swap(aLast - myContainerHead, aMid - myContainerHead);
-				if (aPredicate(*aMid, *aFirst))
+				std::iter_swap(aLast, aMid);
+				if (aPredicate(aMid->myKey, aFirst->myKey))
 				{
-					myContainerToSort.Swap(aMid - myContainerHead, aFirst - myContainerHead);
+					std::iter_swap(aMid, aFirst);
 				}
 			}
 		}
 
 		inline void HeapSort(IteratorType aFirst, IteratorType aLast, const PredicateSignature & aPredicate)
 		{
-			size_t firstIndex = aFirst - myContainerHead;
-			size_t lastIndex = aLast - myContainerHead;
-
-			for (size_t i = (lastIndex / 2) - 1; (i >= firstIndex) && (i < myContainerToSort.Size()); i--)
+			const IteratorDiffType count = aLast - aFirst;
+			for (IteratorDiffType root = count >> 1; 0 < root;)
 			{
-				BuildHeap(myContainerHead + lastIndex, myContainerHead + i, aPredicate);
+				BuildHeap(aFirst, --root, count, aPredicate);
 			}
 
-			for (size_t i = lastIndex - 1; (i >= firstIndex) && (i < myContainerToSort.Size()); i--)
+			for (IteratorDiffType heapSize = count - 1; 0 < heapSize; --heapSize)
 			{
-				myContainerToSort.Swap(firstIndex, i);
-				BuildHeap(myContainerHead + i, myContainerHead + firstIndex, aPredicate);
+				std::iter_swap(aFirst, aFirst + heapSize);
+				BuildHeap(aFirst, 0, heapSize, aPredicate);
 			}
 		}
 
-		inline void BuildHeap(IteratorType aFirst, IteratorType aLast, const PredicateSignature & aPredicate)
+		//Sifts aRoot down the heap of aHeapSize entries starting at aFirst.
+		inline void BuildHeap(IteratorType aFirst, IteratorDiffType aRoot, const IteratorDiffType aHeapSize, const PredicateSignature & aPredicate)
 		{
-			IteratorType rising = aFirst;
-			size_t baseIndex = (aFirst - myContainerHead) * 2;
-			IteratorType left = (myContainerHead + baseIndex) + 1;
-			IteratorType right = (myContainerHead + baseIndex) + 2;
-
-			if ((left < aLast) && aPredicate(*rising, *left))
+			for (;;)
 			{
-				rising = left;
-			}
+				IteratorDiffType rising = aRoot;
+				const IteratorDiffType left = 2 * aRoot + 1;
+				const IteratorDiffType right = left + 1;
 
-			if ((right < aLast) && aPredicate(*rising, *right))
-			{
-				rising = right;
-			}
+				if ((left < aHeapSize) && aPredicate(aFirst[rising].myKey, aFirst[left].myKey))
+				{
+					rising = left;
+				}
 
-			if (rising != aFirst)
-			{
-				myContainerToSort.Swap(aFirst - myContainerHead, rising - myContainerHead);
-				BuildHeap(aLast, rising, aPredicate);
+				if ((right < aHeapSize) && aPredicate(aFirst[rising].myKey, aFirst[right].myKey))
+				{
+					rising = right;
+				}
+
+				if (rising == aRoot)
+					return;
+
+				std::iter_swap(aFirst + aRoot, aFirst + rising);
+				aRoot = rising;
 			}
 		}
 
 		inline void InsertionSort(IteratorType aFirst, IteratorType aLast, const PredicateSignature & aPredicate)
 		{
-			IteratorType i, j;
-			PredicateType predicateValue;
-			std::tuple<TypeList...> t;
-			for (i = aFirst + 1; i < aLast; ++i)
+			for (IteratorType i = aFirst + 1; i < aLast; ++i)
 			{
-				predicateValue = *i;
-				j = i - 1;
-				while ((j < aLast) && (j >= aFirst) && aPredicate(predicateValue, *j))
+				KeyEntry entry = std::move(*i);
+				IteratorType j = i;
+				for (; (aFirst < j) && aPredicate(entry.myKey, (j - 1)->myKey); --j)
 				{
-					myContainerToSort[(j + 1) - myContainerHead] = myContainerToSort[j - myContainerHead];
-					--j;
+					*j = std::move(*(j - 1));
 				}
-				myContainerToSort[(j + 1) - myContainerHead] = myContainerToSort[i - myContainerHead];
+				*j = std::move(entry);
 			}
 		}
-
 	};
 }
 
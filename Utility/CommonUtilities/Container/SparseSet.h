@@ -1,23 +1,131 @@
 #pragma once
 #include <vector>
+#include <memory>
 #include <assert.h>
 #include <limits>
+#include <algorithm>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPARSESET_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SPARSESET_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+	The sparse side of the set is a storage policy mapping an element to the slot holding its dense index.
+	The default, PagedSparseStorage, is paged. Pages of pageSize slots are allocated the first time an element
+	inside their range is added, a missing page reads as "not present". Memory therefore follows the amount
+	of live elements(and how clustered they are) instead of the value of the largest element ever added.
+	Elements from a huge or hashed id space(64-bit network ids, type hashes) would still scatter over one page each,
+	HashedSparseStorage(HashedSparseStorage.h) maps them through an open addressing table instead.
+
+	A storage policy provides:
+	- T* FindSlot(anElement), nullptr when the element never got a slot. AssureSlot(anElement) creates it reading failureIndex.
+	  A slot holding failureIndex means "not present", the set writes it on removal instead of erasing the slot.
+	- PrepareFor(someElements, aCount), Reserve(aCount, aMaxElement), ShrinkToFit(someLiveElements), Clear(),
+	  GetAllocatedBytes() and Prefetch(anElement).
+	- supportsPresenceBitmap, true when sparse indices are small enough to keep one bit each,
+	  GetSlotBySparseIndex(aSparseIndex) is then used to turn set bits back into elements.
+	- hasDirectLookup, true when FindSlot computes the slot address instead of searching for it.
+
+	The multi-set Intersection picks one of three strategies, fastest first:
+	- Every set keeps a presence bitmap(see EnablePresenceBitmap) and the bitmaps are small compared to the smallest set:
+	  the bitmaps are ANDed word-wise, with AVX2 or SSE2 when available, and only set bits are turned back into elements.
+	- Every element of the smallest set is probed in the other sets through Find. The default, with a direct lookup it beats
+	  merging sorted sets at every size ratio measured(1 to 256), skipping ahead never pays for the extra compares.
+	- Every set sorted(see IsSorted), the storage searches for its slots(no hasDirectLookup) and the smallest set holds at
+	  least gallopMinimumSize elements: galloping merge over the dense lists. Hashed Finds miss the cache once the tables
+	  outgrow it, walking the dense lists in order doesn't.
+*/
 
 namespace CommonUtility
 {
-	template<class T = unsigned int>
+	//Maps an element to its slot on the sparse side. The default addresses the sparse side with the element value itself.
+	template<class T>
+	struct SparseIdentity
+	{
+		static constexpr bool isIdentity = true;
+
+		static constexpr T ToSparse(const T anElement)
+		{
+			return anElement;
+		}
+	};
+
+	template<class T, class SparseIndexer = SparseIdentity<T>>
+	class PagedSparseStorage
+	{
+	public:
+		static constexpr T failureIndex = std::numeric_limits<T>::max();
+		static constexpr size_t pageSize = 1024;//Slots per sparse page, must be a power of two.
+		static constexpr bool supportsPresenceBitmap = true;
+		static constexpr bool hasDirectLookup = true;
+
+		PagedSparseStorage() {}
+		PagedSparseStorage(const PagedSparseStorage& anOtherStorage);
+		PagedSparseStorage(PagedSparseStorage&& anOtherStorage) = default;
+
+		PagedSparseStorage& operator=(const PagedSparseStorage& anOtherStorage);
+		PagedSparseStorage& operator=(PagedSparseStorage&& anOtherStorage) = default;
+
+		T* FindSlot(const T anElement);
+		const T* FindSlot(const T anElement) const;
+		T& AssureSlot(const T anElement);
+		const T& GetSlotBySparseIndex(const size_t aSparseIndex) const;
+
+		void PrepareFor(const T* someElements, const size_t aCount);//Grows the page table once for the whole batch.
+		void Reserve(const size_t aCount, const T aMaxElement);//Sizes the page table, pages are still allocated on first use.
+		void ShrinkToFit(const std::vector<T>& someLiveElements);//Releases pages that no longer hold any of someLiveElements.
+		void Clear();
+		size_t GetAllocatedBytes() const;
+		void Prefetch(const T anElement) const;
+
+	private:
+		static_assert((pageSize & (pageSize - 1)) == 0, "PagedSparseStorage pageSize must be a power of two.");
+
+		using SparsePage = std::unique_ptr<T[]>;
+
+		static constexpr size_t GetPageIndex(const T anElement) { return static_cast<size_t>(SparseIndexer::ToSparse(anElement)) / pageSize; }
+		static constexpr size_t GetPageOffset(const T anElement) { return static_cast<size_t>(SparseIndexer::ToSparse(anElement)) & (pageSize - 1); }
+
+		std::vector<SparsePage> mySparsePages;
+		size_t myAllocatedPageCount = 0;
+	};
+
+	/*
+		A SparseIndexer that is not the identity lets several distinct elements share a sparse slot(e.g. versioned handles).
+		Find then also compares the dense value against the element so only the exact element stored is reported as valid.
+	*/
+	template<class T = unsigned int, class SparseIndexer = SparseIdentity<T>, class SparseStorage = PagedSparseStorage<T, SparseIndexer>>
 	class SparseSet
 	{
 	public:
 		static constexpr T failureIndex = std::numeric_limits<T>::max();
 
 		SparseSet();
+		SparseSet(const SparseSet& anOtherSet);
+		SparseSet(SparseSet&& anOtherSet) = default;
 		~SparseSet();
 
+		SparseSet& operator=(const SparseSet& anOtherSet);
+		SparseSet& operator=(SparseSet&& anOtherSet) = default;
+
 		void Add(const T anElement);
+		void AddMany(const T* someElements, const size_t aCount);//Grows the dense list and the page table once for the whole batch.
 		void RemoveCyclic(const T anElement);//Removes the element by swapping places with the last element and removing the tail of the array. Naturally changes order of elements but is faster.
 		void Remove(const T anElement);//Slower than RemoveCyclic but retains relative order of dense elements
+		void RemoveMany(const T* someElements, const size_t aCount);//Order-preserving removal of a batch in one compaction pass. Elements not in the set are ignored.
 		void Clear();
+		void Reserve(const size_t aCapacity);//Reserves room for aCapacity dense elements.
+		void Reserve(const size_t aCapacity, const T aMaxElement);//Also sizes the sparse storage(and presence bitmap) for elements up to aMaxElement.
+		void ShrinkToFit();//Releases sparse storage that no longer holds any element.
 
 		bool IsValid(const T anElement) const;
 
@@ -27,182 +135,908 @@ namespace CommonUtility
 		void Swap(const T anElement, const T anOtherElement);
 
 		const size_t Size() const;
+		const size_t GetAllocatedBytes() const;//Heap memory owned by the dense list, the sparse storage and the presence bitmap.
+
+		void EnablePresenceBitmap(const bool anEnable);//Keeps one bit per sparse slot so Intersection can AND whole words of several sets at once. Requires SparseStorage::supportsPresenceBitmap.
+		bool HasPresenceBitmap() const;
+		bool IsSorted() const;//True while the dense list is in ascending order, e.g. after in-order Adds and only order-preserving removals.
+
+		void Sort();//Sorts the dense list in ascending order and rewrites the sparse side once. Does nothing while IsSorted().
+		template<class Compare>
+		void Sort(Compare aCompare);//Sorts the dense list with aCompare(T, T). aCompare must not query this set.
+		void Permute(const size_t* someOrder);//Dense element anIndex becomes the element at someOrder[anIndex], someOrder must be a permutation of [0, Size()).
+
+		//Dense index of the first element not less/greater than anElement, Size() if there is none. Requires IsSorted().
+		//The elements in [aFirst, aLast] are the dense range [LowerBound(aFirst), UpperBound(aLast)).
+		size_t LowerBound(const T anElement) const;
+		size_t UpperBound(const T anElement) const;
 
 		T& operator[](const size_t aDenseIndex);
 		const T& operator[](const size_t aDenseIndex) const;
 
-		void Intersection(const SparseSet<T>& anOtherSet, SparseSet<T>& anIntersectionSetOut) const;
-		void ReduceToIntersection(const SparseSet<T>& anOtherSet);
+		//Contiguous iteration over the dense elements, e.g. range-for and <algorithm>. Elements can't be modified through them since that would desync the sparse side.
+		using ConstIterator = const T*;
+		ConstIterator begin() const;
+		ConstIterator end() const;
+		const T* Data() const;
+
+		void Intersection(const SparseSet& anOtherSet, SparseSet& anIntersectionSetOut) const;
+		//Writes the elements present in all of someSets to someElementsOut, which is cleared first.
+		//The output is ascending when every set IsSorted() and the indexer is the identity, otherwise its order is unspecified.
+		static void Intersection(const SparseSet* const* someSets, const size_t aSetCount, std::vector<T>& someElementsOut);
+		//Both require IsSorted() on both sets to merge, otherwise they fall back to probing with Find. someElementsOut is cleared first.
+		void Union(const SparseSet& anOtherSet, std::vector<T>& someElementsOut) const;
+		void Difference(const SparseSet& anOtherSet, std::vector<T>& someElementsOut) const;//Elements of this set missing from anOtherSet.
+		void ReduceToIntersection(const SparseSet& anOtherSet);//Keeps only the elements also in anOtherSet, retaining their relative order. One compaction pass, no swaps.
 
 	private:
+		using BitmapWord = unsigned long long;
+		static constexpr size_t bitmapWordBits = 64;
+		static constexpr size_t bitmapWordsPerProbe = 8;//Bitmap words ANDed per set for the cost of one Find, tuned with SparseSetTests::IntersectionBenchmark.
+		static constexpr size_t gallopMinimumSize = 512 * 1024;//Smallest set size from which galloping beats hashed Finds, tuned with SparseSetTests::IntersectionBenchmark.
+
+		T& AssureSparseSlot(const T anElement);
+		T& GetSparseSlot(const T anElement);
+		const T& GetSparseSlot(const T anElement) const;
+
+		void SetPresenceBit(const T anElement);
+		void ClearPresenceBit(const T anElement);
+		void OnElementRemoved(const T anElement, const bool anOrderIsKept);
+		void RewriteSparseSlots(const size_t aFirstDenseIndex);
+		bool TestPresenceBit(const T anElement) const;
+
+		static unsigned int CountTrailingZeros(const BitmapWord aWord);
+		static void IntersectSorted(const SparseSet* const* someSortedSets, const size_t aSetCount, std::vector<T>& someElementsOut);
+		static void IntersectBitmaps(const SparseSet* const* someSortedSets, const size_t aSetCount, const size_t aWordCount, std::vector<T>& someElementsOut);
+		static void IntersectProbing(const SparseSet* const* someSortedSets, const size_t aSetCount, std::vector<T>& someElementsOut);
+
 		std::vector<T> myDenseList;
-		std::vector<T> mySparseList;
+		SparseStorage mySparseStorage;
+		std::vector<BitmapWord> myPresenceBitmap;
+		bool myHasPresenceBitmap = false;
+		bool myIsSorted = true;
 	};
 
-	template<class T>
-	inline SparseSet<T>::SparseSet()
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline SparseSet<T, SparseIndexer, SparseStorage>::SparseSet()
 	{
 	}
 
-	template<class T>
-	inline SparseSet<T>::~SparseSet()
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline SparseSet<T, SparseIndexer, SparseStorage>::SparseSet(const SparseSet& anOtherSet)
 	{
+		*this = anOtherSet;
 	}
 
-	template<class T>
-	inline void SparseSet<T>::Add(const T anElement)
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline SparseSet<T, SparseIndexer, SparseStorage>::~SparseSet()
+	{
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline SparseSet<T, SparseIndexer, SparseStorage>& SparseSet<T, SparseIndexer, SparseStorage>::operator=(const SparseSet& anOtherSet)
+	{
+		if (this == &anOtherSet)
+			return *this;
+
+		myDenseList = anOtherSet.myDenseList;
+		mySparseStorage = anOtherSet.mySparseStorage;
+		myPresenceBitmap = anOtherSet.myPresenceBitmap;
+		myHasPresenceBitmap = anOtherSet.myHasPresenceBitmap;
+		myIsSorted = anOtherSet.myIsSorted;
+
+		return *this;
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Add(const T anElement)
 	{
 		assert(!IsValid(anElement) && "Identifier has already been added to sparse set before. Duplicate elements are not allowed.");
 
-		myDenseList.push_back(anElement);
-		if (mySparseList.size() < (anElement + 1))
+		if (!myDenseList.empty() && (anElement < myDenseList.back()))
 		{
-			mySparseList.reserve(anElement + 1);
+			myIsSorted = false;
 		}
-		while (mySparseList.size() < (anElement + 1))
+
+		myDenseList.push_back(anElement);
+		AssureSparseSlot(anElement) = static_cast<T>(myDenseList.size() - 1);
+		SetPresenceBit(anElement);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::AddMany(const T * someElements, const size_t aCount)
+	{
+		if (aCount == 0)
+			return;
+
+		mySparseStorage.PrepareFor(someElements, aCount);
+		if ((myDenseList.size() + aCount) > myDenseList.capacity())
 		{
-			mySparseList.emplace_back(failureIndex);
+			myDenseList.reserve((std::max)(myDenseList.size() + aCount, myDenseList.capacity() * 2));
 		}
 
-		mySparseList[static_cast<size_t>(anElement)] = static_cast<T>(myDenseList.size() - 1);
+		for (size_t index = 0; index < aCount; ++index)
+		{
+			Add(someElements[index]);
+		}
 	}
 
-	template<class T>
-	inline void SparseSet<T>::RemoveCyclic(const T anElement)
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::RemoveCyclic(const T anElement)
 	{
 		assert(IsValid(anElement) && "Element not valid, could not RemoveCyclic element.");
 		const size_t lastDenseIndex = myDenseList.size() - 1;
+		const bool wasLast = (static_cast<size_t>(Find(anElement)) == lastDenseIndex);
 		Swap(anElement, myDenseList[lastDenseIndex]);
-		mySparseList[anElement] = failureIndex;
+		GetSparseSlot(anElement) = failureIndex;
 		myDenseList.resize(lastDenseIndex);
+		OnElementRemoved(anElement, wasLast);
 	}
 
-	template<class T>
-	inline void SparseSet<T>::Remove(const T anElement)
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Remove(const T anElement)
 	{
 		assert(IsValid(anElement) && "Element not valid, could not Remove element.");
 		const T denseIndex = Find(anElement);
 		myDenseList.erase(myDenseList.begin() + denseIndex);
+		RewriteSparseSlots(denseIndex);
 
-		for (T currentDenseIndex = denseIndex; currentDenseIndex < myDenseList.size(); ++currentDenseIndex)
+		GetSparseSlot(anElement) = failureIndex;
+		OnElementRemoved(anElement, true);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::RemoveMany(const T * someElements, const size_t aCount)
+	{
+		//Victims are marked by clearing their sparse slot, the compaction then keeps every element whose slot is still set.
+		size_t firstVictim = myDenseList.size();
+		for (size_t index = 0; index < aCount; ++index)
 		{
-			const T denseValue = myDenseList[currentDenseIndex];
-			mySparseList[denseValue] = currentDenseIndex;
+			const T denseIndex = Find(someElements[index]);
+			if (denseIndex == failureIndex)
+				continue;
+
+			firstVictim = (std::min)(firstVictim, static_cast<size_t>(denseIndex));
+			GetSparseSlot(someElements[index]) = failureIndex;
+			OnElementRemoved(someElements[index], true);
 		}
 
-		mySparseList[anElement] = failureIndex;
+		size_t writeIndex = firstVictim;
+		for (size_t readIndex = firstVictim; readIndex < myDenseList.size(); ++readIndex)
+		{
+			const T element = myDenseList[readIndex];
+			T& sparseSlot = GetSparseSlot(element);
+			if (sparseSlot != failureIndex)
+			{
+				myDenseList[writeIndex] = element;
+				sparseSlot = static_cast<T>(writeIndex);
+				++writeIndex;
+			}
+		}
+
+		myDenseList.resize(writeIndex);
 	}
 
-	template<class T>
-	inline void SparseSet<T>::Clear()
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Clear()
 	{
 		myDenseList.clear();
-		mySparseList.clear();
+		mySparseStorage.Clear();
+		std::fill(myPresenceBitmap.begin(), myPresenceBitmap.end(), 0);
+		myIsSorted = true;
 	}
 
-	template<class T>
-	inline bool SparseSet<T>::IsValid(const T anElement) const
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Reserve(const size_t aCapacity)
+	{
+		myDenseList.reserve(aCapacity);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Reserve(const size_t aCapacity, const T aMaxElement)
+	{
+		Reserve(aCapacity);
+		mySparseStorage.Reserve(aCapacity, aMaxElement);
+
+		if (myHasPresenceBitmap)
+		{
+			const size_t wordCount = static_cast<size_t>(SparseIndexer::ToSparse(aMaxElement)) / bitmapWordBits + 1;
+			if (wordCount > myPresenceBitmap.size())
+			{
+				myPresenceBitmap.resize(wordCount, 0);
+			}
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::ShrinkToFit()
 	{
-		if (mySparseList.size() < (anElement + 1))
-			return false;
-		if (mySparseList[anElement] == failureIndex)
-			return false;
+		mySparseStorage.ShrinkToFit(myDenseList);
+		myDenseList.shrink_to_fit();
+	}
 
-		return true;
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline bool SparseSet<T, SparseIndexer, SparseStorage>::IsValid(const T anElement) const
+	{
+		return Find(anElement) != failureIndex;
 	}
 
-	template<class T>
-	inline T SparseSet<T>::Find(const T anElement) const
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline T SparseSet<T, SparseIndexer, SparseStorage>::Find(const T anElement) const
 	{
-		if (!IsValid(anElement))
+		const T* slot = mySparseStorage.FindSlot(anElement);
+		if (slot == nullptr)
 			return failureIndex;
 
-		return mySparseList[anElement];
+		const T denseIndex = *slot;
+		if constexpr (!SparseIndexer::isIdentity)
+		{
+			if ((denseIndex != failureIndex) && (myDenseList[denseIndex] != anElement))
+				return failureIndex;
+		}
+
+		return denseIndex;
 	}
 
 
-	template<class T>
-	inline void SparseSet<T>::Swap(const T anElement, const T anOtherElement)
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Swap(const T anElement, const T anOtherElement)
 	{
 		assert(IsValid(anElement) && "could not find first element for swap in sparse set!");
 		assert(IsValid(anOtherElement) && "could not find second element for swap in sparse set!");
 
-		const T sparseValue = mySparseList[anElement];
-		const T otherSparseValue = mySparseList[anOtherElement];
+		T& sparseValue = GetSparseSlot(anElement);
+		T& otherSparseValue = GetSparseSlot(anOtherElement);
+		if (sparseValue != otherSparseValue)
+		{
+			myIsSorted = false;
+		}
 		std::swap(myDenseList[sparseValue], myDenseList[otherSparseValue]);
-		std::swap(mySparseList[anElement], mySparseList[anOtherElement]);
+		std::swap(sparseValue, otherSparseValue);
 	}
 
-	template<class T>
-	inline const size_t SparseSet<T>::Size() const
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline const size_t SparseSet<T, SparseIndexer, SparseStorage>::Size() const
 	{
 		return myDenseList.size();
 	}
 
-	template<class T>
-	inline T & SparseSet<T>::operator[](const size_t aDenseIndex)
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline const size_t SparseSet<T, SparseIndexer, SparseStorage>::GetAllocatedBytes() const
+	{
+		return (myDenseList.capacity() * sizeof(T))
+			+ mySparseStorage.GetAllocatedBytes()
+			+ (myPresenceBitmap.capacity() * sizeof(BitmapWord));
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::EnablePresenceBitmap(const bool anEnable)
+	{
+		assert((!anEnable || SparseStorage::supportsPresenceBitmap) && "The sparse storage of this set can't keep a presence bitmap.");
+		myHasPresenceBitmap = anEnable;
+		myPresenceBitmap.clear();
+		if (anEnable)
+		{
+			for (const T element : myDenseList)
+			{
+				SetPresenceBit(element);
+			}
+		}
+		else
+		{
+			myPresenceBitmap.shrink_to_fit();
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline bool SparseSet<T, SparseIndexer, SparseStorage>::HasPresenceBitmap() const
+	{
+		return myHasPresenceBitmap;
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline bool SparseSet<T, SparseIndexer, SparseStorage>::IsSorted() const
+	{
+		return myIsSorted;
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Sort()
+	{
+		if (myIsSorted)
+			return;
+
+		std::sort(myDenseList.begin(), myDenseList.end());
+		RewriteSparseSlots(0);
+		myIsSorted = true;
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	template<class Compare>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Sort(Compare aCompare)
+	{
+		std::sort(myDenseList.begin(), myDenseList.end(), aCompare);
+		RewriteSparseSlots(0);
+		myIsSorted = std::is_sorted(myDenseList.begin(), myDenseList.end());
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Permute(const size_t * someOrder)
+	{
+		std::vector<T> permutedList(myDenseList.size());
+		for (size_t index = 0; index < permutedList.size(); ++index)
+		{
+			assert(someOrder[index] < myDenseList.size() && "Permute order is out of range.");
+			permutedList[index] = myDenseList[someOrder[index]];
+		}
+
+		myDenseList.swap(permutedList);
+		RewriteSparseSlots(0);
+		myIsSorted = std::is_sorted(myDenseList.begin(), myDenseList.end());
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline size_t SparseSet<T, SparseIndexer, SparseStorage>::LowerBound(const T anElement) const
+	{
+		assert(myIsSorted && "LowerBound requires a sorted SparseSet.");
+		return std::lower_bound(myDenseList.begin(), myDenseList.end(), anElement) - myDenseList.begin();
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline size_t SparseSet<T, SparseIndexer, SparseStorage>::UpperBound(const T anElement) const
+	{
+		assert(myIsSorted && "UpperBound requires a sorted SparseSet.");
+		return std::upper_bound(myDenseList.begin(), myDenseList.end(), anElement) - myDenseList.begin();
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline T & SparseSet<T, SparseIndexer, SparseStorage>::operator[](const size_t aDenseIndex)
 	{
 		return myDenseList[aDenseIndex];
 	}
 
-	template<class T>
-	inline const T & SparseSet<T>::operator[](const size_t aDenseIndex) const
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline const T & SparseSet<T, SparseIndexer, SparseStorage>::operator[](const size_t aDenseIndex) const
 	{
 		return myDenseList[aDenseIndex];
 	}
 
-	template<class T>
-	inline void SparseSet<T>::Intersection(const SparseSet<T>& anOtherSet, SparseSet<T>& anIntersectionSetOut) const
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline typename SparseSet<T, SparseIndexer, SparseStorage>::ConstIterator SparseSet<T, SparseIndexer, SparseStorage>::begin() const
 	{
-		const SparseSet<T>& smallerSet = (Size() < anOtherSet.Size()) ? *this : anOtherSet;
-		const SparseSet<T>& otherSet = ((&smallerSet) == (this)) ? anOtherSet : *this;
+		return myDenseList.data();
+	}
 
-		for (size_t index = 0; index < smallerSet.Size(); ++index)
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline typename SparseSet<T, SparseIndexer, SparseStorage>::ConstIterator SparseSet<T, SparseIndexer, SparseStorage>::end() const
+	{
+		return myDenseList.data() + myDenseList.size();
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline const T * SparseSet<T, SparseIndexer, SparseStorage>::Data() const
+	{
+		return myDenseList.data();
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Intersection(const SparseSet& anOtherSet, SparseSet& anIntersectionSetOut) const
+	{
+		const SparseSet* sets[] = { this, &anOtherSet };
+		std::vector<T> intersection;
+		Intersection(sets, 2, intersection);
+		anIntersectionSetOut.AddMany(intersection.data(), intersection.size());
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Intersection(const SparseSet* const* someSets, const size_t aSetCount, std::vector<T>& someElementsOut)
+	{
+		someElementsOut.clear();
+		if (aSetCount == 0)
+			return;
+
+		//Smallest first, it bounds the output and drives the probing and merging.
+		std::vector<const SparseSet*> sortedSets(someSets, someSets + aSetCount);
+		std::sort(sortedSets.begin(), sortedSets.end(), [](const SparseSet* aLHS, const SparseSet* aRHS) { return aLHS->Size() < aRHS->Size(); });
+
+		const SparseSet& smallestSet = *sortedSets[0];
+		if (smallestSet.Size() == 0)
+			return;
+
+		if (aSetCount == 1)
 		{
-			if (otherSet.Find(smallerSet[index]) != failureIndex)
+			someElementsOut = smallestSet.myDenseList;
+			return;
+		}
+
+		bool allSorted = true;
+		bool allBitmaps = true;
+		size_t wordCount = std::numeric_limits<size_t>::max();
+		for (const SparseSet* set : sortedSets)
+		{
+			allSorted = allSorted && set->myIsSorted;
+			allBitmaps = allBitmaps && set->myHasPresenceBitmap;
+			wordCount = (std::min)(wordCount, set->myPresenceBitmap.size());
+		}
+
+		if constexpr (SparseStorage::supportsPresenceBitmap)
+		{
+			if (allBitmaps && (wordCount <= smallestSet.Size() * bitmapWordsPerProbe))
 			{
-				anIntersectionSetOut.Add(smallerSet[index]);
+				IntersectBitmaps(sortedSets.data(), aSetCount, wordCount, someElementsOut);
+				return;
 			}
 		}
+
+		if (!SparseStorage::hasDirectLookup && allSorted && (smallestSet.Size() >= gallopMinimumSize))
+		{
+			IntersectSorted(sortedSets.data(), aSetCount, someElementsOut);
+		}
+		else
+		{
+			IntersectProbing(sortedSets.data(), aSetCount, someElementsOut);
+		}
 	}
 
-	template<class T>
-	inline void SparseSet<T>::ReduceToIntersection(const SparseSet<T>& anOtherSet)
-	{
-		//SparseSet<T>& smallerSet = (Size() < anOtherSet.Size()) ? *this : const_cast<SparseSet<T>&>(anOtherSet);
-		//SparseSet<T>& otherSet = ((&smallerSet) == (this)) ? const_cast<SparseSet<T>&>(anOtherSet) : *this;
-		//
-		//const bool thisIsSmaller = (Size() < anOtherSet.Size());
-		//
-		//for (size_t index = 0; index < smallerSet.Size(); ++index)
-		//{
-		//	T throwAway;
-		//	if (!otherSet.Find(smallerSet[index], throwAway))
-		//	{
-		//		if (thisIsSmaller)
-		//		{
-		//			smallerSet.Remove(smallerSet[index]);
-		//			--index;
-		//		}
-		//		else
-		//		{
-		//			otherSet.Remove(smallerSet[index]);
-		//		}
-		//	}
-		//}
-
-		const bool thisIsSmaller = (Size() < anOtherSet.Size());
-		const SparseSet<T>& smallerSet = thisIsSmaller ? *this : anOtherSet;
-		const SparseSet<T>& otherSet = thisIsSmaller ? anOtherSet : *this;
-
-		for (size_t index = smallerSet.Size() - 1; (index > 0) && (index != failureIndex); --index)
-		{
-			if (otherSet.Find(smallerSet[index]) == failureIndex)
-			{
-				RemoveCyclic(smallerSet[index]);
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Union(const SparseSet& anOtherSet, std::vector<T>& someElementsOut) const
+	{
+		someElementsOut.clear();
+		someElementsOut.reserve(Size() + anOtherSet.Size());
+		if (myIsSorted && anOtherSet.myIsSorted)
+		{
+			std::set_union(myDenseList.begin(), myDenseList.end(), anOtherSet.myDenseList.begin(), anOtherSet.myDenseList.end(), std::back_inserter(someElementsOut));
+			return;
+		}
+
+		someElementsOut = myDenseList;
+		for (const T element : anOtherSet.myDenseList)
+		{
+			if (Find(element) == failureIndex)
+			{
+				someElementsOut.push_back(element);
+			}
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::Difference(const SparseSet& anOtherSet, std::vector<T>& someElementsOut) const
+	{
+		someElementsOut.clear();
+		if (myIsSorted && anOtherSet.myIsSorted)
+		{
+			std::set_difference(myDenseList.begin(), myDenseList.end(), anOtherSet.myDenseList.begin(), anOtherSet.myDenseList.end(), std::back_inserter(someElementsOut));
+			return;
+		}
+
+		for (const T element : myDenseList)
+		{
+			if (anOtherSet.Find(element) == failureIndex)
+			{
+				someElementsOut.push_back(element);
 			}
 		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::ReduceToIntersection(const SparseSet& anOtherSet)
+	{
+		//Kept elements are compacted to the front in their current order. The write index only advances on a kept element
+		//and the sparse slot is rewritten with a select, so the loop has no data-dependent branch and no swaps.
+		constexpr size_t prefetchDistance = 16;
+		const bool useOtherBitmap = SparseIndexer::isIdentity && anOtherSet.myHasPresenceBitmap;
+		const size_t elementCount = myDenseList.size();
+
+		size_t writeIndex = 0;
+		for (size_t readIndex = 0; readIndex < elementCount; ++readIndex)
+		{
+			if (!useOtherBitmap && ((readIndex + prefetchDistance) < elementCount))
+			{
+				anOtherSet.mySparseStorage.Prefetch(myDenseList[readIndex + prefetchDistance]);
+			}
+
+			const T element = myDenseList[readIndex];
+			const bool isKept = useOtherBitmap ? anOtherSet.TestPresenceBit(element) : (anOtherSet.Find(element) != failureIndex);
+
+			myDenseList[writeIndex] = element;
+			GetSparseSlot(element) = isKept ? static_cast<T>(writeIndex) : failureIndex;
+			if (myHasPresenceBitmap)
+			{
+				const size_t sparseIndex = static_cast<size_t>(SparseIndexer::ToSparse(element));
+				myPresenceBitmap[sparseIndex / bitmapWordBits] &= ~(static_cast<BitmapWord>(!isKept) << (sparseIndex % bitmapWordBits));
+			}
+			writeIndex += isKept;
+		}
+
+		myDenseList.resize(writeIndex);
+		myIsSorted = myIsSorted || (writeIndex <= 1);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline bool SparseSet<T, SparseIndexer, SparseStorage>::TestPresenceBit(const T anElement) const
+	{
+		const size_t sparseIndex = static_cast<size_t>(SparseIndexer::ToSparse(anElement));
+		const size_t wordIndex = sparseIndex / bitmapWordBits;
+		return (wordIndex < myPresenceBitmap.size()) && (((myPresenceBitmap[wordIndex] >> (sparseIndex % bitmapWordBits)) & 1) != 0);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::SetPresenceBit(const T anElement)
+	{
+		if (!myHasPresenceBitmap)
+			return;
+
+		const size_t sparseIndex = static_cast<size_t>(SparseIndexer::ToSparse(anElement));
+		const size_t wordIndex = sparseIndex / bitmapWordBits;
+		if (wordIndex >= myPresenceBitmap.size())
+		{
+			myPresenceBitmap.resize(wordIndex + 1, 0);
+		}
+		myPresenceBitmap[wordIndex] |= (static_cast<BitmapWord>(1) << (sparseIndex % bitmapWordBits));
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::ClearPresenceBit(const T anElement)
+	{
+		if (!myHasPresenceBitmap)
+			return;
+
+		const size_t sparseIndex = static_cast<size_t>(SparseIndexer::ToSparse(anElement));
+		myPresenceBitmap[sparseIndex / bitmapWordBits] &= ~(static_cast<BitmapWord>(1) << (sparseIndex % bitmapWordBits));
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::OnElementRemoved(const T anElement, const bool anOrderIsKept)
+	{
+		ClearPresenceBit(anElement);
+		myIsSorted = (anOrderIsKept && myIsSorted) || (myDenseList.size() <= 1);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::RewriteSparseSlots(const size_t aFirstDenseIndex)
+	{
+		for (size_t denseIndex = aFirstDenseIndex; denseIndex < myDenseList.size(); ++denseIndex)
+		{
+			GetSparseSlot(myDenseList[denseIndex]) = static_cast<T>(denseIndex);
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline unsigned int SparseSet<T, SparseIndexer, SparseStorage>::CountTrailingZeros(const BitmapWord aWord)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, aWord);
+		return static_cast<unsigned int>(index);
+#else
+		return static_cast<unsigned int>(__builtin_ctzll(aWord));
+#endif
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::IntersectSorted(const SparseSet* const* someSortedSets, const size_t aSetCount, std::vector<T>& someElementsOut)
+	{
+		//Every other set keeps a cursor that only moves forward. Short gaps are stepped over linearly,
+		//longer ones are galloped over(doubling steps, then a binary search).
+		constexpr size_t linearSteps = 8;
+		std::vector<size_t> cursors(aSetCount, 0);
+		const std::vector<T>& drivingList = someSortedSets[0]->myDenseList;
+
+		for (const T candidate : drivingList)
+		{
+			bool isInAll = true;
+			for (size_t setIndex = 1; setIndex < aSetCount; ++setIndex)
+			{
+				const std::vector<T>& otherList = someSortedSets[setIndex]->myDenseList;
+				size_t& cursor = cursors[setIndex];
+
+				const size_t linearEnd = (std::min)(cursor + linearSteps, otherList.size());
+				while ((cursor < linearEnd) && (otherList[cursor] < candidate))
+				{
+					++cursor;
+				}
+
+				if ((cursor == linearEnd) && (cursor < otherList.size()) && (otherList[cursor] < candidate))
+				{
+					size_t low = cursor;
+					size_t high = cursor;
+					for (size_t step = 1; (high < otherList.size()) && (otherList[high] < candidate); step *= 2)
+					{
+						low = high + 1;
+						high += step;
+					}
+					high = (std::min)(high, otherList.size());
+					cursor = std::lower_bound(otherList.begin() + low, otherList.begin() + high, candidate) - otherList.begin();
+				}
+
+				if (cursor == otherList.size())
+					return;
+
+				if (otherList[cursor] != candidate)
+				{
+					isInAll = false;
+					break;
+				}
+			}
+
+			if (isInAll)
+			{
+				someElementsOut.push_back(candidate);
+			}
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::IntersectBitmaps(const SparseSet* const* someSortedSets, const size_t aSetCount, const size_t aWordCount, std::vector<T>& someElementsOut)
+	{
+		constexpr size_t wordsPerBlock = 4;
+		BitmapWord block[wordsPerBlock];
+		const SparseSet& drivingSet = *someSortedSets[0];
+
+		for (size_t firstWord = 0; firstWord < aWordCount; firstWord += wordsPerBlock)
+		{
+			const size_t blockWords = (std::min)(wordsPerBlock, aWordCount - firstWord);
+			bool isEmpty = true;
+
+#if defined(SPARSESET_AVX2)
+			if (blockWords == wordsPerBlock)
+			{
+				__m256i accumulator = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(someSortedSets[0]->myPresenceBitmap.data() + firstWord));
+				for (size_t setIndex = 1; setIndex < aSetCount; ++setIndex)
+				{
+					accumulator = _mm256_and_si256(accumulator, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(someSortedSets[setIndex]->myPresenceBitmap.data() + firstWord)));
+				}
+				isEmpty = (_mm256_testz_si256(accumulator, accumulator) != 0);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(block), accumulator);
+			}
+			else
+#elif defined(SPARSESET_SSE2)
+			if (blockWords == wordsPerBlock)
+			{
+				const BitmapWord* firstBitmap = someSortedSets[0]->myPresenceBitmap.data() + firstWord;
+				__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(firstBitmap));
+				__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(firstBitmap + 2));
+				for (size_t setIndex = 1; setIndex < aSetCount; ++setIndex)
+				{
+					const BitmapWord* bitmap = someSortedSets[setIndex]->myPresenceBitmap.data() + firstWord;
+					low = _mm_and_si128(low, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bitmap)));
+					high = _mm_and_si128(high, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bitmap + 2)));
+				}
+				isEmpty = (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(low, high), _mm_setzero_si128())) == 0xFFFF);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(block), low);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(block + 2), high);
+			}
+			else
+#endif
+			{
+				for (size_t word = 0; word < blockWords; ++word)
+				{
+					block[word] = someSortedSets[0]->myPresenceBitmap[firstWord + word];
+					for (size_t setIndex = 1; setIndex < aSetCount; ++setIndex)
+					{
+						block[word] &= someSortedSets[setIndex]->myPresenceBitmap[firstWord + word];
+					}
+					isEmpty = isEmpty && (block[word] == 0);
+				}
+			}
+
+			if (isEmpty)
+				continue;
+
+			for (size_t word = 0; word < blockWords; ++word)
+			{
+				for (BitmapWord bits = block[word]; bits != 0; bits &= (bits - 1))
+				{
+					const size_t sparseIndex = (firstWord + word) * bitmapWordBits + CountTrailingZeros(bits);
+					const T denseIndex = drivingSet.mySparseStorage.GetSlotBySparseIndex(sparseIndex);
+					const T element = drivingSet.myDenseList[denseIndex];
+
+					//Sets can hold different elements on the same sparse slot unless the indexer is the identity.
+					bool isInAll = true;
+					if constexpr (!SparseIndexer::isIdentity)
+					{
+						for (size_t setIndex = 1; (setIndex < aSetCount) && isInAll; ++setIndex)
+						{
+							isInAll = (someSortedSets[setIndex]->Find(element) != failureIndex);
+						}
+					}
+
+					if (isInAll)
+					{
+						someElementsOut.push_back(element);
+					}
+				}
+			}
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline void SparseSet<T, SparseIndexer, SparseStorage>::IntersectProbing(const SparseSet* const* someSortedSets, const size_t aSetCount, std::vector<T>& someElementsOut)
+	{
+		for (const T element : someSortedSets[0]->myDenseList)
+		{
+			bool isInAll = true;
+			for (size_t setIndex = 1; (setIndex < aSetCount) && isInAll; ++setIndex)
+			{
+				isInAll = (someSortedSets[setIndex]->Find(element) != failureIndex);
+			}
+
+			if (isInAll)
+			{
+				someElementsOut.push_back(element);
+			}
+		}
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline T& SparseSet<T, SparseIndexer, SparseStorage>::AssureSparseSlot(const T anElement)
+	{
+		return mySparseStorage.AssureSlot(anElement);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline T& SparseSet<T, SparseIndexer, SparseStorage>::GetSparseSlot(const T anElement)
+	{
+		return *mySparseStorage.FindSlot(anElement);
+	}
+
+	template<class T, class SparseIndexer, class SparseStorage>
+	inline const T& SparseSet<T, SparseIndexer, SparseStorage>::GetSparseSlot(const T anElement) const
+	{
+		return *mySparseStorage.FindSlot(anElement);
+	}
+
+	template<class T, class SparseIndexer>
+	inline PagedSparseStorage<T, SparseIndexer>::PagedSparseStorage(const PagedSparseStorage& anOtherStorage)
+	{
+		*this = anOtherStorage;
+	}
+
+	template<class T, class SparseIndexer>
+	inline PagedSparseStorage<T, SparseIndexer>& PagedSparseStorage<T, SparseIndexer>::operator=(const PagedSparseStorage& anOtherStorage)
+	{
+		if (this == &anOtherStorage)
+			return *this;
+
+		mySparsePages.clear();
+		mySparsePages.resize(anOtherStorage.mySparsePages.size());
+		for (size_t pageIndex = 0; pageIndex < mySparsePages.size(); ++pageIndex)
+		{
+			const T* otherPage = anOtherStorage.mySparsePages[pageIndex].get();
+			if (otherPage != nullptr)
+			{
+				mySparsePages[pageIndex] = std::make_unique<T[]>(pageSize);
+				std::copy(otherPage, otherPage + pageSize, mySparsePages[pageIndex].get());
+			}
+		}
+		myAllocatedPageCount = anOtherStorage.myAllocatedPageCount;
+
+		return *this;
+	}
+
+	template<class T, class SparseIndexer>
+	inline T * PagedSparseStorage<T, SparseIndexer>::FindSlot(const T anElement)
+	{
+		return const_cast<T*>(static_cast<const PagedSparseStorage*>(this)->FindSlot(anElement));
+	}
+
+	template<class T, class SparseIndexer>
+	inline const T * PagedSparseStorage<T, SparseIndexer>::FindSlot(const T anElement) const
+	{
+		const size_t pageIndex = GetPageIndex(anElement);
+		if (pageIndex >= mySparsePages.size())
+			return nullptr;
+
+		const T* page = mySparsePages[pageIndex].get();
+		if (page == nullptr)
+			return nullptr;
+
+		return page + GetPageOffset(anElement);
+	}
+
+	template<class T, class SparseIndexer>
+	inline T & PagedSparseStorage<T, SparseIndexer>::AssureSlot(const T anElement)
+	{
+		const size_t pageIndex = GetPageIndex(anElement);
+		if (pageIndex >= mySparsePages.size())
+		{
+			mySparsePages.resize(pageIndex + 1);
+		}
+
+		SparsePage& page = mySparsePages[pageIndex];
+		if (!page)
+		{
+			page = std::make_unique<T[]>(pageSize);
+			std::fill(page.get(), page.get() + pageSize, failureIndex);
+			++myAllocatedPageCount;
+		}
+
+		return page[GetPageOffset(anElement)];
+	}
+
+	template<class T, class SparseIndexer>
+	inline const T & PagedSparseStorage<T, SparseIndexer>::GetSlotBySparseIndex(const size_t aSparseIndex) const
+	{
+		return mySparsePages[aSparseIndex / pageSize][aSparseIndex & (pageSize - 1)];
+	}
+
+	template<class T, class SparseIndexer>
+	inline void PagedSparseStorage<T, SparseIndexer>::PrepareFor(const T * someElements, const size_t aCount)
+	{
+		size_t lastPageIndex = 0;
+		for (size_t index = 0; index < aCount; ++index)
+		{
+			lastPageIndex = (std::max)(lastPageIndex, GetPageIndex(someElements[index]));
+		}
+
+		if (lastPageIndex >= mySparsePages.size())
+		{
+			mySparsePages.resize(lastPageIndex + 1);
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline void PagedSparseStorage<T, SparseIndexer>::Reserve(const size_t aCount, const T aMaxElement)
+	{
+		aCount;
+		const size_t pageCount = GetPageIndex(aMaxElement) + 1;
+		if (pageCount > mySparsePages.size())
+		{
+			mySparsePages.resize(pageCount);
+		}
+	}
+
+	template<class T, class SparseIndexer>
+	inline void PagedSparseStorage<T, SparseIndexer>::ShrinkToFit(const std::vector<T>& someLiveElements)
+	{
+		std::vector<bool> occupiedPages(mySparsePages.size(), false);
+		for (const T element : someLiveElements)
+		{
+			occupiedPages[GetPageIndex(element)] = true;
+		}
+
+		for (size_t pageIndex = 0; pageIndex < mySparsePages.size(); ++pageIndex)
+		{
+			if (mySparsePages[pageIndex] && !occupiedPages[pageIndex])
+			{
+				mySparsePages[pageIndex].reset();
+				--myAllocatedPageCount;
+			}
+		}
+
+		while (!mySparsePages.empty() && !mySparsePages.back())
+		{
+			mySparsePages.pop_back();
+		}
+
+		mySparsePages.shrink_to_fit();
+	}
+
+	template<class T, class SparseIndexer>
+	inline void PagedSparseStorage<T, SparseIndexer>::Clear()
+	{
+		mySparsePages.clear();
+		myAllocatedPageCount = 0;
+	}
+
+	template<class T, class SparseIndexer>
+	inline size_t PagedSparseStorage<T, SparseIndexer>::GetAllocatedBytes() const
+	{
+		return (mySparsePages.capacity() * sizeof(SparsePage)) + (myAllocatedPageCount * pageSize * sizeof(T));
+	}
+
+	template<class T, class SparseIndexer>
+	inline void PagedSparseStorage<T, SparseIndexer>::Prefetch(const T anElement) const
+	{
+		const T* slot = FindSlot(anElement);
+		if (slot == nullptr)
+			return;
 
+#if defined(SPARSESET_AVX2) || defined(SPARSESET_SSE2)
+		_mm_prefetch(reinterpret_cast<const char*>(slot), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(slot);
+#endif
 	}
 }
 
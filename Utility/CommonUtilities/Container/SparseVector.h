@@ -1,6 +1,8 @@
 #pragma once
 #include "SparseSet.h"
 #include <vector>
+#include <algorithm>
+#include <utility>
 
 /*
 	Vector based on indirect access through identifiers(unsigned integer types).
@@ -9,11 +11,12 @@
 	The use of sparse set allow (O)1 Add, Remove, Find, and Get.
 	Note that while random access utilises the identifier; iteration over [] operators use raw indicies
 	[0, Size()).
+	SparseStorage is the sparse side of the identifier set, see SparseSet.h. Use HashedSparseStorage for 64-bit or hashed identifiers.
 */
 
 namespace CommonUtility
 {
-	template<class ElementType, class SizeType = unsigned int>
+	template<class ElementType, class SizeType = unsigned int, class SparseStorage = PagedSparseStorage<SizeType, SparseIdentity<SizeType>>>
 	class SparseVector
 	{
 	public:
@@ -22,9 +25,16 @@ namespace CommonUtility
 		SparseVector() {}
 		~SparseVector() {}
 
-		ElementType& Add(const SizeType anIdentifier);
-		void RemoveCyclic(const SizeType anIdentifier);//Removes the element by swapping places with the last element and clipping the array tail. Identifiers remain intact but internal order of elements can change.
+		ElementType& Add(const SizeType anIdentifier);//Value-initialises the element.
+		ElementType& Add(const SizeType anIdentifier, const ElementType& anElement);
+		ElementType& Add(const SizeType anIdentifier, ElementType&& anElement);
+		//Constructs the element in place from someArguments, works for types that are not default constructible.
+		template<class ... Arguments>
+		ElementType& Emplace(const SizeType anIdentifier, Arguments&& ... someArguments);
+		void Reserve(const SizeType aDenseCount, const SizeType aMaxIdentifier);//Reserves aDenseCount elements and sizes the indexer's page table for identifiers up to aMaxIdentifier.
+		void RemoveCyclic(const SizeType anIdentifier);//Removes the element by moving the last element into its place and clipping the array tail. Identifiers remain intact but internal order of elements can change.
 		void Remove(const SizeType anIsdentifier);//Slower than RemoveCyclic but retains internal order of elements in the sparse vector. Identifiers remain intact.
+		void RemoveMany(const SizeType* someIdentifiers, const SizeType aCount);//Order-preserving removal of a batch, one compaction pass over the elements and the identifiers. Unknown identifiers are ignored.
 		//Returns the dense index of the object associated with the identifier.
 		SizeType Find(const SizeType anIdentifier) const;
 
@@ -33,39 +43,91 @@ namespace CommonUtility
 
 		ElementType& Get(const SizeType anIdentifier);
 		const ElementType& Get(const SizeType anIdentifier) const;
+		SizeType GetIdentifier(const SizeType aDenseIndex) const;
 
 		SizeType Size() const { return static_cast<SizeType>(myElements.size()); }
 
+		//Contiguous iteration over the elements in dense order, GetIdentifiers() iterates the matching identifiers in the same order.
+		using Iterator = ElementType*;
+		using ConstIterator = const ElementType*;
+		Iterator begin() { return myElements.data(); }
+		Iterator end() { return myElements.data() + myElements.size(); }
+		ConstIterator begin() const { return myElements.data(); }
+		ConstIterator end() const { return myElements.data() + myElements.size(); }
+		const SparseSet<SizeType, SparseIdentity<SizeType>, SparseStorage>& GetIdentifiers() const { return mySparseIndexer; }
+
+		//Orders the elements by identifier, identifiers stay associated with their elements. Does nothing while IsSorted().
+		void Sort();
+		//Orders the elements with aCompare(const ElementType&, const ElementType&), each element is moved once.
+		template<class Compare>
+		void Sort(Compare aCompare);
+		bool IsSorted() const;//True while the elements are in ascending identifier order.
+
+		//Dense index of the first element whose identifier is not less/greater than anIdentifier. Requires IsSorted().
+		SizeType LowerBound(const SizeType anIdentifier) const;
+		SizeType UpperBound(const SizeType anIdentifier) const;
+
 	private:
-		SparseSet<SizeType> mySparseIndexer;
+		void ApplyOrder(const std::vector<size_t>& someOrder);
+
+		SparseSet<SizeType, SparseIdentity<SizeType>, SparseStorage> mySparseIndexer;
 		std::vector<ElementType> myElements;
 	};
 
-	template<class ElementType, class SizeType>
-	inline ElementType& SparseVector<ElementType, SizeType>::Add(const SizeType anIdentifier)
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline ElementType& SparseVector<ElementType, SizeType, SparseStorage>::Add(const SizeType anIdentifier)
+	{
+		return Emplace(anIdentifier);
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline ElementType & SparseVector<ElementType, SizeType, SparseStorage>::Add(const SizeType anIdentifier, const ElementType & anElement)
+	{
+		return Emplace(anIdentifier, anElement);
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline ElementType & SparseVector<ElementType, SizeType, SparseStorage>::Add(const SizeType anIdentifier, ElementType && anElement)
+	{
+		return Emplace(anIdentifier, std::move(anElement));
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	template<class ...Arguments>
+	inline ElementType & SparseVector<ElementType, SizeType, SparseStorage>::Emplace(const SizeType anIdentifier, Arguments && ...someArguments)
 	{
 		assert(!mySparseIndexer.IsValid(anIdentifier) && "failed to add object to SparseVector(), identifier is already registered.");
+		myElements.emplace_back(std::forward<Arguments>(someArguments)...);
 		mySparseIndexer.Add(anIdentifier);
-		myElements.emplace_back(ElementType());
 
-		return myElements[myElements.size() - 1];
+		return myElements.back();
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::Reserve(const SizeType aDenseCount, const SizeType aMaxIdentifier)
+	{
+		myElements.reserve(aDenseCount);
+		mySparseIndexer.Reserve(aDenseCount, aMaxIdentifier);
 	}
 
-	template<class ElementType, class SizeType>
-	inline void SparseVector<ElementType, SizeType>::RemoveCyclic(const SizeType anIdentifier)
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::RemoveCyclic(const SizeType anIdentifier)
 	{
 		SizeType objectIndex = mySparseIndexer.Find(anIdentifier);
 		assert(objectIndex != mySparseIndexer.failureIndex && "Could not RemoveCyclic on object from SparseVector, invalid identifier.");
 
 		const SizeType lastIndex = static_cast<SizeType>(myElements.size() - 1);
-		std::swap(myElements[objectIndex], myElements[lastIndex]);
+		if (objectIndex != lastIndex)
+		{
+			myElements[objectIndex] = std::move(myElements[lastIndex]);
+		}
 
 		myElements.pop_back();
 		mySparseIndexer.RemoveCyclic(anIdentifier);
 	}
 
-	template<class ElementType, class SizeType>
-	inline void SparseVector<ElementType, SizeType>::Remove(const SizeType anIdentifier)
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::Remove(const SizeType anIdentifier)
 	{
 		SizeType objectIndex = mySparseIndexer.Find(anIdentifier);
 		assert(objectIndex != mySparseIndexer.failureIndex && "Could not Remove on object from SparseVector, invalid identifier.");
@@ -74,39 +136,134 @@ namespace CommonUtility
 		mySparseIndexer.Remove(anIdentifier);
 	}
 
-	template<class ElementType, class SizeType>
-	inline SizeType SparseVector<ElementType, SizeType>::Find(const SizeType anIdentifier) const
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::RemoveMany(const SizeType * someIdentifiers, const SizeType aCount)
+	{
+		std::vector<unsigned char> isVictim(myElements.size(), 0);
+		size_t firstVictim = myElements.size();
+		for (SizeType index = 0; index < aCount; ++index)
+		{
+			const SizeType objectIndex = mySparseIndexer.Find(someIdentifiers[index]);
+			if (objectIndex == failureIndex)
+				continue;
+
+			isVictim[objectIndex] = 1;
+			firstVictim = (std::min)(firstVictim, static_cast<size_t>(objectIndex));
+		}
+
+		size_t writeIndex = firstVictim;
+		for (size_t readIndex = firstVictim; readIndex < myElements.size(); ++readIndex)
+		{
+			if (!isVictim[readIndex])
+			{
+				myElements[writeIndex] = std::move(myElements[readIndex]);
+				++writeIndex;
+			}
+		}
+
+		myElements.erase(myElements.begin() + writeIndex, myElements.end());
+		mySparseIndexer.RemoveMany(someIdentifiers, aCount);
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline SizeType SparseVector<ElementType, SizeType, SparseStorage>::Find(const SizeType anIdentifier) const
 	{
 		return mySparseIndexer.Find(anIdentifier);
 	}
 
-	template<class ElementType, class SizeType>
-	inline ElementType& SparseVector<ElementType, SizeType>::operator[](const SizeType aDenseIndex)
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline ElementType& SparseVector<ElementType, SizeType, SparseStorage>::operator[](const SizeType aDenseIndex)
 	{
 		return myElements[aDenseIndex];
 	}
 
-	template<class ElementType, class SizeType>
-	inline const ElementType& SparseVector<ElementType, SizeType>::operator[](const SizeType aDenseIndex) const
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline const ElementType& SparseVector<ElementType, SizeType, SparseStorage>::operator[](const SizeType aDenseIndex) const
 	{
 		return myElements[aDenseIndex];
 	}
 
-	template<class ElementType, class SizeType>
-	inline ElementType & SparseVector<ElementType, SizeType>::Get(const SizeType anIdentifier)
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline ElementType & SparseVector<ElementType, SizeType, SparseStorage>::Get(const SizeType anIdentifier)
 	{
 		SizeType objectIndex = Find(anIdentifier);
 		assert(objectIndex != failureIndex && "Could not Get element, identifier is invalid.");
 		return myElements[objectIndex];
 	}
 
-	template<class ElementType, class SizeType>
-	inline const ElementType & SparseVector<ElementType, SizeType>::Get(const SizeType anIdentifier) const
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline const ElementType & SparseVector<ElementType, SizeType, SparseStorage>::Get(const SizeType anIdentifier) const
 	{
 		SizeType objectIndex = Find(anIdentifier);
 		assert(objectIndex != failureIndex && "Could not Get element, identifier is invalid.");
 		return myElements[objectIndex];
 	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline SizeType SparseVector<ElementType, SizeType, SparseStorage>::GetIdentifier(const SizeType aDenseIndex) const
+	{
+		return mySparseIndexer[aDenseIndex];
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::Sort()
+	{
+		if (mySparseIndexer.IsSorted())
+			return;
+
+		std::vector<size_t> order(myElements.size());
+		for (size_t index = 0; index < order.size(); ++index)
+		{
+			order[index] = index;
+		}
+		std::sort(order.begin(), order.end(), [this](const size_t aLHS, const size_t aRHS) { return mySparseIndexer[aLHS] < mySparseIndexer[aRHS]; });
+		ApplyOrder(order);
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	template<class Compare>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::Sort(Compare aCompare)
+	{
+		std::vector<size_t> order(myElements.size());
+		for (size_t index = 0; index < order.size(); ++index)
+		{
+			order[index] = index;
+		}
+		std::sort(order.begin(), order.end(), [this, &aCompare](const size_t aLHS, const size_t aRHS) { return aCompare(myElements[aLHS], myElements[aRHS]); });
+		ApplyOrder(order);
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline bool SparseVector<ElementType, SizeType, SparseStorage>::IsSorted() const
+	{
+		return mySparseIndexer.IsSorted();
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline SizeType SparseVector<ElementType, SizeType, SparseStorage>::LowerBound(const SizeType anIdentifier) const
+	{
+		return static_cast<SizeType>(mySparseIndexer.LowerBound(anIdentifier));
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline SizeType SparseVector<ElementType, SizeType, SparseStorage>::UpperBound(const SizeType anIdentifier) const
+	{
+		return static_cast<SizeType>(mySparseIndexer.UpperBound(anIdentifier));
+	}
+
+	template<class ElementType, class SizeType, class SparseStorage>
+	inline void SparseVector<ElementType, SizeType, SparseStorage>::ApplyOrder(const std::vector<size_t>& someOrder)
+	{
+		std::vector<ElementType> orderedElements;
+		orderedElements.reserve(myElements.size());
+		for (const size_t index : someOrder)
+		{
+			orderedElements.push_back(std::move(myElements[index]));
+		}
+
+		myElements.swap(orderedElements);
+		mySparseIndexer.Permute(someOrder.data());
+	}
 }
 
 namespace CU = CommonUtility;
\ No newline at end of file
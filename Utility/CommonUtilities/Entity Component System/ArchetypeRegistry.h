@@ -0,0 +1,665 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <assert.h>
+
+#include "TemplateUtility/TemplateUtility.h"
+#include "Threading/ThreadPool.h"
+#include "EntityTraits.h"
+#include "EntityRegistry.h"
+
+/*
+	Archetype storage engine, an alternative to the sparse-set-per-type BasicEntityRegistry with the same
+	Create/Destroy/Assign/Remove/ForEach surface so both can be run on the same workload.
+	Entities owning exactly the same component types share an archetype, which stores one column per type in the
+	structure-of-arrays layout of SoAC, except that the column types are picked at runtime. A query walks the columns of
+	every matching archetype linearly without any per-type lookups, in exchange Assign and Remove move the entity and all
+	of its components to another archetype.
+	Archetypes are looked up by signature(the sorted component type indices). The archetype reached by adding or removing
+	a type is cached as an edge on the source archetype, so repeated transitions skip the lookup.
+	Any structural change may move components, references from Assign or GetComponent only last until the next one.
+*/
+
+template<class EntityType>
+class BasicArchetypeRegistry
+{
+public:
+	using Traits = EntityTraits<EntityType>;
+
+	static constexpr size_t forEachChunkBytes = 16 * 1024;//Component bytes touched per parallel ForEach chunk.
+
+	BasicArchetypeRegistry();
+	BasicArchetypeRegistry(const BasicArchetypeRegistry& aRegistry) = delete;
+	~BasicArchetypeRegistry();
+
+	BasicArchetypeRegistry& operator=(const BasicArchetypeRegistry& aRegistry) = delete;
+
+	const EntityType Create();
+	void CreateMany(const size_t aCount, EntityType* someEntitiesOut);
+	void Destroy(const EntityType& anEntity);
+
+	bool IsValid(const EntityType& anEntity) const;
+	const size_t Size() const;
+
+	template<class ComponentType>
+	ComponentType& Assign(const EntityType& anEntity);
+
+	template<class ComponentType>
+	void Remove(const EntityType& anEntity);
+
+	template<class ComponentType>
+	bool Has(const EntityType& anEntity) const;
+
+	template<class ComponentType>
+	ComponentType& GetComponent(const EntityType& anEntity);
+
+	//Calls aFunction(entity, components&...) for every entity owning all ComponentTypes. Structural changes are not allowed during the pass.
+	template<class ... ComponentTypes, class Function>
+	void ForEach(const Function& aFunction, const ExecutionPolicy aPolicy = ExecutionPolicy::Sequential, CU::ThreadPool* aThreadPool = nullptr);
+
+	//Counterpart of GetPool, calls aFunction(entities, count, ComponentTypes* columns...) once per matching, non-empty archetype.
+	template<class ... ComponentTypes, class Function>
+	void ForEachArchetype(const Function& aFunction);
+
+	const size_t GetArchetypeCount() const;
+
+private:
+	enum class ComponentEnum;
+
+	using ComponentEnumerator = TemplateUtility::TypeFamily<ComponentEnum>;
+	using ComponentIndex = typename ComponentEnumerator::family_type;
+	using Signature = std::vector<ComponentIndex>;
+
+	enum class QueryEnum;
+
+	using QueryEnumerator = TemplateUtility::TypeFamily<QueryEnum>;
+
+	static constexpr size_t noArchetype = std::numeric_limits<size_t>::max();
+	static constexpr size_t noColumn = std::numeric_limits<size_t>::max();
+	static constexpr size_t emptyArchetype = 0;
+	static constexpr size_t columnAlignment = 64;
+	static constexpr size_t minimumCapacity = 16;
+
+	struct ComponentInfo
+	{
+		size_t mySize;
+		size_t myAlignment;
+		void(*myDefaultConstructFunc)(void*);
+		void(*myMoveConstructFunc)(void*, void*);
+		void(*myDestructFunc)(void*);
+	};
+
+	struct Column
+	{
+		void* At(const size_t aRow) const { return myData + aRow * myInfo->mySize; }
+
+		const ComponentInfo* myInfo = nullptr;
+		unsigned char* myData = nullptr;
+	};
+
+	struct Archetype
+	{
+		Signature mySignature;
+		std::vector<Column> myColumns;//Parallel to mySignature.
+		std::vector<size_t> myColumnLookup;//Column of every component index, noColumn when the type is not part of the archetype.
+		std::vector<EntityType> myEntities;
+		size_t myCapacity = 0;
+		std::vector<size_t> myAddEdges;//Archetype reached by adding a component index, noArchetype until first used.
+		std::vector<size_t> myRemoveEdges;
+	};
+
+	struct EntityLocation
+	{
+		size_t myArchetype;
+		size_t myRow;
+	};
+
+	struct CachedQuery
+	{
+		std::vector<size_t> myArchetypes;
+		size_t mySeenArchetypeCount = 0;
+	};
+
+	struct ForEachChunk
+	{
+		size_t myArchetype;
+		size_t myBegin;
+		size_t myEnd;
+	};
+
+	template<class ComponentType>
+	static const ComponentInfo& GetComponentInfo();
+
+	template<class ComponentType>
+	static void DefaultConstruct(void* aDestination);
+
+	template<class ComponentType>
+	static void MoveConstruct(void* aDestination, void* aSource);
+
+	template<class ComponentType>
+	static void Destruct(void* anObject);
+
+	static size_t LookupColumn(const Archetype& anArchetype, const ComponentIndex aComponentIndex);
+
+	template<class ComponentType>
+	static ComponentType* GetColumnData(const Archetype& anArchetype);
+
+	template<class ComponentType>
+	ComponentIndex AssureComponentInfo();
+
+	template<class ... ComponentTypes>
+	const std::vector<size_t>& GetMatchingArchetypes();
+
+	size_t FindOrCreateArchetype(Signature&& aSignature);
+	size_t GetAddEdge(const size_t anArchetype, const ComponentIndex aComponentIndex);
+	size_t GetRemoveEdge(const size_t anArchetype, const ComponentIndex aComponentIndex);
+
+	size_t AppendRow(Archetype& anArchetype, const EntityType& anEntity);
+	void RemoveRow(const size_t anArchetype, const size_t aRow);
+	void Grow(Archetype& anArchetype, const size_t aCapacity);
+	void MoveEntity(const EntityType& anEntity, const size_t aTargetArchetype);
+
+	static unsigned char* AllocateColumn(const ComponentInfo& anInfo, const size_t aCapacity);
+	static void FreeColumn(unsigned char* aData);
+
+	std::vector<std::unique_ptr<Archetype>> myArchetypes;
+	std::map<Signature, size_t> myArchetypeLookup;
+	std::vector<const ComponentInfo*> myComponentInfos;
+	std::vector<CachedQuery> myQueries;
+	std::vector<ForEachChunk> myForEachChunks;
+
+	std::vector<EntityType> myEntitySlots;
+	std::vector<EntityLocation> myLocations;
+	EntityType myFreeListHead;
+	size_t myAliveCount;
+};
+
+using ArchetypeRegistry = BasicArchetypeRegistry<Entity>;
+
+template<class EntityType>
+inline BasicArchetypeRegistry<EntityType>::BasicArchetypeRegistry() : myFreeListHead(Traits::nullIndex), myAliveCount(0)
+{
+	FindOrCreateArchetype(Signature());
+}
+
+template<class EntityType>
+inline BasicArchetypeRegistry<EntityType>::~BasicArchetypeRegistry()
+{
+	for (const std::unique_ptr<Archetype>& archetype : myArchetypes)
+	{
+		for (Column& column : archetype->myColumns)
+		{
+			for (size_t row = 0; row < archetype->myEntities.size(); ++row)
+			{
+				column.myInfo->myDestructFunc(column.At(row));
+			}
+			FreeColumn(column.myData);
+		}
+	}
+}
+
+template<class EntityType>
+inline const EntityType BasicArchetypeRegistry<EntityType>::Create()
+{
+	EntityType entity;
+
+	if (myFreeListHead != Traits::nullIndex)
+	{
+		const EntityType index = myFreeListHead;
+		const EntityType freeSlot = myEntitySlots[index];
+		myFreeListHead = Traits::ToIndex(freeSlot);
+
+		entity = Traits::Combine(index, Traits::ToVersion(freeSlot));
+		myEntitySlots[index] = entity;
+	}
+	else
+	{
+		const EntityType index = static_cast<EntityType>(myEntitySlots.size());
+		assert(index < Traits::nullIndex && "ArchetypeRegistry is out of entity indices, use a wider entity type.");
+
+		entity = Traits::Combine(index, 0);
+		myEntitySlots.push_back(entity);
+		myLocations.emplace_back();
+	}
+
+	myLocations[Traits::ToIndex(entity)] = { emptyArchetype, AppendRow(*myArchetypes[emptyArchetype], entity) };
+
+	++myAliveCount;
+	return entity;
+}
+
+template<class EntityType>
+inline void BasicArchetypeRegistry<EntityType>::CreateMany(const size_t aCount, EntityType * someEntitiesOut)
+{
+	for (size_t index = 0; index < aCount; ++index)
+	{
+		someEntitiesOut[index] = Create();
+	}
+}
+
+template<class EntityType>
+inline void BasicArchetypeRegistry<EntityType>::Destroy(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && "Tried to destroy an entity that is not alive.");
+
+	const EntityType index = Traits::ToIndex(anEntity);
+	const EntityLocation location = myLocations[index];
+	RemoveRow(location.myArchetype, location.myRow);
+
+	const EntityType nextVersion = static_cast<EntityType>(Traits::ToVersion(anEntity) + 1);
+	myEntitySlots[index] = Traits::Combine(myFreeListHead, nextVersion);
+	myFreeListHead = index;
+
+	--myAliveCount;
+}
+
+template<class EntityType>
+inline bool BasicArchetypeRegistry<EntityType>::IsValid(const EntityType & anEntity) const
+{
+	const EntityType index = Traits::ToIndex(anEntity);
+	return (index < myEntitySlots.size()) && (myEntitySlots[index] == anEntity);
+}
+
+template<class EntityType>
+inline const size_t BasicArchetypeRegistry<EntityType>::Size() const
+{
+	return myAliveCount;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline ComponentType & BasicArchetypeRegistry<EntityType>::Assign(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && "Tried to assign a component to an entity that is not alive.");
+
+	const ComponentIndex componentIndex = AssureComponentInfo<ComponentType>();
+	const size_t sourceArchetype = myLocations[Traits::ToIndex(anEntity)].myArchetype;
+	assert(LookupColumn(*myArchetypes[sourceArchetype], componentIndex) == noColumn && "Tried to assign a component to an entity already owning a component of that type.");
+
+	MoveEntity(anEntity, GetAddEdge(sourceArchetype, componentIndex));
+	return GetComponent<ComponentType>(anEntity);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicArchetypeRegistry<EntityType>::Remove(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && "Tried to remove a component from an entity that is not alive.");
+	assert(Has<ComponentType>(anEntity) && "Component not found for entity, could not be removed.");
+
+	const size_t sourceArchetype = myLocations[Traits::ToIndex(anEntity)].myArchetype;
+	MoveEntity(anEntity, GetRemoveEdge(sourceArchetype, ComponentEnumerator::template type<ComponentType>));
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline bool BasicArchetypeRegistry<EntityType>::Has(const EntityType & anEntity) const
+{
+	const Archetype& archetype = *myArchetypes[myLocations[Traits::ToIndex(anEntity)].myArchetype];
+	return LookupColumn(archetype, ComponentEnumerator::template type<ComponentType>) != noColumn;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline ComponentType & BasicArchetypeRegistry<EntityType>::GetComponent(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && Has<ComponentType>(anEntity) && "Entity does not own a component of that type.");
+
+	const EntityLocation& location = myLocations[Traits::ToIndex(anEntity)];
+	return GetColumnData<ComponentType>(*myArchetypes[location.myArchetype])[location.myRow];
+}
+
+template<class EntityType>
+template<class ...ComponentTypes, class Function>
+inline void BasicArchetypeRegistry<EntityType>::ForEach(const Function & aFunction, const ExecutionPolicy aPolicy, CU::ThreadPool * aThreadPool)
+{
+	static_assert(sizeof...(ComponentTypes) > 0, "ForEach needs at least one component type.");
+
+	const std::vector<size_t>& archetypes = GetMatchingArchetypes<ComponentTypes...>();
+
+	auto runRange = [&](const Archetype& anArchetype, const size_t aBegin, const size_t anEnd)
+	{
+		auto runColumns = [&](ComponentTypes* ... someColumns)
+		{
+			for (size_t row = aBegin; row < anEnd; ++row)
+			{
+				aFunction(anArchetype.myEntities[row], someColumns[row]...);
+			}
+		};
+		runColumns(GetColumnData<ComponentTypes>(anArchetype)...);
+	};
+
+	if (aPolicy == ExecutionPolicy::Sequential)
+	{
+		for (const size_t archetypeIndex : archetypes)
+		{
+			const Archetype& archetype = *myArchetypes[archetypeIndex];
+			runRange(archetype, 0, archetype.myEntities.size());
+		}
+		return;
+	}
+
+	const size_t componentBytes = (sizeof(ComponentTypes) + ...);
+	const size_t chunkRows = (std::max)(static_cast<size_t>(1), forEachChunkBytes / componentBytes);
+
+	myForEachChunks.clear();
+	for (const size_t archetypeIndex : archetypes)
+	{
+		const size_t rowCount = myArchetypes[archetypeIndex]->myEntities.size();
+		for (size_t begin = 0; begin < rowCount; begin += chunkRows)
+		{
+			myForEachChunks.push_back({ archetypeIndex, begin, (std::min)(begin + chunkRows, rowCount) });
+		}
+	}
+
+	CU::ThreadPool::GetOrDefault(aThreadPool).ParallelFor(myForEachChunks.size(), [&](const size_t aChunkIndex)
+	{
+		const ForEachChunk& chunk = myForEachChunks[aChunkIndex];
+		runRange(*myArchetypes[chunk.myArchetype], chunk.myBegin, chunk.myEnd);
+	});
+}
+
+template<class EntityType>
+template<class ...ComponentTypes, class Function>
+inline void BasicArchetypeRegistry<EntityType>::ForEachArchetype(const Function & aFunction)
+{
+	for (const size_t archetypeIndex : GetMatchingArchetypes<ComponentTypes...>())
+	{
+		const Archetype& archetype = *myArchetypes[archetypeIndex];
+		if (!archetype.myEntities.empty())
+		{
+			aFunction(archetype.myEntities.data(), archetype.myEntities.size(), GetColumnData<ComponentTypes>(archetype)...);
+		}
+	}
+}
+
+template<class EntityType>
+inline const size_t BasicArchetypeRegistry<EntityType>::GetArchetypeCount() const
+{
+	return myArchetypes.size();
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline const typename BasicArchetypeRegistry<EntityType>::ComponentInfo & BasicArchetypeRegistry<EntityType>::GetComponentInfo()
+{
+	static_assert(alignof(ComponentType) <= columnAlignment, "Over-aligned components are not supported by the archetype columns.");
+
+	static const ComponentInfo info =
+	{
+		sizeof(ComponentType),
+		alignof(ComponentType),
+		&BasicArchetypeRegistry::DefaultConstruct<ComponentType>,
+		&BasicArchetypeRegistry::MoveConstruct<ComponentType>,
+		&BasicArchetypeRegistry::Destruct<ComponentType>
+	};
+	return info;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicArchetypeRegistry<EntityType>::DefaultConstruct(void * aDestination)
+{
+	new(aDestination) ComponentType();
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicArchetypeRegistry<EntityType>::MoveConstruct(void * aDestination, void * aSource)
+{
+	new(aDestination) ComponentType(std::move(*static_cast<ComponentType*>(aSource)));
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicArchetypeRegistry<EntityType>::Destruct(void * anObject)
+{
+	static_cast<ComponentType*>(anObject)->~ComponentType();
+}
+
+template<class EntityType>
+inline size_t BasicArchetypeRegistry<EntityType>::LookupColumn(const Archetype & anArchetype, const ComponentIndex aComponentIndex)
+{
+	return (aComponentIndex < anArchetype.myColumnLookup.size()) ? anArchetype.myColumnLookup[aComponentIndex] : noColumn;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline ComponentType * BasicArchetypeRegistry<EntityType>::GetColumnData(const Archetype & anArchetype)
+{
+	const size_t column = LookupColumn(anArchetype, ComponentEnumerator::template type<ComponentType>);
+	return reinterpret_cast<ComponentType*>(anArchetype.myColumns[column].myData);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline typename BasicArchetypeRegistry<EntityType>::ComponentIndex BasicArchetypeRegistry<EntityType>::AssureComponentInfo()
+{
+	const ComponentIndex componentIndex = ComponentEnumerator::template type<ComponentType>;
+	if (myComponentInfos.size() <= componentIndex)
+	{
+		myComponentInfos.resize(componentIndex + 1, nullptr);
+	}
+	myComponentInfos[componentIndex] = &GetComponentInfo<ComponentType>();
+
+	return componentIndex;
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline const std::vector<size_t>& BasicArchetypeRegistry<EntityType>::GetMatchingArchetypes()
+{
+	const size_t queryIndex = QueryEnumerator::template type<ComponentTypes...>;
+	if (myQueries.size() <= queryIndex)
+	{
+		myQueries.resize(queryIndex + 1);
+	}
+
+	//Archetypes are never removed, so only the ones created since the last use of the query need checking.
+	CachedQuery& query = myQueries[queryIndex];
+	for (; query.mySeenArchetypeCount < myArchetypes.size(); ++query.mySeenArchetypeCount)
+	{
+		const Archetype& archetype = *myArchetypes[query.mySeenArchetypeCount];
+		if (((LookupColumn(archetype, ComponentEnumerator::template type<ComponentTypes>) != noColumn) && ...))
+		{
+			query.myArchetypes.push_back(query.mySeenArchetypeCount);
+		}
+	}
+
+	return query.myArchetypes;
+}
+
+template<class EntityType>
+inline size_t BasicArchetypeRegistry<EntityType>::FindOrCreateArchetype(Signature && aSignature)
+{
+	const typename std::map<Signature, size_t>::const_iterator found = myArchetypeLookup.find(aSignature);
+	if (found != myArchetypeLookup.end())
+	{
+		return found->second;
+	}
+
+	const size_t archetypeIndex = myArchetypes.size();
+	myArchetypes.push_back(std::make_unique<Archetype>());
+	Archetype& archetype = *myArchetypes.back();
+
+	archetype.mySignature = aSignature;
+	archetype.myColumns.resize(aSignature.size());
+	archetype.myColumnLookup.resize(aSignature.empty() ? 0 : (aSignature.back() + 1), noColumn);
+	for (size_t column = 0; column < aSignature.size(); ++column)
+	{
+		archetype.myColumns[column].myInfo = myComponentInfos[aSignature[column]];
+		archetype.myColumnLookup[aSignature[column]] = column;
+	}
+
+	myArchetypeLookup.emplace(std::move(aSignature), archetypeIndex);
+	return archetypeIndex;
+}
+
+template<class EntityType>
+inline size_t BasicArchetypeRegistry<EntityType>::GetAddEdge(const size_t anArchetype, const ComponentIndex aComponentIndex)
+{
+	{
+		const Archetype& source = *myArchetypes[anArchetype];
+		if ((aComponentIndex < source.myAddEdges.size()) && (source.myAddEdges[aComponentIndex] != noArchetype))
+		{
+			return source.myAddEdges[aComponentIndex];
+		}
+	}
+
+	Signature signature = myArchetypes[anArchetype]->mySignature;
+	signature.insert(std::lower_bound(signature.begin(), signature.end(), aComponentIndex), aComponentIndex);
+	const size_t targetArchetype = FindOrCreateArchetype(std::move(signature));
+
+	//Both directions of the transition are known now.
+	Archetype& source = *myArchetypes[anArchetype];
+	if (source.myAddEdges.size() <= aComponentIndex)
+	{
+		source.myAddEdges.resize(aComponentIndex + 1, noArchetype);
+	}
+	source.myAddEdges[aComponentIndex] = targetArchetype;
+
+	Archetype& target = *myArchetypes[targetArchetype];
+	if (target.myRemoveEdges.size() <= aComponentIndex)
+	{
+		target.myRemoveEdges.resize(aComponentIndex + 1, noArchetype);
+	}
+	target.myRemoveEdges[aComponentIndex] = anArchetype;
+
+	return targetArchetype;
+}
+
+template<class EntityType>
+inline size_t BasicArchetypeRegistry<EntityType>::GetRemoveEdge(const size_t anArchetype, const ComponentIndex aComponentIndex)
+{
+	{
+		const Archetype& source = *myArchetypes[anArchetype];
+		if ((aComponentIndex < source.myRemoveEdges.size()) && (source.myRemoveEdges[aComponentIndex] != noArchetype))
+		{
+			return source.myRemoveEdges[aComponentIndex];
+		}
+	}
+
+	Signature signature = myArchetypes[anArchetype]->mySignature;
+	signature.erase(std::lower_bound(signature.begin(), signature.end(), aComponentIndex));
+	const size_t targetArchetype = FindOrCreateArchetype(std::move(signature));
+
+	Archetype& source = *myArchetypes[anArchetype];
+	if (source.myRemoveEdges.size() <= aComponentIndex)
+	{
+		source.myRemoveEdges.resize(aComponentIndex + 1, noArchetype);
+	}
+	source.myRemoveEdges[aComponentIndex] = targetArchetype;
+
+	Archetype& target = *myArchetypes[targetArchetype];
+	if (target.myAddEdges.size() <= aComponentIndex)
+	{
+		target.myAddEdges.resize(aComponentIndex + 1, noArchetype);
+	}
+	target.myAddEdges[aComponentIndex] = anArchetype;
+
+	return targetArchetype;
+}
+
+template<class EntityType>
+inline size_t BasicArchetypeRegistry<EntityType>::AppendRow(Archetype & anArchetype, const EntityType & anEntity)
+{
+	if (anArchetype.myEntities.size() == anArchetype.myCapacity)
+	{
+		Grow(anArchetype, (std::max)(minimumCapacity, anArchetype.myCapacity * 2));
+	}
+
+	anArchetype.myEntities.push_back(anEntity);
+	return anArchetype.myEntities.size() - 1;
+}
+
+template<class EntityType>
+inline void BasicArchetypeRegistry<EntityType>::RemoveRow(const size_t anArchetype, const size_t aRow)
+{
+	Archetype& archetype = *myArchetypes[anArchetype];
+	const size_t lastRow = archetype.myEntities.size() - 1;
+
+	for (Column& column : archetype.myColumns)
+	{
+		column.myInfo->myDestructFunc(column.At(aRow));
+		if (aRow != lastRow)
+		{
+			column.myInfo->myMoveConstructFunc(column.At(aRow), column.At(lastRow));
+			column.myInfo->myDestructFunc(column.At(lastRow));
+		}
+	}
+
+	if (aRow != lastRow)
+	{
+		const EntityType movedEntity = archetype.myEntities[lastRow];
+		archetype.myEntities[aRow] = movedEntity;
+		myLocations[Traits::ToIndex(movedEntity)].myRow = aRow;
+	}
+	archetype.myEntities.pop_back();
+}
+
+template<class EntityType>
+inline void BasicArchetypeRegistry<EntityType>::Grow(Archetype & anArchetype, const size_t aCapacity)
+{
+	for (Column& column : anArchetype.myColumns)
+	{
+		const ComponentInfo& info = *column.myInfo;
+		unsigned char* newData = AllocateColumn(info, aCapacity);
+		for (size_t row = 0; row < anArchetype.myEntities.size(); ++row)
+		{
+			info.myMoveConstructFunc(newData + row * info.mySize, column.At(row));
+			info.myDestructFunc(column.At(row));
+		}
+
+		FreeColumn(column.myData);
+		column.myData = newData;
+	}
+
+	anArchetype.myEntities.reserve(aCapacity);
+	anArchetype.myCapacity = aCapacity;
+}
+
+template<class EntityType>
+inline void BasicArchetypeRegistry<EntityType>::MoveEntity(const EntityType & anEntity, const size_t aTargetArchetype)
+{
+	EntityLocation& location = myLocations[Traits::ToIndex(anEntity)];
+	const Archetype& source = *myArchetypes[location.myArchetype];
+	Archetype& target = *myArchetypes[aTargetArchetype];
+
+	const size_t targetRow = AppendRow(target, anEntity);
+	for (size_t column = 0; column < target.myColumns.size(); ++column)
+	{
+		const Column& targetColumn = target.myColumns[column];
+		const size_t sourceColumn = LookupColumn(source, target.mySignature[column]);
+		if (sourceColumn != noColumn)
+		{
+			targetColumn.myInfo->myMoveConstructFunc(targetColumn.At(targetRow), source.myColumns[sourceColumn].At(location.myRow));
+		}
+		else
+		{
+			targetColumn.myInfo->myDefaultConstructFunc(targetColumn.At(targetRow));
+		}
+	}
+
+	//Destructs the moved-from components and those the target does not have.
+	RemoveRow(location.myArchetype, location.myRow);
+	location = { aTargetArchetype, targetRow };
+}
+
+template<class EntityType>
+inline unsigned char * BasicArchetypeRegistry<EntityType>::AllocateColumn(const ComponentInfo & anInfo, const size_t aCapacity)
+{
+	return static_cast<unsigned char*>(::operator new(anInfo.mySize * aCapacity, std::align_val_t(columnAlignment)));
+}
+
+template<class EntityType>
+inline void BasicArchetypeRegistry<EntityType>::FreeColumn(unsigned char * aData)
+{
+	if (aData != nullptr)
+	{
+		::operator delete(aData, std::align_val_t(columnAlignment));
+	}
+}
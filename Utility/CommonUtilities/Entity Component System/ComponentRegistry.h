@@ -1,46 +1,104 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
 
 #include "TemplateUtility/TemplateUtility.h"
 #include "Container/SparseSet.h"
+#include "EntityTraits.h"
+#include "ComponentStorage.h"
 
-typedef unsigned short Entity;
-
-class ComponentRegistry
+template<class EntityType>
+class BasicComponentRegistry
 {
 public:
-	ComponentRegistry() {}
-	~ComponentRegistry() 	
+	using EntitySet = CU::SparseSet<EntityType, EntitySparseIndex<EntityType>>;
+
+	//Container the pool of ComponentType is stored in, see ComponentStorage.
+	template<class ComponentType>
+	using PoolType = typename ComponentStorage<ComponentType>::PoolType;
+
+	BasicComponentRegistry() {}
+	~BasicComponentRegistry()
 	{
 		for (ComponentPool& p : myPools)
 		{
-			(this->*p.myOnDestructFunc)();
+			if (p.myComponents != nullptr)
+			{
+				(this->*p.myOnDestructFunc)();
+			}
 		}
 	}
 
 	template<class ComponentType>
-	ComponentType& Assign(const Entity& anEntity);
+	ComponentType& Assign(const EntityType& anEntity);
 
+	//Assigns a copy of aValue to every entity in someEntities. The pool and entity set grow once for the whole batch.
 	template<class ComponentType>
-	void Remove(const Entity& anEntity);
+	void AssignMany(const EntityType* someEntities, const size_t aCount, const ComponentType& aValue = ComponentType());
 
-	void RemoveAll(const Entity& anEntity);
+	//Like AssignMany, the component of someEntities[i] is constructed in place from aGenerator(i).
+	template<class ComponentType, class Generator>
+	void AssignManyGenerated(const EntityType* someEntities, const size_t aCount, const Generator& aGenerator);
 
+	//Swaps the last component of the pool into the freed slot, O(1) but changes the order of the pool.
 	template<class ComponentType>
-	std::vector<ComponentType>& GetPool();
+	void Remove(const EntityType& anEntity);
 
+	//Keeps the relative order of the remaining components, O(n) in the pool size. For pools whose order matters.
 	template<class ComponentType>
-	const CU::SparseSet<Entity>& GetEntities();
+	void RemoveOrdered(const EntityType& anEntity);
+
+	//Removes ComponentType from every entity in someEntities by swap-removing from the highest dense index down, O(batch).
+	//Pools owned by a group keep their order with one compaction pass instead.
+	template<class ComponentType>
+	void RemoveMany(const EntityType* someEntities, const size_t aCount);
+
+	void RemoveAll(const EntityType& anEntity);
+	void RemoveAllMany(const EntityType* someEntities, const size_t aCount);
+
+	template<class ComponentType>
+	PoolType<ComponentType>& GetPool();
+
+	template<class ComponentType>
+	const EntitySet& GetEntities();
 
 	template<class ComponentType>
 	const bool Exists() const;
 
+	//Entities owning every one of ComponentTypes. The set is built on first use and then kept up to date by Assign and Remove,
+	//so reading it costs nothing per frame. Views are keyed on the exact type order, View<A, B> and View<B, A> are separate views.
+	template<class ... ComponentTypes>
+	const EntitySet& View();
+
+	/*
+		Declares ComponentTypes as an owning group on first use and returns the amount of grouped entities.
+		The grouped entities sit at dense indices [0, size) of every owned pool, in the same order in each, so a
+		joined iteration is a lockstep walk over GetPool<T>() arrays. A pool can be owned by a single group.
+	*/
+	template<class ... ComponentTypes>
+	const size_t Group();
+
 private:
 
 	enum class EntityEnum;
 
 	using ComponentEnumerator = TemplateUtility::TypeFamily<EntityEnum>;
-	using EnumeratorType = ComponentEnumerator::family_type;
+	using EnumeratorType = typename ComponentEnumerator::family_type;
+
+	enum class ViewEnum;
+
+	using ViewEnumerator = TemplateUtility::TypeFamily<ViewEnum>;
+
+	enum class GroupEnum;
+
+	using GroupEnumerator = TemplateUtility::TypeFamily<GroupEnum>;
+
+	static constexpr size_t noGroup = std::numeric_limits<size_t>::max();
+	static constexpr size_t victimWordBits = 64;
 
 	template<class ComponentType>
 	void AssureExistance();
@@ -48,108 +106,514 @@ private:
 	template<class ComponentType>
 	void OnDestruct();
 
+	template<class ... ComponentTypes>
+	bool HasAll(const EntityType& anEntity) const;
+
+	static unsigned int HighestSetBit(const uint64_t aWord);
+
+	template<class ComponentType>
+	void SwapDense(const size_t aFirstIndex, const size_t aSecondIndex);
+
+	void AttachToViewsAndGroup(const EnumeratorType aTypeIndex, const EntityType& anEntity);
+	void DetachFromViewsAndGroup(const EnumeratorType aTypeIndex, const EntityType& anEntity);
+
+	struct OwningGroup;
+
+	bool IsGrouped(const OwningGroup& aGroup, const EntityType& anEntity) const;
+	void AddToGroup(OwningGroup& aGroup, const EntityType& anEntity);
+	void RemoveFromGroup(OwningGroup& aGroup, const EntityType& anEntity);
+
 	struct ComponentPool
 	{
-		CU::SparseSet<Entity> myEntities;
+		EntitySet myEntities;
 		void* myComponents = nullptr;
-		void(ComponentRegistry::*myRemoveFunc)(const Entity&);
-		void(ComponentRegistry::*myOnDestructFunc)();
+		void(BasicComponentRegistry::*myRemoveFunc)(const EntityType&);
+		void(BasicComponentRegistry::*myRemoveManyFunc)(const EntityType*, const size_t);
+		void(BasicComponentRegistry::*myOnDestructFunc)();
+		void(BasicComponentRegistry::*mySwapFunc)(const size_t, const size_t);
+		std::vector<size_t> myObservingViews;
+		size_t myOwningGroup = noGroup;
+	};
+
+	struct CachedView
+	{
+		EntitySet myEntities;
+		bool(BasicComponentRegistry::*myMatchFunc)(const EntityType&) const;
+	};
+
+	struct OwningGroup
+	{
+		std::vector<EnumeratorType> myOwnedTypes;
+		size_t mySize = 0;
+		bool(BasicComponentRegistry::*myMatchFunc)(const EntityType&) const;
 	};
 
 	std::vector<ComponentPool> myPools;
+	std::vector<std::unique_ptr<CachedView>> myViews;
+	std::vector<std::unique_ptr<OwningGroup>> myGroups;
+	std::vector<uint64_t> myVictimBits;
 
 };
 
+using ComponentRegistry = BasicComponentRegistry<Entity>;
+
+template<class EntityType>
 template<class ComponentType>
-inline ComponentType& ComponentRegistry::Assign(const Entity & anEntity)
+inline ComponentType& BasicComponentRegistry<EntityType>::Assign(const EntityType & anEntity)
 {
 	AssureExistance<ComponentType>();
 
-	const EnumeratorType typeIndex = ComponentEnumerator::type<ComponentType>;
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
 
-	CU::SparseSet<Entity>& entities = myPools[typeIndex].myEntities;
-	std::vector<ComponentType>& componentPool = GetPool<ComponentType>();
-	Entity index = entities.Find(anEntity);
-	assert(index == CU::SparseSet<Entity>::failureIndex && "Tried to assign a component to an entity already owning a component of that type.");
+	EntitySet& entities = myPools[typeIndex].myEntities;
+	PoolType<ComponentType>& componentPool = GetPool<ComponentType>();
+	EntityType index = entities.Find(anEntity);
+	assert(index == EntitySet::failureIndex && "Tried to assign a component to an entity already owning a component of that type.");
 	entities.Add(anEntity);
-	componentPool.push_back(ComponentType());
+	componentPool.emplace_back();
+
+	AttachToViewsAndGroup(typeIndex, anEntity);
+
+	return componentPool[entities.Find(anEntity)];
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicComponentRegistry<EntityType>::AssignMany(const EntityType * someEntities, const size_t aCount, const ComponentType & aValue)
+{
+	AssignManyGenerated<ComponentType>(someEntities, aCount, [&aValue](const size_t) -> const ComponentType& { return aValue; });
+}
+
+template<class EntityType>
+template<class ComponentType, class Generator>
+inline void BasicComponentRegistry<EntityType>::AssignManyGenerated(const EntityType * someEntities, const size_t aCount, const Generator & aGenerator)
+{
+	AssureExistance<ComponentType>();
+
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
+
+	EntitySet& entities = myPools[typeIndex].myEntities;
+	PoolType<ComponentType>& componentPool = GetPool<ComponentType>();
+	entities.AddMany(someEntities, aCount);
+
+	if ((componentPool.size() + aCount) > componentPool.capacity())
+	{
+		componentPool.reserve((std::max)(componentPool.size() + aCount, componentPool.capacity() * 2));
+	}
+	for (size_t index = 0; index < aCount; ++index)
+	{
+		componentPool.emplace_back(aGenerator(index));
+	}
+
+	//Views and groups are only touched once the whole batch is in, group swaps would otherwise scatter the new components.
+	if (!myPools[typeIndex].myObservingViews.empty() || (myPools[typeIndex].myOwningGroup != noGroup))
+	{
+		for (size_t index = 0; index < aCount; ++index)
+		{
+			AttachToViewsAndGroup(typeIndex, someEntities[index]);
+		}
+	}
+}
 
-	return componentPool[componentPool.size() - 1];
+template<class EntityType>
+template<class ComponentType>
+inline void BasicComponentRegistry<EntityType>::Remove(const EntityType & anEntity)
+{
+	AssureExistance<ComponentType>();
+
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
+	EntitySet& entities = myPools[typeIndex].myEntities;
+	assert(entities.IsValid(anEntity) && "Component not found for entity, could not be removed.");
+
+	DetachFromViewsAndGroup(typeIndex, anEntity);
+	const EntityType entityIndex = entities.Find(anEntity);
+
+	//Grouped entities only live below the group boundary and the entity has left its group, so the tail is never grouped.
+	PoolType<ComponentType>& componentPool = GetPool<ComponentType>();
+	if (static_cast<size_t>(entityIndex) != (componentPool.size() - 1))
+	{
+		componentPool[entityIndex] = std::move(componentPool.back());
+	}
+	componentPool.pop_back();
+	entities.RemoveCyclic(anEntity);
 }
 
+template<class EntityType>
 template<class ComponentType>
-inline void ComponentRegistry::Remove(const Entity & anEntity)
+inline void BasicComponentRegistry<EntityType>::RemoveOrdered(const EntityType & anEntity)
 {
 	AssureExistance<ComponentType>();
 
-	const EnumeratorType typeIndex = ComponentEnumerator::type<ComponentType>;
-	CU::SparseSet<Entity>& entities = myPools[typeIndex].myEntities;
-	Entity entityIndex = entities.Find(anEntity);
-	assert(entityIndex != CU::SparseSet<Entity>::failureIndex && "Component not found for entity, could not be removed.");
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
+	EntitySet& entities = myPools[typeIndex].myEntities;
+	assert(entities.IsValid(anEntity) && "Component not found for entity, could not be removed.");
 
-	std::vector<ComponentType>& componentPool = GetPool<ComponentType>();
+	DetachFromViewsAndGroup(typeIndex, anEntity);
+	const EntityType entityIndex = entities.Find(anEntity);
 
-	componentPool[entityIndex] = componentPool[componentPool.size() - 1];
-	componentPool.resize(componentPool.size() - 1);
+	PoolType<ComponentType>& componentPool = GetPool<ComponentType>();
 
-	entities.Remove(entityIndex);
+	for (size_t index = entityIndex; (index + 1) < componentPool.size(); ++index)
+	{
+		componentPool[index] = std::move(componentPool[index + 1]);
+	}
+	componentPool.pop_back();
+	entities.Remove(anEntity);
 }
 
+template<class EntityType>
 template<class ComponentType>
-inline std::vector<ComponentType>& ComponentRegistry::GetPool()
+inline void BasicComponentRegistry<EntityType>::RemoveMany(const EntityType * someEntities, const size_t aCount)
 {
 	AssureExistance<ComponentType>();
 
-	const EnumeratorType typeIndex = ComponentEnumerator::type<ComponentType>;
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
+	EntitySet& entities = myPools[typeIndex].myEntities;
+	PoolType<ComponentType>& componentPool = GetPool<ComponentType>();
+
+	//Leaving a group swaps dense slots, so every victim is detached before any dense index is read.
+	for (size_t index = 0; index < aCount; ++index)
+	{
+		if (entities.IsValid(someEntities[index]))
+		{
+			DetachFromViewsAndGroup(typeIndex, someEntities[index]);
+		}
+	}
+
+	//Victims are marked in a bitmap over the dense indices, which sorts and dedupes them without comparing. Bits are cleared as
+	//they are consumed so the bitmap is all zero between calls.
+	std::vector<uint64_t>& victimBits = myVictimBits;
+	if (victimBits.size() < (componentPool.size() / victimWordBits + 1))
+	{
+		victimBits.resize(componentPool.size() / victimWordBits + 1, 0);
+	}
+
+	size_t firstVictim = componentPool.size();
+	size_t lastVictim = 0;
+	for (size_t index = 0; index < aCount; ++index)
+	{
+		const EntityType denseIndex = entities.Find(someEntities[index]);
+		if (denseIndex != EntitySet::failureIndex)
+		{
+			victimBits[denseIndex / victimWordBits] |= (static_cast<uint64_t>(1) << (denseIndex % victimWordBits));
+			firstVictim = (std::min)(firstVictim, static_cast<size_t>(denseIndex));
+			lastVictim = (std::max)(lastVictim, static_cast<size_t>(denseIndex));
+		}
+	}
+
+	if (firstVictim == componentPool.size())
+	{
+		return;
+	}
+
+	//Group owned pools keep their order, the swap-remove below is O(victims) instead of O(pool size).
+	if (myPools[typeIndex].myOwningGroup != noGroup)
+	{
+		size_t writeIndex = firstVictim;
+		for (size_t readIndex = firstVictim; readIndex < componentPool.size(); ++readIndex)
+		{
+			uint64_t& word = victimBits[readIndex / victimWordBits];
+			const uint64_t bit = static_cast<uint64_t>(1) << (readIndex % victimWordBits);
+			if ((word & bit) != 0)
+			{
+				word &= ~bit;
+				continue;
+			}
+
+			componentPool[writeIndex] = std::move(componentPool[readIndex]);
+			++writeIndex;
+		}
+		componentPool.resize(writeIndex);
+
+		entities.RemoveMany(someEntities, aCount);
+		return;
+	}
+
+	//Highest dense index first, every victim above the current one is already gone so the tail moved in is never a victim.
+	for (size_t wordIndex = lastVictim / victimWordBits + 1; wordIndex-- > firstVictim / victimWordBits;)
+	{
+		uint64_t& word = victimBits[wordIndex];
+		while (word != 0)
+		{
+			const unsigned int bitIndex = HighestSetBit(word);
+			word &= ~(static_cast<uint64_t>(1) << bitIndex);
+
+			const size_t denseIndex = wordIndex * victimWordBits + bitIndex;
+			if (denseIndex != (componentPool.size() - 1))
+			{
+				componentPool[denseIndex] = std::move(componentPool.back());
+			}
+			componentPool.pop_back();
+			entities.RemoveCyclic(entities[denseIndex]);
+		}
+	}
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline typename BasicComponentRegistry<EntityType>::template PoolType<ComponentType>& BasicComponentRegistry<EntityType>::GetPool()
+{
+	AssureExistance<ComponentType>();
+
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
 	ComponentPool& pool = myPools[typeIndex];
 
-	return *static_cast<std::vector<ComponentType>*>(pool.myComponents);
+	return *static_cast<PoolType<ComponentType>*>(pool.myComponents);
 }
 
+template<class EntityType>
 template<class ComponentType>
-inline const CU::SparseSet<Entity>& ComponentRegistry::GetEntities()
+inline const typename BasicComponentRegistry<EntityType>::EntitySet& BasicComponentRegistry<EntityType>::GetEntities()
 {
 	AssureExistance<ComponentType>();
-	const EnumeratorType typeIndex = ComponentEnumerator::type<ComponentType>;
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
 	const ComponentPool& pool = myPools[typeIndex];
 
 	return pool.myEntities;
 }
 
+template<class EntityType>
+template<class ComponentType>
+inline const bool BasicComponentRegistry<EntityType>::Exists() const
+{
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
+	return (typeIndex < myPools.size()) && (myPools[typeIndex].myComponents != nullptr);
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline const typename BasicComponentRegistry<EntityType>::EntitySet& BasicComponentRegistry<EntityType>::View()
+{
+	const size_t viewIndex = ViewEnumerator::template type<ComponentTypes...>;
+	if ((viewIndex < myViews.size()) && myViews[viewIndex])
+	{
+		return myViews[viewIndex]->myEntities;
+	}
+
+	(AssureExistance<ComponentTypes>(), ...);
+
+	if (myViews.size() <= viewIndex)
+	{
+		myViews.resize(viewIndex + 1);
+	}
+
+	myViews[viewIndex] = std::make_unique<CachedView>();
+	CachedView& view = *myViews[viewIndex];
+	view.myMatchFunc = &BasicComponentRegistry::HasAll<ComponentTypes...>;
+
+	(myPools[ComponentEnumerator::template type<ComponentTypes>].myObservingViews.push_back(viewIndex), ...);
+
+	const std::array<const EntitySet*, sizeof...(ComponentTypes)> componentSets = { &GetEntities<ComponentTypes>()... };
+	const EntitySet& smallestSet = **std::min_element(componentSets.begin(), componentSets.end(), [](const EntitySet* aLHS, const EntitySet* aRHS) { return aLHS->Size() < aRHS->Size(); });
+
+	for (size_t denseIndex = 0; denseIndex < smallestSet.Size(); ++denseIndex)
+	{
+		const EntityType entity = smallestSet[denseIndex];
+		if (HasAll<ComponentTypes...>(entity))
+		{
+			view.myEntities.Add(entity);
+		}
+	}
+
+	return view.myEntities;
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline const size_t BasicComponentRegistry<EntityType>::Group()
+{
+	static_assert(sizeof...(ComponentTypes) > 1, "An owning group needs at least two component types.");
+
+	const size_t groupIndex = GroupEnumerator::template type<ComponentTypes...>;
+	if ((groupIndex < myGroups.size()) && myGroups[groupIndex])
+	{
+		return myGroups[groupIndex]->mySize;
+	}
+
+	(AssureExistance<ComponentTypes>(), ...);
+	assert(((myPools[ComponentEnumerator::template type<ComponentTypes>].myOwningGroup == noGroup) && ...) && "A component pool can only be owned by one group.");
+
+	if (myGroups.size() <= groupIndex)
+	{
+		myGroups.resize(groupIndex + 1);
+	}
+
+	myGroups[groupIndex] = std::make_unique<OwningGroup>();
+	OwningGroup& group = *myGroups[groupIndex];
+	group.myOwnedTypes = { ComponentEnumerator::template type<ComponentTypes>... };
+	group.myMatchFunc = &BasicComponentRegistry::HasAll<ComponentTypes...>;
+
+	for (const EnumeratorType ownedType : group.myOwnedTypes)
+	{
+		myPools[ownedType].myOwningGroup = groupIndex;
+	}
+
+	//Walking forward while packing is safe, AddToGroup only swaps the current index with an already visited one.
+	const EntitySet* smallestSet = &myPools[group.myOwnedTypes[0]].myEntities;
+	for (const EnumeratorType ownedType : group.myOwnedTypes)
+	{
+		if (myPools[ownedType].myEntities.Size() < smallestSet->Size())
+		{
+			smallestSet = &myPools[ownedType].myEntities;
+		}
+	}
+
+	for (size_t denseIndex = 0; denseIndex < smallestSet->Size(); ++denseIndex)
+	{
+		const EntityType entity = (*smallestSet)[denseIndex];
+		if (HasAll<ComponentTypes...>(entity))
+		{
+			AddToGroup(group, entity);
+		}
+	}
+
+	return group.mySize;
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline bool BasicComponentRegistry<EntityType>::HasAll(const EntityType & anEntity) const
+{
+	return (myPools[ComponentEnumerator::template type<ComponentTypes>].myEntities.IsValid(anEntity) && ...);
+}
+
+template<class EntityType>
+inline unsigned int BasicComponentRegistry<EntityType>::HighestSetBit(const uint64_t aWord)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, aWord);
+	return static_cast<unsigned int>(index);
+#else
+	return static_cast<unsigned int>(63 - __builtin_clzll(aWord));
+#endif
+}
+
+template<class EntityType>
 template<class ComponentType>
-inline const bool ComponentRegistry::Exists() const
+inline void BasicComponentRegistry<EntityType>::SwapDense(const size_t aFirstIndex, const size_t aSecondIndex)
 {
-	const EnumeratorType typeIndex = ComponentEnumerator::type<ComponentType>;
-	return (typeIndex < myPools.size());
+	if (aFirstIndex == aSecondIndex)
+	{
+		return;
+	}
+
+	EntitySet& entities = myPools[ComponentEnumerator::template type<ComponentType>].myEntities;
+	PoolType<ComponentType>& componentPool = GetPool<ComponentType>();
+
+	entities.Swap(entities[aFirstIndex], entities[aSecondIndex]);
+	std::swap(componentPool[aFirstIndex], componentPool[aSecondIndex]);
+}
+
+template<class EntityType>
+inline void BasicComponentRegistry<EntityType>::AttachToViewsAndGroup(const EnumeratorType aTypeIndex, const EntityType & anEntity)
+{
+	for (const size_t viewIndex : myPools[aTypeIndex].myObservingViews)
+	{
+		CachedView& view = *myViews[viewIndex];
+		if ((this->*view.myMatchFunc)(anEntity))
+		{
+			view.myEntities.Add(anEntity);
+		}
+	}
+
+	const size_t groupIndex = myPools[aTypeIndex].myOwningGroup;
+	if (groupIndex != noGroup)
+	{
+		OwningGroup& group = *myGroups[groupIndex];
+		if ((this->*group.myMatchFunc)(anEntity))
+		{
+			AddToGroup(group, anEntity);
+		}
+	}
 }
 
+template<class EntityType>
+inline void BasicComponentRegistry<EntityType>::DetachFromViewsAndGroup(const EnumeratorType aTypeIndex, const EntityType & anEntity)
+{
+	for (const size_t viewIndex : myPools[aTypeIndex].myObservingViews)
+	{
+		EntitySet& viewEntities = myViews[viewIndex]->myEntities;
+		if (viewEntities.IsValid(anEntity))
+		{
+			viewEntities.RemoveCyclic(anEntity);
+		}
+	}
+
+	const size_t groupIndex = myPools[aTypeIndex].myOwningGroup;
+	if ((groupIndex != noGroup) && IsGrouped(*myGroups[groupIndex], anEntity))
+	{
+		RemoveFromGroup(*myGroups[groupIndex], anEntity);
+	}
+}
+
+template<class EntityType>
+inline bool BasicComponentRegistry<EntityType>::IsGrouped(const OwningGroup & aGroup, const EntityType & anEntity) const
+{
+	const EntityType denseIndex = myPools[aGroup.myOwnedTypes[0]].myEntities.Find(anEntity);
+	return (denseIndex != EntitySet::failureIndex) && (static_cast<size_t>(denseIndex) < aGroup.mySize);
+}
+
+template<class EntityType>
+inline void BasicComponentRegistry<EntityType>::AddToGroup(OwningGroup & aGroup, const EntityType & anEntity)
+{
+	for (const EnumeratorType ownedType : aGroup.myOwnedTypes)
+	{
+		ComponentPool& pool = myPools[ownedType];
+		(this->*pool.mySwapFunc)(pool.myEntities.Find(anEntity), aGroup.mySize);
+	}
+
+	++aGroup.mySize;
+}
+
+template<class EntityType>
+inline void BasicComponentRegistry<EntityType>::RemoveFromGroup(OwningGroup & aGroup, const EntityType & anEntity)
+{
+	--aGroup.mySize;
+
+	for (const EnumeratorType ownedType : aGroup.myOwnedTypes)
+	{
+		ComponentPool& pool = myPools[ownedType];
+		(this->*pool.mySwapFunc)(pool.myEntities.Find(anEntity), aGroup.mySize);
+	}
+}
+
+template<class EntityType>
 template<class ComponentType>
-inline void ComponentRegistry::AssureExistance()
+inline void BasicComponentRegistry<EntityType>::AssureExistance()
 {
 	if (Exists<ComponentType>())
 	{
 		return;
 	}
 
-	const EnumeratorType typeIndex = ComponentEnumerator::type<ComponentType>;
+	const EnumeratorType typeIndex = ComponentEnumerator::template type<ComponentType>;
 
-	myPools.resize(typeIndex + 1);
+	if (myPools.size() <= typeIndex)
+	{
+		myPools.resize(typeIndex + 1);
+	}
 
 	ComponentPool& newPool = myPools[typeIndex];
-	newPool.myComponents = new std::vector<ComponentType>();
+	newPool.myComponents = new PoolType<ComponentType>();
+	newPool.myEntities.EnablePresenceBitmap(true);
 
-	newPool.myRemoveFunc = &ComponentRegistry::Remove<ComponentType>;
-	newPool.myOnDestructFunc = &ComponentRegistry::OnDestruct<ComponentType>;
+	newPool.myRemoveFunc = &BasicComponentRegistry::Remove<ComponentType>;
+	newPool.myRemoveManyFunc = &BasicComponentRegistry::RemoveMany<ComponentType>;
+	newPool.myOnDestructFunc = &BasicComponentRegistry::OnDestruct<ComponentType>;
+	newPool.mySwapFunc = &BasicComponentRegistry::SwapDense<ComponentType>;
 }
 
+template<class EntityType>
 template<class ComponentType>
-inline void ComponentRegistry::OnDestruct()
+inline void BasicComponentRegistry<EntityType>::OnDestruct()
 {
-	std::vector<ComponentType>* componentsToDelete = &GetPool<ComponentType>();
+	PoolType<ComponentType>* componentsToDelete = &GetPool<ComponentType>();
 	delete componentsToDelete;
 }
 
-inline void ComponentRegistry::RemoveAll(const Entity & anEntity)
+template<class EntityType>
+inline void BasicComponentRegistry<EntityType>::RemoveAll(const EntityType & anEntity)
 {
 	for (int i = 0; i < myPools.size(); ++i)
 	{
@@ -159,4 +623,17 @@ inline void ComponentRegistry::RemoveAll(const Entity & anEntity)
 			(this->*currentPool.myRemoveFunc)(anEntity);
 		}
 	}
-}
\ No newline at end of file
+}
+
+template<class EntityType>
+inline void BasicComponentRegistry<EntityType>::RemoveAllMany(const EntityType * someEntities, const size_t aCount)
+{
+	for (ComponentPool& currentPool : myPools)
+	{
+		if (currentPool.myComponents == nullptr)
+			continue;
+
+		//RemoveMany skips entities the pool does not hold.
+		(this->*currentPool.myRemoveManyFunc)(someEntities, aCount);
+	}
+}
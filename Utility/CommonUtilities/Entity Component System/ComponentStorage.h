@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+
+#include "Container/ChunkedVector.h"
+
+/*
+	Selects the container a component pool is stored in, GetPool<T>() returns a reference to it.
+	The default is a std::vector, which is the fastest to iterate but moves every component when it grows.
+	Components that are large or that other code keeps pointers to can opt into chunked storage instead:
+
+		template<>
+		struct ComponentStorage<PhysicsBody> : ChunkedComponentStorage<PhysicsBody> {};
+
+	Chunked pools never reallocate, so a reference returned by Assign stays valid until that component is removed
+	or moved by a removal, group change or sort. Other pools being modified never affects it.
+*/
+
+template<class ComponentType>
+struct ComponentStorage
+{
+	using PoolType = std::vector<ComponentType>;
+};
+
+template<class ComponentType, size_t ChunkBytes = 16 * 1024>
+struct ChunkedComponentStorage
+{
+	using PoolType = CU::ChunkedVector<ComponentType, ChunkBytes>;
+};
@@ -0,0 +1,376 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <assert.h>
+
+#include "TemplateUtility/TemplateUtility.h"
+
+template<class EntityType>
+class BasicEntityRegistry;
+
+/*
+	Records structural changes(Create, Destroy, Assign, Remove) so they can be applied later at a sync point,
+	e.g. after a ForEach pass that must not have the pools it iterates change underneath it.
+	Component payloads are copied into a linear arena of fixed-size blocks that are reused between playbacks.
+
+	Playback applies creates first, then assigns and removes, then destroys. Assigns and removes are sorted by component
+	type so each pool is visited once, and for each entity and component type only the last recorded Assign or Remove is
+	applied, so the outcome matches running the commands in order. Removes and destroys are applied as one batch per pool.
+	Commands aimed at entities that are no longer alive are skipped, Assign on an entity that already owns the component
+	overwrites it and Remove on an entity lacking it does nothing.
+*/
+
+template<class EntityType>
+class BasicEntityCommandBuffer
+{
+public:
+	using RegistryType = BasicEntityRegistry<EntityType>;
+
+	static constexpr size_t arenaBlockSize = 64 * 1024;
+
+	//Placeholder for an entity created by the buffer, resolved to a real handle during Playback.
+	struct PendingEntity
+	{
+		size_t myCreateIndex;
+	};
+
+	BasicEntityCommandBuffer() {}
+	BasicEntityCommandBuffer(BasicEntityCommandBuffer&& aCommandBuffer) = default;
+	~BasicEntityCommandBuffer();
+
+	PendingEntity Create();
+	void Destroy(const EntityType& anEntity);
+
+	template<class ComponentType>
+	void Assign(const EntityType& anEntity, const ComponentType& aComponent = ComponentType());
+
+	template<class ComponentType>
+	void Assign(const PendingEntity& aPendingEntity, const ComponentType& aComponent = ComponentType());
+
+	template<class ComponentType>
+	void Remove(const EntityType& anEntity);
+
+	void Playback(RegistryType& aRegistry);
+	void Clear();
+	bool IsEmpty() const;
+
+	//Handles created by the last Playback, indexed by PendingEntity::myCreateIndex.
+	const std::vector<EntityType>& GetCreatedEntities() const;
+
+private:
+	enum class CommandType : unsigned char
+	{
+		Create,
+		Destroy,
+		Assign,
+		Remove
+	};
+
+	enum class ComponentEnum;
+
+	using ComponentEnumerator = TemplateUtility::TypeFamily<ComponentEnum>;
+
+	struct ComponentCommands
+	{
+		size_t myTypeIndex;
+		void(*myAssignFunc)(RegistryType&, const EntityType&, void*);
+		void(*myRemoveManyFunc)(RegistryType&, const EntityType*, const size_t);
+		void(*myDestroyPayloadFunc)(void*);
+	};
+
+	struct Command
+	{
+		CommandType myType;
+		bool myIsPending;
+		EntityType myEntity;
+		size_t myCreateIndex;
+		const ComponentCommands* myComponent;
+		void* myPayload;
+	};
+
+	struct ArenaBlock
+	{
+		std::unique_ptr<unsigned char[]> myData;
+		size_t mySize;
+	};
+
+	template<class ComponentType>
+	static const ComponentCommands& GetComponentCommands();
+
+	template<class ComponentType>
+	static void AssignPayload(RegistryType& aRegistry, const EntityType& anEntity, void* aPayload);
+
+	template<class ComponentType>
+	static void RemoveMany(RegistryType& aRegistry, const EntityType* someEntities, const size_t aCount);
+
+	template<class ComponentType>
+	static void DestroyPayload(void* aPayload);
+
+	template<class ComponentType>
+	void RecordAssign(const bool anIsPending, const EntityType& anEntity, const size_t aCreateIndex, const ComponentType& aComponent);
+
+	void* Allocate(const size_t aSize, const size_t anAlignment);
+	EntityType Resolve(const Command& aCommand) const;
+	void ApplyComponentCommands(RegistryType& aRegistry);
+	void ApplyDestroys(RegistryType& aRegistry);
+	void DestroyPayloads();
+
+	std::vector<Command> myCommands;
+	std::vector<ArenaBlock> myArenaBlocks;
+	size_t myCurrentBlock = 0;
+	size_t myBlockOffset = 0;
+	size_t myCreateCount = 0;
+
+	std::vector<EntityType> myCreatedEntities;
+	std::vector<const Command*> myBatchCommands;
+	std::vector<EntityType> myBatchEntities;
+};
+
+template<class EntityType>
+inline BasicEntityCommandBuffer<EntityType>::~BasicEntityCommandBuffer()
+{
+	DestroyPayloads();
+}
+
+template<class EntityType>
+inline typename BasicEntityCommandBuffer<EntityType>::PendingEntity BasicEntityCommandBuffer<EntityType>::Create()
+{
+	const PendingEntity pendingEntity = { myCreateCount++ };
+	myCommands.push_back({ CommandType::Create, true, EntityType(), pendingEntity.myCreateIndex, nullptr, nullptr });
+	return pendingEntity;
+}
+
+template<class EntityType>
+inline void BasicEntityCommandBuffer<EntityType>::Destroy(const EntityType & anEntity)
+{
+	myCommands.push_back({ CommandType::Destroy, false, anEntity, 0, nullptr, nullptr });
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::Assign(const EntityType & anEntity, const ComponentType & aComponent)
+{
+	RecordAssign<ComponentType>(false, anEntity, 0, aComponent);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::Assign(const PendingEntity & aPendingEntity, const ComponentType & aComponent)
+{
+	RecordAssign<ComponentType>(true, EntityType(), aPendingEntity.myCreateIndex, aComponent);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::Remove(const EntityType & anEntity)
+{
+	myCommands.push_back({ CommandType::Remove, false, anEntity, 0, &GetComponentCommands<ComponentType>(), nullptr });
+}
+
+template<class EntityType>
+inline void BasicEntityCommandBuffer<EntityType>::Playback(RegistryType & aRegistry)
+{
+	myCreatedEntities.clear();
+	for (const Command& command : myCommands)
+	{
+		if (command.myType == CommandType::Create)
+		{
+			myCreatedEntities.push_back(aRegistry.Create());
+		}
+	}
+
+	ApplyComponentCommands(aRegistry);
+	ApplyDestroys(aRegistry);
+
+	Clear();
+}
+
+template<class EntityType>
+inline void BasicEntityCommandBuffer<EntityType>::Clear()
+{
+	DestroyPayloads();
+	myCommands.clear();
+	myCurrentBlock = 0;
+	myBlockOffset = 0;
+	myCreateCount = 0;
+}
+
+template<class EntityType>
+inline bool BasicEntityCommandBuffer<EntityType>::IsEmpty() const
+{
+	return myCommands.empty();
+}
+
+template<class EntityType>
+inline const std::vector<EntityType>& BasicEntityCommandBuffer<EntityType>::GetCreatedEntities() const
+{
+	return myCreatedEntities;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline const typename BasicEntityCommandBuffer<EntityType>::ComponentCommands& BasicEntityCommandBuffer<EntityType>::GetComponentCommands()
+{
+	static const ComponentCommands commands =
+	{
+		ComponentEnumerator::template type<ComponentType>,
+		&BasicEntityCommandBuffer::AssignPayload<ComponentType>,
+		&BasicEntityCommandBuffer::RemoveMany<ComponentType>,
+		&BasicEntityCommandBuffer::DestroyPayload<ComponentType>
+	};
+	return commands;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::AssignPayload(RegistryType & aRegistry, const EntityType & anEntity, void * aPayload)
+{
+	ComponentType& payload = *static_cast<ComponentType*>(aPayload);
+	const EntityType denseIndex = aRegistry.template Get<ComponentType>().Find(anEntity);
+	if (denseIndex != RegistryType::EntitySet::failureIndex)
+	{
+		aRegistry.template GetPool<ComponentType>()[denseIndex] = std::move(payload);
+	}
+	else
+	{
+		aRegistry.template Assign<ComponentType>(anEntity) = std::move(payload);
+	}
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::RemoveMany(RegistryType & aRegistry, const EntityType * someEntities, const size_t aCount)
+{
+	aRegistry.template RemoveMany<ComponentType>(someEntities, aCount);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::DestroyPayload(void * aPayload)
+{
+	static_cast<ComponentType*>(aPayload)->~ComponentType();
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityCommandBuffer<EntityType>::RecordAssign(const bool anIsPending, const EntityType & anEntity, const size_t aCreateIndex, const ComponentType & aComponent)
+{
+	static_assert(alignof(ComponentType) <= alignof(std::max_align_t), "Over-aligned components can not be stored in the command buffer arena.");
+
+	void* payload = Allocate(sizeof(ComponentType), alignof(ComponentType));
+	new(payload) ComponentType(aComponent);
+	myCommands.push_back({ CommandType::Assign, anIsPending, anEntity, aCreateIndex, &GetComponentCommands<ComponentType>(), payload });
+}
+
+template<class EntityType>
+inline void * BasicEntityCommandBuffer<EntityType>::Allocate(const size_t aSize, const size_t anAlignment)
+{
+	for (;;)
+	{
+		if (myCurrentBlock < myArenaBlocks.size())
+		{
+			ArenaBlock& block = myArenaBlocks[myCurrentBlock];
+			const size_t alignedOffset = (myBlockOffset + anAlignment - 1) & ~(anAlignment - 1);
+			if ((alignedOffset + aSize) <= block.mySize)
+			{
+				myBlockOffset = alignedOffset + aSize;
+				return block.myData.get() + alignedOffset;
+			}
+
+			++myCurrentBlock;
+			myBlockOffset = 0;
+			continue;
+		}
+
+		const size_t blockSize = (std::max)(arenaBlockSize, aSize);
+		myArenaBlocks.push_back({ std::make_unique<unsigned char[]>(blockSize), blockSize });
+	}
+}
+
+template<class EntityType>
+inline EntityType BasicEntityCommandBuffer<EntityType>::Resolve(const Command & aCommand) const
+{
+	return aCommand.myIsPending ? myCreatedEntities[aCommand.myCreateIndex] : aCommand.myEntity;
+}
+
+template<class EntityType>
+inline void BasicEntityCommandBuffer<EntityType>::ApplyComponentCommands(RegistryType & aRegistry)
+{
+	myBatchCommands.clear();
+	for (const Command& command : myCommands)
+	{
+		if ((command.myType == CommandType::Assign) || (command.myType == CommandType::Remove))
+		{
+			myBatchCommands.push_back(&command);
+		}
+	}
+
+	//The stable sort keeps the recorded order within each (type, entity) pair, so the last command of a pair decides its outcome.
+	std::stable_sort(myBatchCommands.begin(), myBatchCommands.end(), [this](const Command* aLHS, const Command* aRHS)
+	{
+		if (aLHS->myComponent->myTypeIndex != aRHS->myComponent->myTypeIndex)
+			return aLHS->myComponent->myTypeIndex < aRHS->myComponent->myTypeIndex;
+		return Resolve(*aLHS) < Resolve(*aRHS);
+	});
+
+	for (size_t runBegin = 0; runBegin < myBatchCommands.size();)
+	{
+		const ComponentCommands& component = *myBatchCommands[runBegin]->myComponent;
+
+		myBatchEntities.clear();
+		size_t runEnd = runBegin;
+		for (; (runEnd < myBatchCommands.size()) && (myBatchCommands[runEnd]->myComponent == &component); ++runEnd)
+		{
+			const Command& command = *myBatchCommands[runEnd];
+			const EntityType entity = Resolve(command);
+			const bool isLastOfEntity = ((runEnd + 1) == myBatchCommands.size()) || (myBatchCommands[runEnd + 1]->myComponent != &component) || (Resolve(*myBatchCommands[runEnd + 1]) != entity);
+			if (!isLastOfEntity || !aRegistry.IsValid(entity))
+				continue;
+
+			if (command.myType == CommandType::Assign)
+			{
+				component.myAssignFunc(aRegistry, entity, command.myPayload);
+			}
+			else
+			{
+				myBatchEntities.push_back(entity);
+			}
+		}
+
+		component.myRemoveManyFunc(aRegistry, myBatchEntities.data(), myBatchEntities.size());
+		runBegin = runEnd;
+	}
+}
+
+template<class EntityType>
+inline void BasicEntityCommandBuffer<EntityType>::ApplyDestroys(RegistryType & aRegistry)
+{
+	myBatchEntities.clear();
+	for (const Command& command : myCommands)
+	{
+		if (command.myType == CommandType::Destroy)
+		{
+			myBatchEntities.push_back(command.myEntity);
+		}
+	}
+
+	std::sort(myBatchEntities.begin(), myBatchEntities.end());
+	myBatchEntities.erase(std::unique(myBatchEntities.begin(), myBatchEntities.end()), myBatchEntities.end());
+	myBatchEntities.erase(std::remove_if(myBatchEntities.begin(), myBatchEntities.end(), [&aRegistry](const EntityType& anEntity) { return !aRegistry.IsValid(anEntity); }), myBatchEntities.end());
+
+	aRegistry.DestroyMany(myBatchEntities.data(), myBatchEntities.size());
+}
+
+template<class EntityType>
+inline void BasicEntityCommandBuffer<EntityType>::DestroyPayloads()
+{
+	for (const Command& command : myCommands)
+	{
+		if (command.myPayload != nullptr)
+		{
+			command.myComponent->myDestroyPayloadFunc(command.myPayload);
+		}
+	}
+}
@@ -1,117 +1,407 @@
 #pragma once
 #include "ComponentRegistry.h"
-#include <queue>
+#include "EntityCommandBuffer.h"
+#include "Threading/ThreadPool.h"
+#include <vector>
 #include <array>
+#include <tuple>
+#include <algorithm>
 #include <assert.h>
 
-class EntityRegistry
+/*
+	Entities are versioned handles(see EntityTraits). Every slot ever handed out has an entry in myEntitySlots:
+	a live slot stores the exact handle of its entity, a free slot stores the index of the next free slot
+	combined with the version the slot will be reused with. Free slots thereby form an intrusive list and
+	IsValid is a single load and compare against the handle.
+*/
+
+enum class ExecutionPolicy
+{
+	Sequential,
+	Parallel
+};
+
+template<class EntityType>
+class BasicEntityRegistry
 {
 public:
-	EntityRegistry();
-	~EntityRegistry();
+	using Traits = EntityTraits<EntityType>;
+	using EntitySet = typename BasicComponentRegistry<EntityType>::EntitySet;
+	using CommandBuffer = BasicEntityCommandBuffer<EntityType>;
+
+	template<class ComponentType>
+	using PoolType = typename BasicComponentRegistry<EntityType>::template PoolType<ComponentType>;
+
+	static constexpr size_t forEachChunkBytes = 16 * 1024;//Component bytes touched per ForEach chunk, sized to stay in L1.
+
+	static constexpr EntityType null = Traits::null;
+
+	BasicEntityRegistry();
+	~BasicEntityRegistry();
+
+	const EntityType Create();
+	//Creates aCount entities into someEntitiesOut, recycled slots first. The slot array grows once for the batch.
+	void CreateMany(const size_t aCount, EntityType* someEntitiesOut);
+	//CreateMany followed by one AssignMany per component type, each new entity gets a copy of someValues.
+	template<class ... ComponentTypes>
+	void SpawnMany(const size_t aCount, EntityType* someEntitiesOut, const ComponentTypes& ... someValues);
+	void Destroy(const EntityType& anEntity);
+	//Destroys a batch of live entities, components are removed with one RemoveMany per pool.
+	void DestroyMany(const EntityType* someEntities, const size_t aCount);
+
+	bool IsValid(const EntityType& anEntity) const;
+	const size_t Size() const;
+
+	template<class ComponentType>
+	ComponentType& Assign(const EntityType& anEntity);
+
+	//Batched Assign, see BasicComponentRegistry::AssignMany and AssignManyGenerated.
+	template<class ComponentType>
+	void AssignMany(const EntityType* someEntities, const size_t aCount, const ComponentType& aValue = ComponentType());
 
-	const Entity Create();
-	void Destroy(const Entity& anEntity);
+	template<class ComponentType, class Generator>
+	void AssignManyGenerated(const EntityType* someEntities, const size_t aCount, const Generator& aGenerator);
 
 	template<class ComponentType>
-	ComponentType& Assign(const Entity& anEntity);
+	void Remove(const EntityType& anEntity);
 
+	//Order-preserving Remove, see BasicComponentRegistry::RemoveOrdered.
 	template<class ComponentType>
-	void Remove(const Entity& anEntity);
+	void RemoveOrdered(const EntityType& anEntity);
 
 	template<class ComponentType>
-	const CU::SparseSet<Entity>& Get();
+	void RemoveMany(const EntityType* someEntities, const size_t aCount);
 
+	template<class ComponentType>
+	const EntitySet& Get();
+
+	template<class ComponentType>
+	PoolType<ComponentType>& GetPool();
+
+	template<class ... ComponentTypes>
+	void Collection(EntitySet& someEntitiesOut);
+
+	//Entities owning every one of ComponentTypes written to a reusable buffer, see SparseSet::Intersection. The order is unspecified.
+	template<class ... ComponentTypes>
+	void Collection(std::vector<EntityType>& someEntitiesOut);
+
+	//Persistent, incrementally maintained Collection. See BasicComponentRegistry::View.
 	template<class ... ComponentTypes>
-	void Collection(CU::SparseSet<Entity>& someEntitiesOut);
+	const EntitySet& View();
+
+	//Owning group, see BasicComponentRegistry::Group.
+	template<class ... ComponentTypes>
+	const size_t Group();
+
+	/*
+		Calls aFunction(entity, components&...) for every entity owning all ComponentTypes. The dense range of the
+		smallest participating pool drives the pass and is split into cache-sized chunks. With ExecutionPolicy::Parallel
+		the chunks run on aThreadPool(the default pool when nullptr), writes to the passed components are safe as every entity belongs to one chunk.
+		Structural changes must go through Defer() during the pass, the command buffers are flushed when it ends.
+	*/
+	template<class ... ComponentTypes, class Function>
+	void ForEach(const Function& aFunction, const ExecutionPolicy aPolicy = ExecutionPolicy::Sequential, CU::ThreadPool* aThreadPool = nullptr);
+
+	//Command buffer of the calling thread, safe to record into from inside a parallel ForEach.
+	CommandBuffer& Defer();
+	void FlushCommandBuffers();
 
 private:
-	ComponentRegistry myComponentRegistry;
-	Entity myEntityCounter;
-	std::queue<Entity> myEntityReuseQueue;
+	template<class ... ComponentTypes, class Function, size_t ... TypeIndices>
+	void ForEachInRange(const Function& aFunction, const EntitySet& aDrivingSet, const size_t aBegin, const size_t anEnd,
+		const std::array<const EntitySet*, sizeof...(ComponentTypes)>& someComponentSets, const std::tuple<PoolType<ComponentTypes>*...>& someComponentPools,
+		const std::index_sequence<TypeIndices...>&);
 
-	CU::SparseSet<Entity> myInUseEntities;
+	BasicComponentRegistry<EntityType> myComponentRegistry;
+	std::vector<EntityType> myEntitySlots;
+	EntityType myFreeListHead;
+	size_t myAliveCount;
+	std::vector<CommandBuffer> myCommandBuffers;
+	std::vector<EntityType> myCollectionBuffer;
 };
 
-EntityRegistry::EntityRegistry()
+using EntityRegistry = BasicEntityRegistry<Entity>;
+
+template<class EntityType>
+inline BasicEntityRegistry<EntityType>::BasicEntityRegistry() : myFreeListHead(Traits::nullIndex), myAliveCount(0), myCommandBuffers(1)
 {
 }
 
-inline EntityRegistry::~EntityRegistry()
+//Components are released along with their pools by the component registry, removing them entity by entity first is wasted work.
+template<class EntityType>
+inline BasicEntityRegistry<EntityType>::~BasicEntityRegistry()
 {
-	for (size_t index = 0; index < myInUseEntities.Size(); ++index)
-	{
-		myComponentRegistry.RemoveAll(myInUseEntities[index]);
-	}
 }
 
-inline const Entity EntityRegistry::Create()
+template<class EntityType>
+inline const EntityType BasicEntityRegistry<EntityType>::Create()
 {
-	Entity entity;
+	EntityType entity;
 
-	if (!myEntityReuseQueue.empty())
+	if (myFreeListHead != Traits::nullIndex)
 	{
-		entity = myEntityReuseQueue.front();
-		myEntityReuseQueue.pop();
+		const EntityType index = myFreeListHead;
+		const EntityType freeSlot = myEntitySlots[index];
+		myFreeListHead = Traits::ToIndex(freeSlot);
+
+		entity = Traits::Combine(index, Traits::ToVersion(freeSlot));
+		myEntitySlots[index] = entity;
 	}
 	else
 	{
-		entity = myEntityCounter++;
-	}
+		const EntityType index = static_cast<EntityType>(myEntitySlots.size());
+		assert(index < Traits::nullIndex && "EntityRegistry is out of entity indices, use a wider entity type.");
 
-	myInUseEntities.Add(entity);
+		entity = Traits::Combine(index, 0);
+		myEntitySlots.push_back(entity);
+	}
 
+	++myAliveCount;
 	return entity;
 }
 
-inline void EntityRegistry::Destroy(const Entity & anEntity)
+template<class EntityType>
+inline void BasicEntityRegistry<EntityType>::CreateMany(const size_t aCount, EntityType * someEntitiesOut)
+{
+	size_t createdCount = 0;
+	for (; (createdCount < aCount) && (myFreeListHead != Traits::nullIndex); ++createdCount)
+	{
+		someEntitiesOut[createdCount] = Create();
+	}
+
+	const size_t remainingCount = aCount - createdCount;
+	const size_t firstIndex = myEntitySlots.size();
+	assert((firstIndex + remainingCount) <= Traits::nullIndex && "EntityRegistry is out of entity indices, use a wider entity type.");
+
+	myEntitySlots.resize(firstIndex + remainingCount);
+	for (size_t index = firstIndex; index < myEntitySlots.size(); ++index)
+	{
+		const EntityType entity = Traits::Combine(static_cast<EntityType>(index), 0);
+		myEntitySlots[index] = entity;
+		someEntitiesOut[createdCount++] = entity;
+	}
+
+	myAliveCount += remainingCount;
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline void BasicEntityRegistry<EntityType>::SpawnMany(const size_t aCount, EntityType * someEntitiesOut, const ComponentTypes & ...someValues)
+{
+	CreateMany(aCount, someEntitiesOut);
+	(myComponentRegistry.template AssignMany<ComponentTypes>(someEntitiesOut, aCount, someValues), ...);
+}
+
+template<class EntityType>
+inline void BasicEntityRegistry<EntityType>::Destroy(const EntityType & anEntity)
 {
+	assert(IsValid(anEntity) && "Tried to destroy an entity that is not alive.");
 	myComponentRegistry.RemoveAll(anEntity);
-	myEntityReuseQueue.emplace(anEntity);
-	
-	myInUseEntities.RemoveCyclic(anEntity);
+
+	const EntityType index = Traits::ToIndex(anEntity);
+	const EntityType nextVersion = static_cast<EntityType>(Traits::ToVersion(anEntity) + 1);
+	myEntitySlots[index] = Traits::Combine(myFreeListHead, nextVersion);
+	myFreeListHead = index;
+
+	--myAliveCount;
+}
+
+template<class EntityType>
+inline void BasicEntityRegistry<EntityType>::DestroyMany(const EntityType * someEntities, const size_t aCount)
+{
+	myComponentRegistry.RemoveAllMany(someEntities, aCount);
+
+	for (size_t entityIndex = 0; entityIndex < aCount; ++entityIndex)
+	{
+		const EntityType entity = someEntities[entityIndex];
+		assert(IsValid(entity) && "Tried to destroy an entity that is not alive.");
+
+		const EntityType index = Traits::ToIndex(entity);
+		const EntityType nextVersion = static_cast<EntityType>(Traits::ToVersion(entity) + 1);
+		myEntitySlots[index] = Traits::Combine(myFreeListHead, nextVersion);
+		myFreeListHead = index;
+	}
+
+	myAliveCount -= aCount;
+}
+
+template<class EntityType>
+inline bool BasicEntityRegistry<EntityType>::IsValid(const EntityType & anEntity) const
+{
+	const size_t index = Traits::ToIndex(anEntity);
+	return (index < myEntitySlots.size()) && (myEntitySlots[index] == anEntity);
 }
 
+template<class EntityType>
+inline const size_t BasicEntityRegistry<EntityType>::Size() const
+{
+	return myAliveCount;
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline ComponentType& BasicEntityRegistry<EntityType>::Assign(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && "Tried to assign a component to an entity that is not alive.");
+	return myComponentRegistry.template Assign<ComponentType>(anEntity);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityRegistry<EntityType>::AssignMany(const EntityType * someEntities, const size_t aCount, const ComponentType & aValue)
+{
+	assert(std::all_of(someEntities, someEntities + aCount, [this](const EntityType& anEntity) { return IsValid(anEntity); }) && "Tried to assign a component to an entity that is not alive.");
+	myComponentRegistry.template AssignMany<ComponentType>(someEntities, aCount, aValue);
+}
+
+template<class EntityType>
+template<class ComponentType, class Generator>
+inline void BasicEntityRegistry<EntityType>::AssignManyGenerated(const EntityType * someEntities, const size_t aCount, const Generator & aGenerator)
+{
+	assert(std::all_of(someEntities, someEntities + aCount, [this](const EntityType& anEntity) { return IsValid(anEntity); }) && "Tried to assign a component to an entity that is not alive.");
+	myComponentRegistry.template AssignManyGenerated<ComponentType>(someEntities, aCount, aGenerator);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityRegistry<EntityType>::Remove(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && "Tried to remove a component from an entity that is not alive.");
+	myComponentRegistry.template Remove<ComponentType>(anEntity);
+}
+
+template<class EntityType>
+template<class ComponentType>
+inline void BasicEntityRegistry<EntityType>::RemoveOrdered(const EntityType & anEntity)
+{
+	assert(IsValid(anEntity) && "Tried to remove a component from an entity that is not alive.");
+	myComponentRegistry.template RemoveOrdered<ComponentType>(anEntity);
+}
+
+template<class EntityType>
 template<class ComponentType>
-inline ComponentType& EntityRegistry::Assign(const Entity & anEntity)
+inline void BasicEntityRegistry<EntityType>::RemoveMany(const EntityType * someEntities, const size_t aCount)
 {
-	return myComponentRegistry.Assign<ComponentType>(anEntity);
+	myComponentRegistry.template RemoveMany<ComponentType>(someEntities, aCount);
 }
 
+template<class EntityType>
 template<class ComponentType>
-inline void EntityRegistry::Remove(const Entity & anEntity)
+inline const typename BasicEntityRegistry<EntityType>::EntitySet& BasicEntityRegistry<EntityType>::Get()
 {
-	myComponentRegistry.Remove<ComponentType>(anEntity);
+	return myComponentRegistry.template GetEntities<ComponentType>();
 }
 
+template<class EntityType>
 template<class ComponentType>
-inline const CU::SparseSet<Entity>& EntityRegistry::Get()
+inline typename BasicEntityRegistry<EntityType>::template PoolType<ComponentType>& BasicEntityRegistry<EntityType>::GetPool()
+{
+	return myComponentRegistry.template GetPool<ComponentType>();
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline const size_t BasicEntityRegistry<EntityType>::Group()
+{
+	return myComponentRegistry.template Group<ComponentTypes...>();
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline const typename BasicEntityRegistry<EntityType>::EntitySet& BasicEntityRegistry<EntityType>::View()
 {
-	return myComponentRegistry.GetEntities<ComponentType>();
+	return myComponentRegistry.template View<ComponentTypes...>();
 }
 
+template<class EntityType>
 template<class ...ComponentTypes>
-inline void EntityRegistry::Collection(CU::SparseSet<Entity>& someEntitiesOut)
+inline void BasicEntityRegistry<EntityType>::Collection(EntitySet& someEntitiesOut)
 {
-	if constexpr (sizeof...(ComponentTypes) == 1)
+	Collection<ComponentTypes...>(myCollectionBuffer);
+	someEntitiesOut.Clear();
+	someEntitiesOut.AddMany(myCollectionBuffer.data(), myCollectionBuffer.size());
+}
+
+template<class EntityType>
+template<class ...ComponentTypes>
+inline void BasicEntityRegistry<EntityType>::Collection(std::vector<EntityType>& someEntitiesOut)
+{
+	const std::array<const EntitySet*, sizeof...(ComponentTypes)> componentSets = { &Get<ComponentTypes>()... };
+	EntitySet::Intersection(componentSets.data(), componentSets.size(), someEntitiesOut);
+}
+
+template<class EntityType>
+template<class ...ComponentTypes, class Function>
+inline void BasicEntityRegistry<EntityType>::ForEach(const Function & aFunction, const ExecutionPolicy aPolicy, CU::ThreadPool * aThreadPool)
+{
+	const std::array<const EntitySet*, sizeof...(ComponentTypes)> componentSets = { &Get<ComponentTypes>()... };
+	const std::tuple<PoolType<ComponentTypes>*...> componentPools = { &GetPool<ComponentTypes>()... };
+	const EntitySet& drivingSet = **std::min_element(componentSets.begin(), componentSets.end(), [](const EntitySet* aLHS, const EntitySet* aRHS) { return aLHS->Size() < aRHS->Size(); });
+
+	const size_t entityCount = drivingSet.Size();
+	const size_t componentBytes = (sizeof(ComponentTypes) + ...);
+	const size_t chunkSize = (std::max)(static_cast<size_t>(1), forEachChunkBytes / componentBytes);
+	const size_t chunkCount = (entityCount + chunkSize - 1) / chunkSize;
+
+	auto runChunk = [&](const size_t aChunkIndex)
+	{
+		const size_t begin = aChunkIndex * chunkSize;
+		const size_t end = (std::min)(begin + chunkSize, entityCount);
+		ForEachInRange<ComponentTypes...>(aFunction, drivingSet, begin, end, componentSets, componentPools, std::index_sequence_for<ComponentTypes...>{});
+	};
+
+	if (aPolicy == ExecutionPolicy::Parallel)
 	{
-		someEntitiesOut = Get<ComponentTypes...>();
+		CU::ThreadPool& threadPool = CU::ThreadPool::GetOrDefault(aThreadPool);
+		if (myCommandBuffers.size() < threadPool.GetParticipantCount())
+		{
+			myCommandBuffers.resize(threadPool.GetParticipantCount());
+		}
+		threadPool.ParallelFor(chunkCount, runChunk);
 	}
 	else
 	{
-		std::array<const CU::SparseSet<Entity>*, sizeof...(ComponentTypes)> componentCollection = { &Get<ComponentTypes>()... };
-
-		std::sort(componentCollection.begin(), componentCollection.end(), [](const CU::SparseSet<Entity>* aLHS, const CU::SparseSet<Entity>* aRHS) { return aLHS->Size() < aRHS->Size(); });
-
-		const CU::SparseSet<Entity>& first = *componentCollection[0];
-		const CU::SparseSet<Entity>& second = *componentCollection[1];
+		for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+		{
+			runChunk(chunkIndex);
+		}
+	}
 
-		first.Intersection(second, someEntitiesOut);
+	FlushCommandBuffers();
+}
 
-		for (size_t index = 2; index < (sizeof...(ComponentTypes)); ++index)
+template<class EntityType>
+template<class ...ComponentTypes, class Function, size_t ...TypeIndices>
+inline void BasicEntityRegistry<EntityType>::ForEachInRange(const Function & aFunction, const EntitySet & aDrivingSet, const size_t aBegin, const size_t anEnd,
+	const std::array<const EntitySet*, sizeof...(ComponentTypes)>& someComponentSets, const std::tuple<PoolType<ComponentTypes>*...>& someComponentPools,
+	const std::index_sequence<TypeIndices...>&)
+{
+	for (size_t denseIndex = aBegin; denseIndex < anEnd; ++denseIndex)
+	{
+		const EntityType entity = aDrivingSet[denseIndex];
+		const std::array<EntityType, sizeof...(ComponentTypes)> componentIndices = { someComponentSets[TypeIndices]->Find(entity)... };
+		if (((componentIndices[TypeIndices] == EntitySet::failureIndex) || ...))
 		{
-			const CU::SparseSet<Entity>& intersectingSet = *componentCollection[index];
-			someEntitiesOut.ReduceToIntersection(intersectingSet);
+			continue;
 		}
+
+		aFunction(entity, (*std::get<TypeIndices>(someComponentPools))[componentIndices[TypeIndices]]...);
+	}
+}
+
+template<class EntityType>
+inline typename BasicEntityRegistry<EntityType>::CommandBuffer& BasicEntityRegistry<EntityType>::Defer()
+{
+	const unsigned int participantIndex = CU::ThreadPool::GetCurrentParticipantIndex();
+	assert(participantIndex < myCommandBuffers.size() && "No command buffer for this thread, Defer is meant for use inside ForEach.");
+	return myCommandBuffers[participantIndex];
+}
+
+template<class EntityType>
+inline void BasicEntityRegistry<EntityType>::FlushCommandBuffers()
+{
+	for (CommandBuffer& commandBuffer : myCommandBuffers)
+	{
+		commandBuffer.Playback(*this);
 	}
 }
@@ -0,0 +1,62 @@
+#pragma once
+#include <limits>
+
+/*
+	Entity handles pack a slot index into the low bits and a version into the remaining high bits.
+	The version is bumped every time a slot is recycled, so a handle to a destroyed entity never compares
+	equal to the handle of the entity that later reuses its slot.
+	The all-ones index is reserved, which makes the all-ones handle(null) invalid for every version.
+*/
+
+template<class EntityType, unsigned int IndexBits>
+struct EntityTraitsBase
+{
+	static_assert(IndexBits < std::numeric_limits<EntityType>::digits, "Entity handles need at least one version bit.");
+
+	static constexpr unsigned int indexBits = IndexBits;
+	static constexpr EntityType indexMask = static_cast<EntityType>((static_cast<EntityType>(1) << IndexBits) - 1);
+	static constexpr EntityType versionMask = static_cast<EntityType>(std::numeric_limits<EntityType>::max() >> IndexBits);
+	static constexpr EntityType nullIndex = indexMask;
+	static constexpr EntityType null = std::numeric_limits<EntityType>::max();
+
+	static constexpr EntityType ToIndex(const EntityType anEntity)
+	{
+		return static_cast<EntityType>(anEntity & indexMask);
+	}
+
+	static constexpr EntityType ToVersion(const EntityType anEntity)
+	{
+		return static_cast<EntityType>(anEntity >> IndexBits);
+	}
+
+	static constexpr EntityType Combine(const EntityType anIndex, const EntityType aVersion)
+	{
+		return static_cast<EntityType>((anIndex & indexMask) | ((aVersion & versionMask) << IndexBits));
+	}
+};
+
+template<class EntityType>
+struct EntityTraits;
+
+template<>
+struct EntityTraits<unsigned short> : EntityTraitsBase<unsigned short, 12> {};//4095 entities, 16 versions per slot.
+
+template<>
+struct EntityTraits<unsigned int> : EntityTraitsBase<unsigned int, 20> {};//1048575 entities, 4096 versions per slot.
+
+template<>
+struct EntityTraits<unsigned long long> : EntityTraitsBase<unsigned long long, 32> {};
+
+//Sparse set indexer for entity handles, the sparse side is addressed by slot index only so versions do not spread the pages.
+template<class EntityType>
+struct EntitySparseIndex
+{
+	static constexpr bool isIdentity = false;
+
+	static constexpr EntityType ToSparse(const EntityType anEntity)
+	{
+		return EntityTraits<EntityType>::ToIndex(anEntity);
+	}
+};
+
+typedef unsigned int Entity;
@@ -3,8 +3,25 @@
 #include "StopWatch.h"
 #include <vector>
 #include <iostream>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <cstdint>
 #include "Container/SoAC.h"
 #include "Container/SoACUtilities.h"
+#include "Container/IntroSort.h"
+#include "Container/SoACParallelSort.h"
+#include "Container/ColumnKernels.h"
+#include "Container/SparseSet.h"
+#include "Container/SparseVector.h"
+#include "Container/ConcurrentSparseSet.h"
+#include "Container/HashedSparseStorage.h"
+#include "Entity Component System/EntityRegistry.h"
+#include "Entity Component System/ArchetypeRegistry.h"
 #include "Math/CommonMath.h"
 #include "TemplateUtility/TypeInformation.h"
 
@@ -158,10 +175,10 @@ void ValidateSort(const CU::SoAC<TypeList...>& aSortedVector, const PredSigType&
 	using PredicateType = TemplateUtility::ChooseType<PredicateIndex, TypeList...>;
 	for (size_t i = 0; i < aSortedVector.Size() - 1; ++i)
 	{
-		const PredicateType& outer = aSortedVector.Get<PredicateIndex>(i);
+		const PredicateType& outer = aSortedVector.template Get<PredicateIndex>(i);
 		for (size_t j = i + 1; j < aSortedVector.Size(); ++j)
 		{
-			const PredicateType& inner = aSortedVector.Get<PredicateIndex>(j);
+			const PredicateType& inner = aSortedVector.template Get<PredicateIndex>(j);
 			bool predicatePassed = aPredicate(outer, inner);
 			bool inversePredicatePassed = aPredicate(inner, outer);
 			bool wereEqual = (!predicatePassed) && (!inversePredicatePassed);
@@ -199,6 +216,20 @@ namespace SoACSortTests
 		
 		ValidateSort<0>(soacA, predicateLite);
 		auto soACTime = s.Time().count();
+
+		//Only the key column is sorted directly, every float has to end up next to the int it was added with.
+		const auto byIntThenFloat = [](const IntFloat& aLHS, const IntFloat& aRHS) { return (aLHS.i < aRHS.i) || ((aLHS.i == aRHS.i) && (aLHS.f < aRHS.f)); };
+		std::vector<IntFloat> sortedPairs;
+		for (size_t index = 0; index < soacA.Size(); ++index)
+		{
+			sortedPairs.push_back(IntFloat(soacA.Get<0>(index), soacA.Get<1>(index)));
+		}
+		std::sort(sortedPairs.begin(), sortedPairs.end(), byIntThenFloat);
+		std::sort(vecIntro.begin(), vecIntro.end(), byIntThenFloat);
+		for (size_t index = 0; index < vecIntro.size(); ++index)
+		{
+			assert(sortedPairs[index].i == vecIntro[index].i && sortedPairs[index].f == vecIntro[index].f && "SoAC sort separated a column from its key.");
+		}
 		std::cout << "SoAC intro sort: " << soACTime << "\n";
 		
 		s.Start();
@@ -213,6 +244,1996 @@ namespace SoACSortTests
 		std::cout << " SoAC / std::sort : " << percentDiff2 << ".\n";
 		
 	}
+
+	struct SortKey32
+	{
+		long long myKey;
+		long long myPayload[3];
+	};
+
+	//Sorts copies of someValues with std::sort, CU::IntroSort given a type erased CU::SortPredicate and CU::IntroSort given the lambda itself.
+	template<class T, class Compare>
+	inline void MeasureComparatorSort(const char* aKeyName, const std::vector<T>& someValues, const Compare& aCompare)
+	{
+		std::vector<T> stdSorted = someValues;
+		std::vector<T> erasedSorted = someValues;
+		std::vector<T> templateSorted = someValues;
+		CU::StopWatch s;
+
+		s.Start();
+		std::sort(stdSorted.begin(), stdSorted.end(), aCompare);
+		s.Stop();
+		const long long stdTime = s.Time().count();
+
+		const CU::SortPredicate<T> erasedCompare = aCompare;
+		s.Start();
+		CU::IntroSort(erasedSorted, 0, erasedSorted.size(), erasedCompare);
+		s.Stop();
+		const long long erasedTime = s.Time().count();
+
+		s.Start();
+		CU::IntroSort(templateSorted, 0, templateSorted.size(), aCompare);
+		s.Stop();
+		const long long templateTime = s.Time().count();
+
+		const bool erasedIsSorted = std::is_sorted(erasedSorted.begin(), erasedSorted.end(), aCompare);
+		const bool templateIsSorted = std::is_sorted(templateSorted.begin(), templateSorted.end(), aCompare);
+		assert(erasedIsSorted && templateIsSorted && "CU::IntroSort left the range unsorted.");
+		erasedIsSorted, templateIsSorted;
+
+		std::cout << aKeyName << " keys, IntroSort / std::sort: std::function " << static_cast<double>(erasedTime) / (std::max)(stdTime, 1ll)
+			<< " template " << static_cast<double>(templateTime) / (std::max)(stdTime, 1ll) << "\n";
+	}
+
+	//Comparator cost of CU::IntroSort and ISort with and without std::function, against std::sort.
+	inline void ComparatorInliningBenchmark()
+	{
+		const size_t elementCount = 200'000;
+		std::mt19937 generator(11);
+		std::vector<int> ints(elementCount);
+		std::vector<float> floats(elementCount);
+		std::vector<SortKey32> structs(elementCount);
+		for (size_t index = 0; index < elementCount; ++index)
+		{
+			ints[index] = static_cast<int>(generator());
+			floats[index] = std::uniform_real_distribution<float>(-1000.f, 1000.f)(generator);
+			structs[index] = SortKey32{ static_cast<long long>(generator()), { 0, 0, 0 } };
+		}
+
+		MeasureComparatorSort("int", ints, [](const int aLHS, const int aRHS) { return aLHS < aRHS; });
+		MeasureComparatorSort("float", floats, [](const float aLHS, const float aRHS) { return aLHS < aRHS; });
+		MeasureComparatorSort("32-byte struct", structs, [](const SortKey32& aLHS, const SortKey32& aRHS) { return aLHS.myKey < aRHS.myKey; });
+
+		CU::SoAC<int, float> erasedRows;
+		CU::SoAC<int, float> templateRows;
+		for (size_t index = 0; index < elementCount; ++index)
+		{
+			erasedRows.Add(ints[index], floats[index]);
+			templateRows.Add(ints[index], floats[index]);
+		}
+
+		const auto rowPredicate = [](const auto& aLHS, const auto& aRHS) { return std::get<0>(aLHS) < std::get<0>(aRHS); };
+		const CU::ISort<int, float>::PredicateSignature erasedRowPredicate = rowPredicate;
+		CU::StopWatch s;
+		s.Start();
+		CU::ISort<int, float>(erasedRows, 0, erasedRows.Size(), erasedRowPredicate);
+		s.Stop();
+		const long long erasedTime = s.Time().count();
+
+		s.Start();
+		CU::ISort<int, float>(templateRows, 0, templateRows.Size(), rowPredicate);
+		s.Stop();
+		const long long templateTime = s.Time().count();
+
+		for (size_t index = 1; index < elementCount; ++index)
+		{
+			assert(!(templateRows.Get<0>(index) < templateRows.Get<0>(index - 1)) && !(erasedRows.Get<0>(index) < erasedRows.Get<0>(index - 1)) && "ISort left the rows unsorted.");
+		}
+		std::cout << "ISort SoAC<int, float> rows, std::function: " << erasedTime << " template: " << templateTime << "\n";
+	}
+
+	//Sorts (key, original position) rows with ParallelSort and RadixSort on aThreadPool and checks the order and that every row stayed together.
+	template<class KeyType>
+	inline void ValidateParallelSort(const std::vector<KeyType>& someKeys, const size_t aFirst, const size_t aLast, CU::ThreadPool& aThreadPool)
+	{
+		CU::SoAC<KeyType, unsigned int> sampleSorted;
+		CU::SoAC<KeyType, unsigned int> radixSorted;
+		for (size_t index = 0; index < someKeys.size(); ++index)
+		{
+			sampleSorted.Add(someKeys[index], static_cast<unsigned int>(index));
+			radixSorted.Add(someKeys[index], static_cast<unsigned int>(index));
+		}
+
+		CU::ParallelSort<0>(sampleSorted, aFirst, aLast, [](const KeyType aLHS, const KeyType aRHS) { return aLHS < aRHS; }, &aThreadPool);
+		CU::RadixSort<0>(radixSorted, aFirst, aLast, &aThreadPool);
+
+		std::vector<KeyType> expected(someKeys.begin() + aFirst, someKeys.begin() + aLast);
+		std::sort(expected.begin(), expected.end());
+		for (size_t index = 0; index < someKeys.size(); ++index)
+		{
+			const bool isInRange = (aFirst <= index) && (index < aLast);
+			const KeyType expectedKey = isInRange ? expected[index - aFirst] : someKeys[index];
+			assert(sampleSorted.template Get<0>(index) == expectedKey && radixSorted.template Get<0>(index) == expectedKey && "Parallel SoAC sort produced a wrong key order.");
+			assert(someKeys[sampleSorted.template Get<1>(index)] == sampleSorted.template Get<0>(index) && someKeys[radixSorted.template Get<1>(index)] == radixSorted.template Get<0>(index)
+				&& "Parallel SoAC sort separated a column from its key.");
+			assert((!isInRange || (index == aFirst) || (radixSorted.template Get<0>(index - 1) != expectedKey) || (radixSorted.template Get<1>(index - 1) < radixSorted.template Get<1>(index)))
+				&& "RadixSort is not stable.");
+			expectedKey;
+		}
+	}
+
+	//Render queue sized sort: ISortLite against ParallelSort and RadixSort on 2M 32-bit draw keys with mesh and depth columns.
+	inline void ParallelSortBenchmark()
+	{
+		std::mt19937 generator(13);
+		CU::ThreadPool threadPool(3);
+		std::vector<int> signedKeys(200'000);
+		std::vector<float> floatKeys(200'000);
+		std::vector<unsigned long long> wideKeys(200'000);
+		for (size_t index = 0; index < signedKeys.size(); ++index)
+		{
+			signedKeys[index] = static_cast<int>(generator() % 2001) - 1000;
+			floatKeys[index] = (index % 7 == 0) ? -0.f : std::uniform_real_distribution<float>(-1e6f, 1e6f)(generator);
+			wideKeys[index] = (static_cast<unsigned long long>(generator()) << 32) | generator();
+		}
+		ValidateParallelSort(signedKeys, 0, signedKeys.size(), threadPool);
+		ValidateParallelSort(signedKeys, 1000, signedKeys.size() - 1000, threadPool);
+		ValidateParallelSort(wideKeys, 0, wideKeys.size(), threadPool);
+		ValidateParallelSort(std::vector<int>(signedKeys.begin(), signedKeys.begin() + 100), 0, 100, threadPool);
+
+		//-0.0f and 0.0f compare equal but RadixSort orders them by their bits, so float keys are checked against the predicate only.
+		CU::SoAC<float> floatRows;
+		for (const float key : floatKeys)
+		{
+			floatRows.Add(key);
+		}
+		CU::RadixSort<0>(floatRows, 0, floatRows.Size(), &threadPool);
+		for (size_t index = 1; index < floatRows.Size(); ++index)
+		{
+			assert(!(floatRows.Get<0>(index) < floatRows.Get<0>(index - 1)) && "RadixSort misordered float keys.");
+		}
+
+		const size_t drawCount = 2'000'000;
+		CU::SoAC<unsigned int, unsigned int, float> introQueue;
+		for (size_t index = 0; index < drawCount; ++index)
+		{
+			introQueue.Add(static_cast<unsigned int>(generator()), static_cast<unsigned int>(index), static_cast<float>(index));
+		}
+		CU::SoAC<unsigned int, unsigned int, float> sampleQueue = introQueue;
+		CU::SoAC<unsigned int, unsigned int, float> radixQueue = introQueue;
+
+		const auto predicate = [](const unsigned int aLHS, const unsigned int aRHS) { return aLHS < aRHS; };
+		CU::StopWatch s;
+		s.Start();
+		CU::ISortLite<0, decltype(predicate), unsigned int, unsigned int, float>(introQueue, 0, introQueue.Size(), predicate);
+		s.Stop();
+		const long long introTime = s.Time().count();
+
+		s.Start();
+		CU::ParallelSort<0>(sampleQueue, 0, sampleQueue.Size(), predicate);
+		s.Stop();
+		const long long sampleTime = s.Time().count();
+
+		s.Start();
+		CU::RadixSort<0>(radixQueue, 0, radixQueue.Size());
+		s.Stop();
+		const long long radixTime = s.Time().count();
+
+		for (size_t index = 0; index < drawCount; ++index)
+		{
+			assert(sampleQueue.Get<0>(index) == introQueue.Get<0>(index) && radixQueue.Get<0>(index) == introQueue.Get<0>(index) && "Sorted draw queues disagree.");
+		}
+		std::cout << drawCount << " draw keys on " << CU::ThreadPool::GetDefault().GetParticipantCount() << " threads, ISortLite: " << introTime
+			<< " ParallelSort: " << sampleTime << " RadixSort: " << radixTime << "\n";
+	}
+}
+
+namespace SoACTests
+{
+	inline void IterationTest()
+	{
+		const int elementCount = 1'000'000;
+		CU::SoAC<int, float, double> soac;
+		for (int index = 0; index < elementCount; ++index)
+		{
+			soac.Add(index, static_cast<float>(index % 7), 0.0);
+		}
+
+		CU::StopWatch s;
+		s.Start();
+		for (size_t index = 0; index < soac.Size(); ++index)
+		{
+			std::get<2>(soac[index]) = std::get<0>(soac[index]) * std::get<1>(soac[index]);
+		}
+		s.Stop();
+		const long long indexTime = s.Time().count();
+
+		s.Start();
+		for (auto [id, factor, product] : soac)
+		{
+			product = id * factor * 2.0;
+		}
+		s.Stop();
+		std::cout << "SoAC 1M elements, operator[] loop: " << indexTime << " range-for: " << s.Time().count() << "\n";
+
+		const CU::SoAC<int, float, double>& constSoac = soac;
+		const auto mismatch = std::find_if(constSoac.begin(), constSoac.end(), [](const auto& anElement) { return std::get<2>(anElement) != std::get<0>(anElement) * static_cast<double>(std::get<1>(anElement)) * 2.0; });
+		assert(mismatch == constSoac.end() && "Range-for over SoAC did not write through to the columns.");
+		assert((constSoac.end() - constSoac.begin()) == elementCount && (constSoac.begin() + 5).Get<0>() == 5 && std::get<0>(constSoac.begin()[6]) == 6 && "SoAC iterator arithmetic is off.");
+		mismatch;
+
+		const std::ptrdiff_t zeroFactors = std::count_if(soac.begin(), soac.end(), [](const auto& anElement) { return std::get<1>(anElement) == 0.f; });
+		assert(zeroFactors == (elementCount + 6) / 7 && "count_if over SoAC saw a wrong amount of elements.");
+		assert(soac.Data<0>()[elementCount - 1] == elementCount - 1 && "SoAC::Data does not point at the column.");
+		zeroFactors;
+
+		CU::SparseSet<unsigned int> set;
+		CU::SparseVector<int> vector;
+		for (unsigned int id = 0; id < 1000; ++id)
+		{
+			set.Add(id * 3);
+			vector.Add(id * 3) = static_cast<int>(id);
+		}
+
+		unsigned long long setSum = 0;
+		for (const unsigned int element : set)
+		{
+			setSum += element;
+		}
+		for (int& element : vector)
+		{
+			element *= 2;
+		}
+		assert(setSum == 3ull * 999 * 1000 / 2 && "Range-for over SparseSet visited a wrong set of elements.");
+		assert(std::accumulate(vector.begin(), vector.end(), 0) == 999 * 1000 && "Range-for over SparseVector did not write through.");
+		assert(std::equal(vector.GetIdentifiers().begin(), vector.GetIdentifiers().end(), set.begin()) && "SparseVector identifiers are not in dense order.");
+		setSum;
+	}
+
+	template<class Container>
+	inline bool AreColumnsAligned(const Container& aContainer)
+	{
+		return ((reinterpret_cast<uintptr_t>(aContainer.template Data<0>()) % 64) == 0) && ((reinterpret_cast<uintptr_t>(aContainer.template Data<1>()) % 64) == 0)
+			&& ((reinterpret_cast<uintptr_t>(aContainer.template Data<2>()) % 64) == 0);
+	}
+
+	//Integrates positions by velocities, scalar over a vector backed SoAC and SIMD over the padded columns of an AlignedSoAC.
+	inline void AlignedStorageTest()
+	{
+		CU::AlignedSoAC<unsigned int, float, double> rows;
+		for (unsigned int index = 0; index < 1000; ++index)
+		{
+			rows.Add(999 - index, static_cast<float>(index), static_cast<double>(index) * 0.5);
+			assert(AreColumnsAligned(rows) && "AlignedSoAC column lost its alignment when growing.");
+		}
+		assert(rows.Size() == 1000 && rows.Capacity() >= 1000 && rows.Get<1>(10) == 10.f && std::get<2>(rows[20]) == 10.0 && "AlignedSoAC lost an element.");
+		assert(rows.GetPaddedSize<0>() == 1008 && rows.GetPaddedSize<1>() == 1008 && rows.GetPaddedSize<2>() == 1000 && "AlignedSoAC padded sizes are off.");
+
+		rows.Add(rows.Get<0>(0), rows.Get<1>(0), rows.Get<2>(0));
+		assert(rows.Get<0>(1000) == 999 && "AlignedSoAC::Add read an argument from the released buffer.");
+		rows.Resize(1000);
+
+		const size_t capacity = rows.Capacity();
+		rows.Reserve(capacity + 5000);
+		assert(rows.Size() == 1000 && rows.Capacity() >= capacity + 5000 && AreColumnsAligned(rows) && rows.Get<0>(999) == 0 && "AlignedSoAC::Reserve changed the contents.");
+		rows.Resize(1500);
+		assert(rows.Get<0>(1499) == 0 && rows.Get<2>(1499) == 0.0 && rows.Get<1>(999) == 999.f && "AlignedSoAC::Resize did not value initialize new elements.");
+		rows.Resize(1000);
+
+		CU::SoAC<int> vectorRows;
+		vectorRows.Reserve(100);
+		assert(vectorRows.Size() == 0 && vectorRows.Capacity() >= 100 && "SoAC::Reserve constructed elements.");
+
+		CU::AlignedSoAC<unsigned int, float, double> copy = rows;
+		CU::AlignedSoAC<unsigned int, float, double> moved = std::move(copy);
+		moved.Swap(0, 1);
+		assert(moved.Get<0>(0) == 998 && rows.Get<0>(0) == 999 && copy.Size() == 0 && AreColumnsAligned(moved) && "AlignedSoAC copy or move shares its buffer.");
+		unsigned long long keySum = 0;
+		for (const auto [key, single, twice] : moved)
+		{
+			keySum += key;
+			single, twice;
+		}
+		assert(keySum == 999ull * 1000 / 2 && "Range-for over AlignedSoAC visited a wrong set of elements.");
+
+		const auto ascending = [](const unsigned int aLHS, const unsigned int aRHS) { return aLHS < aRHS; };
+		CU::ISortLite<0, decltype(ascending), unsigned int, float, double>(moved, 0, moved.Size(), ascending);
+		CU::RadixSort<0>(rows, 0, rows.Size());
+		for (size_t index = 0; index < moved.Size(); ++index)
+		{
+			assert(moved.Get<0>(index) == index && moved.Get<1>(index) == 999.f - index && "ISortLite over AlignedSoAC misplaced a row.");
+			assert(rows.Get<0>(index) == index && rows.Get<1>(index) == 999.f - index && rows.Get<2>(index) == (999 - index) * 0.5 && "RadixSort over AlignedSoAC misplaced a row.");
+		}
+		keySum;
+
+		const size_t particleCount = 1'000'000;
+		const float deltaTime = 1.f / 60.f;
+		CU::SoAC<float, float, float> vectorParticles;
+		CU::AlignedSoAC<float, float, float> alignedParticles;
+		alignedParticles.Reserve(particleCount);
+		for (size_t index = 0; index < particleCount; ++index)
+		{
+			const float position = static_cast<float>(index % 1000);
+			const float velocity = static_cast<float>(index % 13) - 6.f;
+			vectorParticles.Add(position, velocity, 0.f);
+			alignedParticles.Add(position, velocity, 0.f);
+		}
+
+		CU::StopWatch s;
+		s.Start();
+		for (int step = 0; step < 10; ++step)
+		{
+			float* positions = vectorParticles.Data<0>();
+			const float* velocities = vectorParticles.Data<1>();
+			for (size_t index = 0; index < vectorParticles.Size(); ++index)
+			{
+				positions[index] += velocities[index] * deltaTime;
+			}
+		}
+		s.Stop();
+		const long long vectorTime = s.Time().count();
+
+		s.Start();
+		for (int step = 0; step < 10; ++step)
+		{
+			//Padding past Size() is scratch, so the loop runs whole registers with aligned loads and no remainder.
+			float* positions = alignedParticles.Data<0>();
+			const float* velocities = alignedParticles.Data<1>();
+			const size_t paddedSize = alignedParticles.GetPaddedSize<0>();
+#if defined(__AVX__)
+			const __m256 delta = _mm256_set1_ps(deltaTime);
+			for (size_t index = 0; index < paddedSize; index += 8)
+			{
+				_mm256_store_ps(positions + index, _mm256_add_ps(_mm256_load_ps(positions + index), _mm256_mul_ps(_mm256_load_ps(velocities + index), delta)));
+			}
+#else
+			const __m128 delta = _mm_set1_ps(deltaTime);
+			for (size_t index = 0; index < paddedSize; index += 4)
+			{
+				_mm_store_ps(positions + index, _mm_add_ps(_mm_load_ps(positions + index), _mm_mul_ps(_mm_load_ps(velocities + index), delta)));
+			}
+#endif
+		}
+		s.Stop();
+		std::cout << "Integrate 1M particles x10, SoAC scalar: " << vectorTime << " AlignedSoAC SIMD: " << s.Time().count() << "\n";
+
+		for (size_t index = 0; index < particleCount; index += 997)
+		{
+			assert(std::abs(vectorParticles.Get<0>(index) - alignedParticles.Get<0>(index)) < 0.001f && "Aligned SIMD integration diverged from the scalar loop.");
+		}
+	}
+
+	//Tracks live instances so the block storage can be checked for leaked or doubly destroyed elements.
+	struct LiveElement
+	{
+		static inline int ourLiveCount = 0;
+
+		LiveElement() : myName("default") { ++ourLiveCount; }
+		LiveElement(const char* aName) : myName(aName) { ++ourLiveCount; }
+		LiveElement(const LiveElement& anOther) : myName(anOther.myName) { ++ourLiveCount; }
+		LiveElement(LiveElement&& anOther) noexcept : myName(std::move(anOther.myName)) { ++ourLiveCount; }
+		~LiveElement() { --ourLiveCount; }
+		LiveElement& operator=(const LiveElement& anOther) = default;
+		LiveElement& operator=(LiveElement&& anOther) noexcept = default;
+
+		std::string myName;
+	};
+
+	template<class ColumnStorage>
+	inline long long MeasureParticleAdds(const size_t aParticleCount, const bool aReserve)
+	{
+		CU::BasicSoAC<ColumnStorage, float, float, float, float, float, float, unsigned int> particles;
+		CU::StopWatch s;
+		s.Start();
+		if (aReserve)
+		{
+			particles.Reserve(aParticleCount);
+		}
+		for (size_t index = 0; index < aParticleCount; ++index)
+		{
+			const float value = static_cast<float>(index);
+			particles.Add(value, value, value, 0.f, 1.f, 0.f, static_cast<unsigned int>(index));
+		}
+		s.Stop();
+		assert(particles.Size() == aParticleCount && particles.template Get<6>(aParticleCount - 1) == aParticleCount - 1 && "Particle SoAC lost a row.");
+		return s.Time().count();
+	}
+
+	inline void BlockStorageTest()
+	{
+		{
+			CU::SoAC<int, LiveElement, double> rows;
+			rows.Reserve(10);
+			assert(rows.Size() == 0 && rows.Capacity() >= 10 && LiveElement::ourLiveCount == 0 && "SoAC::Reserve constructed elements.");
+			for (int index = 0; index < 1000; ++index)
+			{
+				rows.Add(index, std::to_string(index).c_str(), index * 0.25);
+			}
+			assert(rows.Size() == 1000 && LiveElement::ourLiveCount == 1000 && "SoAC growth leaked or dropped elements.");
+			assert(rows.Get<1>(999).myName == "999" && rows.Get<1>(3).myName == "3" && rows.Get<2>(8) == 2.0 && "SoAC growth did not relocate the columns.");
+			assert((reinterpret_cast<uintptr_t>(rows.Data<2>()) % alignof(double)) == 0 && (reinterpret_cast<uintptr_t>(rows.Data<1>()) % alignof(LiveElement)) == 0 && "SoAC column is misaligned.");
+
+			rows.Add(rows.Get<0>(0), rows.Get<1>(0), rows.Get<2>(0));
+			assert(rows.Get<1>(1000).myName == "0" && "SoAC::Add read an argument from the released block.");
+
+			CU::SoAC<int, LiveElement, double> copy = rows;
+			assert(LiveElement::ourLiveCount == 2002 && copy.Get<1>(500).myName == "500" && "SoAC copy did not copy construct the elements.");
+			CU::SoAC<int, LiveElement, double> moved = std::move(copy);
+			assert(LiveElement::ourLiveCount == 2002 && moved.Get<1>(500).myName == "500" && copy.Size() == 0 && "SoAC move copied the elements.");
+
+			moved.Resize(10);
+			assert(LiveElement::ourLiveCount == 1011 && "SoAC::Resize did not destroy the removed elements.");
+			moved.Resize(20);
+			assert(LiveElement::ourLiveCount == 1021 && moved.Get<1>(19).myName == "default" && moved.Get<0>(19) == 0 && "SoAC::Resize did not value initialize.");
+			moved.Swap(0, 9);
+			assert(moved.Get<1>(0).myName == "9" && moved.Get<0>(9) == 0 && "SoAC::Swap missed a column.");
+
+			rows = moved;
+			assert(LiveElement::ourLiveCount == 40 && rows.Get<1>(9).myName == "0" && "SoAC copy assignment leaked the old elements.");
+		}
+		assert(LiveElement::ourLiveCount == 0 && "SoAC destructor leaked elements.");
+
+		CU::SoAC<unsigned int, float> sortRows;
+		for (unsigned int index = 0; index < 1000; ++index)
+		{
+			sortRows.Add(999 - index, static_cast<float>(index));
+		}
+		CU::RadixSort<0>(sortRows, 0, sortRows.Size());
+		assert(sortRows.Get<0>(0) == 0 && sortRows.Get<1>(0) == 999.f && "RadixSort over the block storage misplaced a row.");
+
+		//Seven float and id columns per particle, the growth of N vectors against one block.
+		const size_t particleCount = 10'000'000;
+		const long long vectorTime = MeasureParticleAdds<CU::VectorColumnStorage>(particleCount, false);
+		const long long blockTime = MeasureParticleAdds<CU::BlockColumnStorage<>>(particleCount, false);
+		const long long vectorReservedTime = MeasureParticleAdds<CU::VectorColumnStorage>(particleCount, true);
+		const long long blockReservedTime = MeasureParticleAdds<CU::BlockColumnStorage<>>(particleCount, true);
+		std::cout << "10M particle Adds, vector columns: " << vectorTime << " block: " << blockTime
+			<< " reserved vector columns: " << vectorReservedTime << " reserved block: " << blockReservedTime << "\n";
+	}
+
+	inline const char* GetInstructionSetName(const CU::ColumnKernels::InstructionSet anInstructionSet)
+	{
+		switch (anInstructionSet)
+		{
+		case CU::ColumnKernels::InstructionSet::AVX2: return "AVX2";
+		case CU::ColumnKernels::InstructionSet::SSE2: return "SSE2";
+		default: return "scalar";
+		}
+	}
+
+	//Every kernel on every supported instruction set against a plain loop, on sizes and offsets that leave scalar remainders.
+	inline void ColumnKernelTest()
+	{
+		using CU::ColumnKernels::InstructionSet;
+		std::mt19937 generator(5);
+		std::vector<float> floats(1043);
+		std::vector<int> ints(1043);
+		for (size_t index = 0; index < floats.size(); ++index)
+		{
+			floats[index] = std::uniform_real_distribution<float>(-100.f, 100.f)(generator);
+			ints[index] = static_cast<int>(generator());
+		}
+
+		const InstructionSet supported = CU::ColumnKernels::GetSupportedInstructionSet();
+		for (int instructionSet = 0; instructionSet <= static_cast<int>(supported); ++instructionSet)
+		{
+			CU::ColumnKernels::SetInstructionSet(static_cast<InstructionSet>(instructionSet));
+			for (const size_t offset : { 0, 1, 3 })
+			{
+				for (const size_t count : { 0, 1, 7, 8, 17, 1040 })
+				{
+					const CU::ColumnSpan<const float> floatSpan(floats.data() + offset, count);
+					const CU::ColumnSpan<const int> intSpan(ints.data() + offset, count);
+					double floatSum = 0.0;
+					long long intSum = 0;
+					for (size_t index = 0; index < count; ++index)
+					{
+						floatSum += floatSpan[index];
+						intSum += intSpan[index];
+					}
+					assert(std::abs(CU::ColumnKernels::Sum(floatSpan) - floatSum) < 0.01 && CU::ColumnKernels::Sum(intSpan) == intSum && "ColumnKernels::Sum is off.");
+					assert(CU::ColumnKernels::Min(floatSpan) == ((count == 0) ? (std::numeric_limits<float>::max)() : *std::min_element(floatSpan.begin(), floatSpan.end())) && "ColumnKernels::Min(float) is off.");
+					assert(CU::ColumnKernels::Max(floatSpan) == ((count == 0) ? std::numeric_limits<float>::lowest() : *std::max_element(floatSpan.begin(), floatSpan.end())) && "ColumnKernels::Max(float) is off.");
+					assert(CU::ColumnKernels::Min(intSpan) == ((count == 0) ? (std::numeric_limits<int>::max)() : *std::min_element(intSpan.begin(), intSpan.end())) && "ColumnKernels::Min(int) is off.");
+					assert(CU::ColumnKernels::Max(intSpan) == ((count == 0) ? std::numeric_limits<int>::lowest() : *std::max_element(intSpan.begin(), intSpan.end())) && "ColumnKernels::Max(int) is off.");
+
+					std::vector<float> axpy(floats.begin() + offset, floats.begin() + offset + count);
+					std::vector<float> clamped = axpy;
+					std::vector<int> clampedInts(ints.begin() + offset, ints.begin() + offset + count);
+					CU::ColumnKernels::Axpy(0.5f, floatSpan, CU::ColumnSpan<float>(axpy.data(), count));
+					CU::ColumnKernels::Clamp(CU::ColumnSpan<float>(clamped.data(), count), -50.f, 25.f);
+					CU::ColumnKernels::Clamp(CU::ColumnSpan<int>(clampedInts.data(), count), -1000, 1000);
+					for (size_t index = 0; index < count; ++index)
+					{
+						assert(axpy[index] == floatSpan[index] + 0.5f * floatSpan[index] && "ColumnKernels::Axpy is off.");
+						assert(clamped[index] == (std::min)((std::max)(floatSpan[index], -50.f), 25.f) && "ColumnKernels::Clamp(float) is off.");
+						assert(clampedInts[index] == (std::min)((std::max)(intSpan[index], -1000), 1000) && "ColumnKernels::Clamp(int) is off.");
+					}
+				}
+			}
+		}
+		CU::ColumnKernels::SetInstructionSet(supported);
+
+		CU::SoAC<float, float, int, LiveElement> rows;
+		for (int index = 0; index < 100; ++index)
+		{
+			rows.Add(static_cast<float>(index), 2.f, index, std::to_string(index).c_str());
+		}
+		rows.Transform<0, 1>([](CU::ColumnSpan<float> aPositions, CU::ColumnSpan<const float> aVelocities) { CU::ColumnKernels::Axpy(0.5f, aVelocities, aPositions); });
+		rows.Transform<1, 2>([](float& aVelocity, const int anId) { aVelocity = static_cast<float>(anId % 3); });
+		assert(rows.Get<0>(10) == 11.f && rows.Get<1>(10) == 1.f && "SoAC::Transform did not write through.");
+		assert(rows.Reduce<2>(0ll, [](const long long aSum, const int aValue) { return aSum + aValue; }) == 99 * 100 / 2 && "SoAC::Reduce is off.");
+
+		std::vector<size_t> stillRows;
+		rows.Filter<1>([](const float aVelocity) { return aVelocity == 0.f; }, stillRows);
+		assert(stillRows.size() == 34 && stillRows[1] == 3 && "SoAC::Filter picked the wrong rows.");
+		assert(rows.Compact<1>([](const float aVelocity) { return aVelocity != 0.f; }) == 66 && rows.Size() == 66 && "SoAC::Compact kept the wrong amount of rows.");
+		for (size_t index = 0; index < rows.Size(); ++index)
+		{
+			const int id = rows.Get<2>(index);
+			assert((id % 3) != 0 && rows.Get<3>(index).myName == std::to_string(id) && (index == 0 || rows.Get<2>(index - 1) < id) && "SoAC::Compact broke a row or the order.");
+			id;
+		}
+		assert(LiveElement::ourLiveCount == 66 && "SoAC::Compact leaked elements.");
+
+		//Particle integration: a Get<I> loop against Transform with the kernels, per instruction set.
+		const size_t particleCount = 1'000'000;
+		CU::SoAC<float, float> particles;
+		particles.Reserve(particleCount);
+		for (size_t index = 0; index < particleCount; ++index)
+		{
+			particles.Add(static_cast<float>(index % 1000), static_cast<float>(index % 13) - 6.f);
+		}
+
+		CU::StopWatch s;
+		float loopSum = 0.f;
+		s.Start();
+		for (int step = 0; step < 10; ++step)
+		{
+			for (size_t index = 0; index < particles.Size(); ++index)
+			{
+				float& position = particles.Get<0>(index);
+				position = (std::min)((std::max)(position + particles.Get<1>(index) * (1.f / 60.f), -1000.f), 1000.f);
+				loopSum += position;
+			}
+		}
+		s.Stop();
+		std::cout << "Integrate 1M particles x10, Get<I> loop: " << s.Time().count();
+
+		//Every sum is printed, an unused one lets the compiler drop its adds from the timed loop.
+		double checksum = loopSum;
+
+		for (int instructionSet = 0; instructionSet <= static_cast<int>(supported); ++instructionSet)
+		{
+			CU::ColumnKernels::SetInstructionSet(static_cast<InstructionSet>(instructionSet));
+			float positionSum = 0.f;
+			s.Start();
+			for (int step = 0; step < 10; ++step)
+			{
+				particles.Transform<0, 1>([](CU::ColumnSpan<float> aPositions, CU::ColumnSpan<const float> aVelocities)
+				{
+					CU::ColumnKernels::Axpy(1.f / 60.f, aVelocities, aPositions);
+					CU::ColumnKernels::Clamp(aPositions, -1000.f, 1000.f);
+				});
+				positionSum += CU::ColumnKernels::Sum(CU::ColumnSpan<const float>(particles.Data<0>(), particles.Size()));
+			}
+			s.Stop();
+			std::cout << " " << GetInstructionSetName(static_cast<InstructionSet>(instructionSet)) << " axpy+clamp+sum: " << s.Time().count();
+			checksum += positionSum;
+		}
+		std::cout << " (checksum " << checksum << ")\n";
+		CU::ColumnKernels::SetInstructionSet(supported);
+	}
+
+	using CompactionRows = CU::SoAC<unsigned int, double, float, short, LiveElement>;
+
+	inline void FillCompactionRows(CompactionRows& someRowsOut, const unsigned int aCount)
+	{
+		for (unsigned int index = 0; index < aCount; ++index)
+		{
+			someRowsOut.Add(index, index * 2.0, static_cast<float>(index) * 0.5f, static_cast<short>(index), std::to_string(index).c_str());
+		}
+	}
+
+	inline bool IsRowIntact(const CompactionRows& someRows, const size_t anIndex)
+	{
+		const unsigned int id = someRows.Get<0>(anIndex);
+		return (someRows.Get<1>(anIndex) == id * 2.0) && (someRows.Get<2>(anIndex) == static_cast<float>(id) * 0.5f)
+			&& (someRows.Get<3>(anIndex) == static_cast<short>(id)) && (someRows.Get<4>(anIndex).myName == std::to_string(id));
+	}
+
+	template<class Rows>
+	inline long long MeasureParticleRemoval(const Rows& someParticles, const float aDeathThreshold, const int aMethod)
+	{
+		Rows particles = someParticles;
+		//The index buffer for SwapRemove is kept between frames, as in its example, so its memory is already allocated and touched.
+		std::vector<size_t> deadRows(particles.Size());
+		deadRows.clear();
+		CU::StopWatch s;
+		s.Start();
+		if (aMethod == 0)
+		{
+			//The hand written removal EraseIf replaces: one SoAC::Swap to the end per dead row.
+			size_t last = particles.Size();
+			for (size_t index = particles.Size(); index-- > 0;)
+			{
+				if (particles.template Get<4>(index) < aDeathThreshold)
+				{
+					particles.Swap(index, --last);
+				}
+			}
+			particles.Resize(last);
+		}
+		else if (aMethod == 1)
+		{
+			particles.template EraseIf<4>([aDeathThreshold](const float aLifeTime) { return aLifeTime < aDeathThreshold; });
+		}
+		else
+		{
+			particles.template Filter<4>([aDeathThreshold](const float aLifeTime) { return aLifeTime < aDeathThreshold; }, deadRows);
+			particles.SwapRemove(deadRows);
+		}
+		s.Stop();
+		return s.Time().count();
+	}
+
+	inline void StreamCompactionTest()
+	{
+		using CU::ColumnKernels::InstructionSet;
+		const InstructionSet supported = CU::ColumnKernels::GetSupportedInstructionSet();
+		std::mt19937 generator(17);
+		for (int instructionSet = 0; instructionSet <= static_cast<int>(supported); ++instructionSet)
+		{
+			CU::ColumnKernels::SetInstructionSet(static_cast<InstructionSet>(instructionSet));
+			for (const unsigned int count : { 0u, 1u, 7u, 8u, 9u, 64u, 1003u })
+			{
+				for (const unsigned int killPercent : { 0u, 5u, 20u, 100u })
+				{
+					CompactionRows rows;
+					FillCompactionRows(rows, count);
+					std::vector<unsigned char> isDead(count);
+					size_t deadCount = 0;
+					for (unsigned int index = 0; index < count; ++index)
+					{
+						isDead[index] = (generator() % 100) < killPercent;
+						deadCount += isDead[index];
+					}
+
+					const size_t erased = rows.EraseIf<0>([&isDead](const unsigned int anId) { return isDead[anId] != 0; });
+					assert(erased == deadCount && rows.Size() == count - deadCount && LiveElement::ourLiveCount == static_cast<int>(rows.Size()) && "SoAC::EraseIf removed a wrong amount of rows.");
+					for (size_t index = 0; index < rows.Size(); ++index)
+					{
+						assert(IsRowIntact(rows, index) && isDead[rows.Get<0>(index)] == 0 && (index == 0 || rows.Get<0>(index - 1) < rows.Get<0>(index)) && "SoAC::EraseIf broke a row or the order.");
+					}
+					erased;
+				}
+			}
+		}
+		CU::ColumnKernels::SetInstructionSet(supported);
+
+		{
+			CompactionRows rows;
+			FillCompactionRows(rows, 100);
+			rows.SwapRemove({ 99, 3, 50, 3, 0, 98 });
+			std::vector<unsigned int> ids(rows.Data<0>(), rows.Data<0>() + rows.Size());
+			std::sort(ids.begin(), ids.end());
+			assert(rows.Size() == 95 && LiveElement::ourLiveCount == 95 && ids.front() == 1 && std::count(ids.begin(), ids.end(), 50u) == 0 && ids.back() == 97 && "SoAC::SwapRemove removed the wrong rows.");
+			for (size_t index = 0; index < rows.Size(); ++index)
+			{
+				assert(IsRowIntact(rows, index) && "SoAC::SwapRemove broke a row.");
+			}
+			rows.SwapRemove({});
+			assert(rows.Size() == 95 && "SoAC::SwapRemove without indices changed the rows.");
+		}
+		assert(LiveElement::ourLiveCount == 0 && "SoAC removal leaked elements.");
+
+		//Position, velocity and lifetime columns of 4M particles, a frame killing 5% or 20% of them.
+		const size_t particleCount = 4'000'000;
+		CU::SoAC<float, float, float, float, float, unsigned int, double> particles;
+		particles.Reserve(particleCount);
+		for (size_t index = 0; index < particleCount; ++index)
+		{
+			const float value = static_cast<float>(index);
+			particles.Add(value, value, 1.f, -1.f, std::uniform_real_distribution<float>(0.f, 1.f)(generator), static_cast<unsigned int>(index), 0.0);
+		}
+
+		for (const float deathThreshold : { 0.05f, 0.2f })
+		{
+			std::cout << "Remove " << deathThreshold * 100.f << "% of 4M particles, Swap loop: " << MeasureParticleRemoval(particles, deathThreshold, 0)
+				<< " SwapRemove: " << MeasureParticleRemoval(particles, deathThreshold, 2);
+			for (int instructionSet = 0; instructionSet <= static_cast<int>(supported); ++instructionSet)
+			{
+				//The SSE2 level left-packs with SSSE3, without it EraseIf runs the same scalar loop as the scalar level.
+				const InstructionSet compaction = static_cast<InstructionSet>(instructionSet);
+				if ((compaction == InstructionSet::SSE2) && !CU::ColumnKernels::IsSSSE3Supported())
+					continue;
+
+				CU::ColumnKernels::SetInstructionSet(compaction);
+				std::cout << " EraseIf " << ((compaction == InstructionSet::SSE2) ? "SSSE3" : GetInstructionSetName(compaction)) << ": " << MeasureParticleRemoval(particles, deathThreshold, 1);
+			}
+			std::cout << "\n";
+			CU::ColumnKernels::SetInstructionSet(supported);
+		}
+	}
+}
+
+namespace SparseSetTests
+{
+	//Fills someElementsOut with aCount unique random elements in [aMin, aMax].
+	inline void GenerateUniqueElements(std::vector<unsigned int>& someElementsOut, const unsigned int aCount, const int aMin, const int aMax)
+	{
+		std::vector<bool> taken(static_cast<size_t>(aMax - aMin) + 1, false);
+		while (someElementsOut.size() < aCount)
+		{
+			const int element = CU::GenerateRandomInteger(aMin, aMax);
+			if (!taken[element - aMin])
+			{
+				taken[element - aMin] = true;
+				someElementsOut.push_back(static_cast<unsigned int>(element));
+			}
+		}
+	}
+
+	//Adds and finds someElements in a fresh set, prints timings and the memory the set holds compared to a flat sparse array.
+	inline void MeasureSparseSet(const char* aDistributionName, const std::vector<unsigned int>& someElements)
+	{
+		CU::SparseSet<unsigned int> set;
+		CU::StopWatch s;
+
+		s.Start();
+		for (const unsigned int element : someElements)
+		{
+			set.Add(element);
+		}
+		s.Stop();
+		const double addTime = static_cast<double>(s.Time().count()) / someElements.size();
+
+		size_t foundCount = 0;
+		s.Start();
+		for (const unsigned int element : someElements)
+		{
+			foundCount += (set.Find(element) != set.failureIndex) ? 1 : 0;
+		}
+		s.Stop();
+		const double findTime = static_cast<double>(s.Time().count()) / someElements.size();
+		assert(foundCount == someElements.size() && "SparseSet lost elements!");
+
+		unsigned int largestElement = 0;
+		for (const unsigned int element : someElements)
+		{
+			largestElement = (std::max)(largestElement, element);
+		}
+		const size_t flatSparseBytes = (static_cast<size_t>(largestElement) + 1) * sizeof(unsigned int);
+		const size_t flatBytes = flatSparseBytes + (set.Size() * sizeof(unsigned int));
+
+		std::cout << aDistributionName << ": " << someElements.size() << " elements, largest " << largestElement << "\n";
+		std::cout << "  Add ns/op: " << addTime << " Find ns/op: " << findTime << "\n";
+		std::cout << "  Paged bytes: " << set.GetAllocatedBytes() << " Flat sparse array bytes: " << flatBytes << "\n";
+	}
+
+	//Compares Add/Find latency and memory of the paged sparse set on clustered and scattered identifier distributions.
+	inline void PagedSparseSetBenchmark()
+	{
+		const unsigned int elementCount = 100'000;
+
+		std::vector<unsigned int> clustered;
+		for (unsigned int i = 0; i < elementCount; ++i)
+		{
+			clustered.push_back(i);
+		}
+		MeasureSparseSet("Clustered", clustered);
+
+		std::vector<unsigned int> clusteredHighBase;
+		for (unsigned int i = 0; i < elementCount; ++i)
+		{
+			clusteredHighBase.push_back(50'000'000 + i);
+		}
+		MeasureSparseSet("Clustered, high base", clusteredHighBase);
+
+		std::vector<unsigned int> scattered;
+		GenerateUniqueElements(scattered, elementCount, 0, 100'000'000);
+		MeasureSparseSet("Scattered", scattered);
+	}
+
+	//Intersects aSmallCount elements with two sets three times larger over an id range ten times larger, sharing aSelectivity of the small set,
+	//through the old Find-and-Add loop and Intersection.
+	template<class Set>
+	inline void MeasureIntersection(const char* aStrategyName, const unsigned int aSmallCount, const double aSelectivity, const bool anInOrder, const bool aUseBitmaps)
+	{
+		const unsigned int universe = aSmallCount * 10;
+		const unsigned int smallCount = aSmallCount;
+		const unsigned int largeCount = aSmallCount * 3;
+
+		std::vector<unsigned int> ids;
+		GenerateUniqueElements(ids, universe, 0, universe - 1);
+
+		const size_t sharedCount = static_cast<size_t>(smallCount * aSelectivity);
+		std::vector<unsigned int> small(ids.begin(), ids.begin() + smallCount);
+		std::vector<unsigned int> large(ids.begin(), ids.begin() + sharedCount);
+		large.insert(large.end(), ids.begin() + smallCount, ids.begin() + smallCount + (largeCount - sharedCount));
+		std::vector<unsigned int> otherLarge = large;
+		std::reverse(otherLarge.begin(), otherLarge.end());
+		if (anInOrder)
+		{
+			std::sort(small.begin(), small.end());
+			std::sort(large.begin(), large.end());
+			std::sort(otherLarge.begin(), otherLarge.end());
+		}
+
+		Set sets[3];
+		const std::vector<unsigned int>* contents[3] = { &small, &large, &otherLarge };
+		for (size_t setIndex = 0; setIndex < 3; ++setIndex)
+		{
+			sets[setIndex].EnablePresenceBitmap(aUseBitmaps);
+			sets[setIndex].AddMany(contents[setIndex]->data(), contents[setIndex]->size());
+		}
+
+		CU::StopWatch s;
+		s.Start();
+		Set probed;
+		for (size_t index = 0; index < sets[0].Size(); ++index)
+		{
+			if ((sets[1].Find(sets[0][index]) != sets[1].failureIndex) && (sets[2].Find(sets[0][index]) != sets[2].failureIndex))
+			{
+				probed.Add(sets[0][index]);
+			}
+		}
+		s.Stop();
+		const long long probeTime = s.Time().count();
+
+		const Set* setPointers[3] = { &sets[2], &sets[0], &sets[1] };
+		std::vector<unsigned int> intersection;
+		s.Start();
+		Set::Intersection(setPointers, 3, intersection);
+		s.Stop();
+		const long long intersectionTime = s.Time().count();
+
+		assert(intersection.size() == sharedCount && probed.Size() == sharedCount && "Intersection produced a wrong amount of elements.");
+		for (const unsigned int element : intersection)
+		{
+			assert(probed.IsValid(element) && "Intersection produced an element missing from the probed result.");
+			element;
+		}
+
+		std::cout << aStrategyName << " selectivity " << aSelectivity * 100.0 << "%: Find + Add " << probeTime << " Intersection " << intersectionTime << "\n";
+	}
+
+	//Covers selectivities from 0.1% to 100% for each Intersection strategy. Sorted paged sets are probed like unsorted ones,
+	//only sorted hashed sets past SparseSet::gallopMinimumSize are galloped.
+	inline void IntersectionBenchmark()
+	{
+		using PagedSet = CU::SparseSet<unsigned int>;
+		using HashedSet = CU::SparseSet<unsigned int, CU::SparseIdentity<unsigned int>, CU::HashedSparseStorage<unsigned int>>;
+
+		std::cout << "3-way SparseSet intersection:\n";
+		for (const double selectivity : { 0.001, 0.01, 0.1, 0.5, 1.0 })
+		{
+			MeasureIntersection<PagedSet>("  bitmap            ", 100'000, selectivity, false, true);
+			MeasureIntersection<PagedSet>("  probing, sorted   ", 100'000, selectivity, true, false);
+			MeasureIntersection<PagedSet>("  probing, unsorted ", 100'000, selectivity, false, false);
+			MeasureIntersection<HashedSet>("  hashed probing    ", 1'000'000, selectivity, false, false);
+			MeasureIntersection<HashedSet>("  hashed galloping  ", 1'000'000, selectivity, true, false);
+		}
+	}
+
+	inline void SortedModeTest()
+	{
+		std::vector<unsigned int> ids;
+		GenerateUniqueElements(ids, 10'000, 0, 99'999);
+
+		CU::SparseSet<unsigned int> set;
+		CU::SparseVector<unsigned int> vector;
+		set.AddMany(ids.data(), ids.size());
+		for (const unsigned int id : ids)
+		{
+			vector.Add(id) = id * 2;
+		}
+		assert(!set.IsSorted() && !vector.IsSorted() && "Containers filled in random order report being sorted.");
+
+		set.Sort();
+		vector.Sort();
+		assert(set.IsSorted() && vector.IsSorted() && "Sort did not mark the containers as sorted.");
+		for (size_t index = 0; index < set.Size(); ++index)
+		{
+			assert((index == 0 || set[index - 1] < set[index]) && set.Find(set[index]) == index && "SparseSet::Sort left the set unordered or its sparse side stale.");
+			assert(vector.Get(vector.GetIdentifier(static_cast<unsigned int>(index))) == vector.GetIdentifier(static_cast<unsigned int>(index)) * 2 && "SparseVector::Sort separated an element from its identifier.");
+		}
+
+		const size_t first = set.LowerBound(20'000);
+		const size_t last = set.UpperBound(29'999);
+		for (size_t index = 0; index < set.Size(); ++index)
+		{
+			const bool isInRange = (set[index] >= 20'000) && (set[index] <= 29'999);
+			assert(isInRange == (index >= first && index < last) && "Range query does not match the elements in range.");
+			isInRange;
+		}
+
+		vector.Sort([](const unsigned int aLHS, const unsigned int aRHS) { return aLHS > aRHS; });
+		for (unsigned int index = 1; index < vector.Size(); ++index)
+		{
+			assert(vector[index - 1] > vector[index] && vector.Get(vector.GetIdentifier(index)) == vector[index] && "SparseVector::Sort(compare) produced a wrong order.");
+		}
+
+		CU::SparseSet<unsigned int> otherSet;
+		for (unsigned int element = 0; element < 100'000; element += 3)
+		{
+			otherSet.Add(element);
+		}
+		std::vector<unsigned int> mergedUnion;
+		std::vector<unsigned int> mergedDifference;
+		set.Union(otherSet, mergedUnion);
+		set.Difference(otherSet, mergedDifference);
+		assert(std::is_sorted(mergedUnion.begin(), mergedUnion.end()) && std::is_sorted(mergedDifference.begin(), mergedDifference.end()) && "Merged set operations are not ordered.");
+
+		std::vector<unsigned int> intersection;
+		const CU::SparseSet<unsigned int>* sets[2] = { &set, &otherSet };
+		CU::SparseSet<unsigned int>::Intersection(sets, 2, intersection);
+		assert(mergedUnion.size() + intersection.size() == set.Size() + otherSet.Size() && "Union size does not match the intersection.");
+		assert(mergedDifference.size() + intersection.size() == set.Size() && "Difference size does not match the intersection.");
+		for (const unsigned int element : mergedDifference)
+		{
+			assert(set.IsValid(element) && !otherSet.IsValid(element) && "Difference holds an element of the other set.");
+			element;
+		}
+
+		CU::SparseSet<unsigned int> unsortedSet;
+		unsortedSet.AddMany(ids.data(), ids.size());
+		std::vector<unsigned int> probedUnion;
+		std::vector<unsigned int> probedDifference;
+		unsortedSet.Union(otherSet, probedUnion);
+		unsortedSet.Difference(otherSet, probedDifference);
+		assert(probedUnion.size() == mergedUnion.size() && probedDifference.size() == mergedDifference.size() && "Probing and merging set operations disagree.");
+	}
+
+	inline void OrderedRemoveBenchmark()
+	{
+		//Removes every 10th identifier, one Remove at a time against one RemoveMany, then RemoveMany alone on 1M elements.
+		for (const unsigned int elementCount : { 50'000u, 1'000'000u })
+		{
+			CU::SparseSet<unsigned int> set;
+			CU::SparseVector<unsigned int> vector;
+			std::vector<unsigned int> victims;
+			for (unsigned int id = 0; id < elementCount; ++id)
+			{
+				set.Add(id);
+				vector.Add(id) = id;
+				if (id % 10 == 0)
+				{
+					victims.push_back(id);
+				}
+			}
+
+			std::cout << "Ordered removal of 10% of " << elementCount << ":";
+			if (elementCount <= 50'000)
+			{
+				CU::SparseSet<unsigned int> removedSet = set;
+				CU::StopWatch s;
+				s.Start();
+				for (const unsigned int id : victims)
+				{
+					removedSet.Remove(id);
+				}
+				s.Stop();
+				std::cout << " Remove(SparseSet only) " << s.Time().count();
+			}
+
+			CU::StopWatch s;
+			s.Start();
+			set.RemoveMany(victims.data(), victims.size());
+			vector.RemoveMany(victims.data(), static_cast<unsigned int>(victims.size()));
+			s.Stop();
+
+			assert(set.Size() == elementCount - victims.size() && vector.Size() == set.Size() && "RemoveMany removed a wrong amount of elements.");
+			for (unsigned int index = 0; index < vector.Size(); ++index)
+			{
+				assert(vector[index] == set[index] && vector.GetIdentifier(index) == vector[index] && vector.Find(vector[index]) == index && "RemoveMany did not keep the order or left stale indices.");
+				assert(vector[index] % 10 != 0 && "RemoveMany kept a victim.");
+			}
+
+			std::cout << " RemoveMany(SparseSet + SparseVector) " << s.Time().count() << "\n";
+		}
+	}
+
+	//Counts every construction and assignment so the cost of SparseVector operations can be measured per element.
+	struct CountedElement
+	{
+		static inline size_t ourConstructions = 0;
+		static inline size_t ourCopies = 0;
+		static inline size_t ourMoves = 0;
+
+		CountedElement(const int aValue) : myValue(aValue) { ++ourConstructions; }
+		CountedElement(const CountedElement& anOther) : myValue(anOther.myValue) { ++ourCopies; }
+		CountedElement(CountedElement&& anOther) noexcept : myValue(anOther.myValue) { ++ourMoves; }
+		CountedElement& operator=(const CountedElement& anOther) { myValue = anOther.myValue; ++ourCopies; return *this; }
+		CountedElement& operator=(CountedElement&& anOther) noexcept { myValue = anOther.myValue; ++ourMoves; return *this; }
+
+		static void ResetCounters() { ourConstructions = 0; ourCopies = 0; ourMoves = 0; }
+
+		int myValue;
+	};
+
+	inline void SparseVectorConstructionTest()
+	{
+		//CountedElement has no default constructor, so only Emplace and the value overloads of Add can be used.
+		const unsigned int elementCount = 10'000;
+		CU::SparseVector<CountedElement> vector;
+		vector.Reserve(elementCount, elementCount - 1);
+
+		CountedElement::ResetCounters();
+		for (unsigned int id = 0; id < elementCount; ++id)
+		{
+			vector.Emplace(id, static_cast<int>(id));
+		}
+		assert(CountedElement::ourConstructions == elementCount && CountedElement::ourCopies == 0 && CountedElement::ourMoves == 0 && "Emplace did more than one construction per element.");
+		std::cout << "SparseVector per element, Emplace: " << CountedElement::ourConstructions / elementCount << " constructions " << CountedElement::ourCopies << " copies " << CountedElement::ourMoves << " moves\n";
+
+		CountedElement::ResetCounters();
+		for (unsigned int id = 0; id < elementCount; id += 2)
+		{
+			vector.RemoveCyclic(id);
+		}
+		assert(CountedElement::ourCopies == 0 && CountedElement::ourMoves <= elementCount / 2 && "RemoveCyclic copied or moved more than the last element.");
+		std::cout << "SparseVector per element, RemoveCyclic: " << CountedElement::ourCopies << " copies " << static_cast<double>(CountedElement::ourMoves) / (elementCount / 2) << " moves\n";
+
+		CountedElement::ResetCounters();
+		vector.Add(0, CountedElement(-1));
+		assert(CountedElement::ourCopies == 0 && CountedElement::ourMoves == 1 && vector.Get(0).myValue == -1 && "Add of a temporary did not move it.");
+		for (unsigned int id = 1; id < elementCount; id += 2)
+		{
+			assert(vector.Get(id).myValue == static_cast<int>(id) && "Element got separated from its identifier.");
+		}
+	}
+
+	//One writer churns a ConcurrentSparseSet, growing its dense buffer, while aReaderCount threads look elements up.
+	//Returns the total lookup time in nanoseconds summed over the readers.
+	template<class SetType, class ElementFunction>
+	inline long long RunConcurrentReaders(SetType& aSet, const unsigned int aReaderCount, const size_t aLookupsPerReader, const ElementFunction& aToElement)
+	{
+		const unsigned int permanentCount = 1000;
+		const unsigned int churnCount = 100'000;
+		const unsigned int moverCount = 50'000;
+		const unsigned int firstMover = permanentCount + churnCount;
+		for (unsigned int index = 0; index < permanentCount; ++index)
+		{
+			aSet.Add(aToElement(index, 0));
+		}
+
+		//Even while the movers are all present, readers only count a mover lookup if the epoch is the same before and after it.
+		std::atomic<unsigned int> moverEpoch = 1;
+		std::atomic<unsigned int> finishedReaders = 0;
+		std::atomic<long long> totalReadTime = 0;
+		std::vector<std::thread> readers;
+		for (unsigned int readerIndex = 0; readerIndex < aReaderCount; ++readerIndex)
+		{
+			readers.emplace_back([&, readerIndex]()
+			{
+				std::mt19937 generator(readerIndex);
+				std::uniform_int_distribution<unsigned int> distribution(0, permanentCount + churnCount - 1);
+				std::uniform_int_distribution<unsigned int> moverDistribution(firstMover, firstMover + moverCount - 1);
+				CU::StopWatch s;
+				s.Start();
+				for (size_t lookup = 0; lookup < aLookupsPerReader; ++lookup)
+				{
+					const unsigned int index = distribution(generator);
+					const bool isValid = aSet.IsValid(aToElement(index, 0));
+					assert((index >= permanentCount || isValid) && "A permanent element read as missing during concurrent writes.");
+					assert(!aSet.IsValid(aToElement(index, 1)) && "An element that was never added read as present.");
+
+					const unsigned int epoch = moverEpoch.load();
+					const bool isMoverValid = aSet.IsValid(aToElement(moverDistribution(generator), 0));
+					assert(((epoch & 1) != 0 || isMoverValid || moverEpoch.load() != epoch) && "An element moved by RemoveCyclic read as missing.");
+					isValid;
+					isMoverValid;
+				}
+				s.Stop();
+				totalReadTime += s.Time().count();
+				++finishedReaders;
+			});
+		}
+
+		//The churned range is refilled and emptied until every reader is done, which grows the dense buffer and retires the old ones under the readers.
+		//The movers are added on top of it and each is moved down by removing a churn element, whose re-add lands in the mover's old dense slot.
+		do
+		{
+			for (unsigned int index = permanentCount; index < firstMover; ++index)
+			{
+				aSet.Add(aToElement(index, 0));
+			}
+			for (unsigned int index = firstMover; index < firstMover + moverCount; ++index)
+			{
+				aSet.Add(aToElement(index, 0));
+			}
+			++moverEpoch;
+
+			for (unsigned int index = permanentCount; index < permanentCount + moverCount; ++index)
+			{
+				aSet.RemoveCyclic(aToElement(index, 0));
+				aSet.Add(aToElement(index, 0));
+				aSet.RemoveCyclic(aToElement(index, 0));
+			}
+
+			++moverEpoch;
+			for (unsigned int index = permanentCount + moverCount; index < firstMover + moverCount; ++index)
+			{
+				aSet.RemoveCyclic(aToElement(index, 0));
+			}
+		} while (finishedReaders.load() < aReaderCount);
+
+		for (std::thread& reader : readers)
+		{
+			reader.join();
+		}
+		assert(aSet.Size() == permanentCount && "Concurrent churn left a wrong amount of elements.");
+		return totalReadTime.load();
+	}
+
+	inline void ConcurrentSparseSetTest()
+	{
+		//Identity indexer for plain ids, entity indexer for versioned handles where readers also compare the dense value.
+		const auto toIdentifier = [](const unsigned int anIndex, const unsigned int anUnusedOffset) { return anIndex + anUnusedOffset * 500'000; };
+		const auto toHandle = [](const unsigned int anIndex, const unsigned int aVersion) { return EntityTraits<unsigned int>::Combine(anIndex, aVersion); };
+
+		std::cout << "ConcurrentSparseSet lookups per reader per microsecond:\n";
+		for (const unsigned int readerCount : { 1u, 2u, 4u, 8u, 16u, 32u })
+		{
+			const size_t lookupsPerReader = 100'000;
+			CU::ConcurrentSparseSet<unsigned int> identifierSet;
+			CU::ConcurrentSparseSet<unsigned int, EntitySparseIndex<unsigned int>> handleSet;
+			const long long identifierTime = RunConcurrentReaders(identifierSet, readerCount, lookupsPerReader, toIdentifier);
+			const long long handleTime = RunConcurrentReaders(handleSet, readerCount, lookupsPerReader, toHandle);
+			assert(handleSet.GetRetiredBufferCount() <= 2 && "Retired dense buffers were never reclaimed.");
+
+			std::cout << "  " << readerCount << " readers: ids " << (3000.0 * lookupsPerReader * readerCount) / (std::max)(identifierTime, 1ll)
+				<< " handles " << (3000.0 * lookupsPerReader * readerCount) / (std::max)(handleTime, 1ll) << "\n";
+		}
+
+		CU::ConcurrentSparseSet<unsigned int> boundedSet(CU::ConcurrentSparseSet<unsigned int>::pageSize - 1);
+		const bool isOutOfRangeAdded = boundedSet.Add(CU::ConcurrentSparseSet<unsigned int>::pageSize);
+		assert(!isOutOfRangeAdded && boundedSet.Size() == 0 && !boundedSet.IsValid(CU::ConcurrentSparseSet<unsigned int>::pageSize) && "An element past the max sparse index was added.");
+		isOutOfRangeAdded;
+	}
+
+	//64-bit identifiers through HashedSparseStorage: add/remove churn, memory bounded by the live elements and Find latency against the paged storage.
+	inline void HashedSparseStorageTest()
+	{
+		using HashedSet = CU::SparseSet<unsigned long long, CU::SparseIdentity<unsigned long long>, CU::HashedSparseStorage<unsigned long long>>;
+		const unsigned int elementCount = 100'000;
+
+		std::mt19937_64 generator(7);
+		std::vector<unsigned long long> identifiers(elementCount);
+		for (unsigned long long& identifier : identifiers)
+		{
+			identifier = generator() >> 1;//Stays clear of failureIndex.
+		}
+
+		HashedSet set;
+		set.AddMany(identifiers.data(), identifiers.size());
+		assert(set.Size() == elementCount && "Random 64-bit identifiers collided or got lost.");
+		const size_t filledBytes = set.GetAllocatedBytes();
+
+		//Every round removes half of the live elements and adds as many new ones, removed slots are reused or dropped on rehash.
+		for (unsigned int round = 0; round < 8; ++round)
+		{
+			for (unsigned int index = round & 1; index < elementCount; index += 2)
+			{
+				set.RemoveCyclic(identifiers[index]);
+				assert(!set.IsValid(identifiers[index]) && "Removed identifier still read as present.");
+				identifiers[index] = generator() >> 1;
+			}
+			for (unsigned int index = round & 1; index < elementCount; index += 2)
+			{
+				set.Add(identifiers[index]);
+			}
+			assert(set.Size() == elementCount && "Churn left a wrong amount of elements.");
+		}
+		for (const unsigned long long identifier : identifiers)
+		{
+			assert(set.IsValid(identifier) && set[set.Find(identifier)] == identifier && "Identifier does not map back to itself after churn.");
+			identifier;
+		}
+		assert(set.GetAllocatedBytes() <= 2 * filledBytes && "Removed elements kept the table growing.");
+		std::cout << "HashedSparseStorage bytes, " << elementCount << " live 64-bit ids: " << filledBytes << " after churn " << set.GetAllocatedBytes()
+			<< ", paged storage would allocate " << static_cast<size_t>(elementCount) * CU::PagedSparseStorage<unsigned long long>::pageSize * sizeof(unsigned long long) << " in pages\n";
+
+		//Find latency on the same amount of elements, paged storage gets dense 32-bit ids as it cannot address the 64-bit ones.
+		CU::SparseSet<unsigned int> pagedSet;
+		for (unsigned int id = 0; id < elementCount; ++id)
+		{
+			pagedSet.Add(id);
+		}
+
+		const unsigned int lookupCount = 1'000'000;
+		std::vector<unsigned int> lookupIndices(lookupCount);
+		for (unsigned int& lookupIndex : lookupIndices)
+		{
+			lookupIndex = static_cast<unsigned int>(generator() % elementCount);
+		}
+
+		size_t hashedFound = 0;
+		CU::StopWatch s;
+		s.Start();
+		for (const unsigned int lookupIndex : lookupIndices)
+		{
+			hashedFound += set.IsValid(identifiers[lookupIndex]);
+		}
+		s.Stop();
+		const double hashedTime = static_cast<double>(s.Time().count()) / lookupCount;
+
+		size_t pagedFound = 0;
+		s.Start();
+		for (const unsigned int lookupIndex : lookupIndices)
+		{
+			pagedFound += pagedSet.IsValid(lookupIndex);
+		}
+		s.Stop();
+		const double pagedTime = static_cast<double>(s.Time().count()) / lookupCount;
+		assert(hashedFound == lookupCount && pagedFound == lookupCount && "Lookup of a live element failed.");
+		std::cout << "Find ns/op, hashed 64-bit: " << hashedTime << " paged 32-bit: " << pagedTime << " (" << hashedFound + pagedFound << " found)\n";
+
+		//SparseVector keyed by 64-bit identifiers.
+		CU::SparseVector<int, unsigned long long, CU::HashedSparseStorage<unsigned long long>> vector;
+		for (unsigned int index = 0; index < 1000; ++index)
+		{
+			vector.Add(identifiers[index], static_cast<int>(index));
+		}
+		for (unsigned int index = 0; index < 1000; index += 3)
+		{
+			vector.RemoveCyclic(identifiers[index]);
+		}
+		for (unsigned int index = 0; index < 1000; ++index)
+		{
+			assert((vector.Find(identifiers[index]) != vector.failureIndex) == ((index % 3) != 0) && "SparseVector lost track of a 64-bit identifier.");
+			assert(((index % 3) == 0 || vector.Get(identifiers[index]) == static_cast<int>(index)) && "SparseVector element got separated from its identifier.");
+		}
+	}
+
+	inline void ReduceToIntersectionTest()
+	{
+		//Element 0 first, so a walk that stops before dense index 0 is caught, and both size relations are covered.
+		for (const bool useBitmaps : { false, true })
+		{
+			for (const unsigned int otherCount : { 10u, 100'000u })
+			{
+				CU::SparseSet<unsigned int> set;
+				CU::SparseSet<unsigned int> otherSet;
+				set.EnablePresenceBitmap(useBitmaps);
+				otherSet.EnablePresenceBitmap(useBitmaps);
+				for (unsigned int element = 0; element < 1000; ++element)
+				{
+					set.Add(element);
+				}
+				for (unsigned int element = 0; element < otherCount; element += 2)
+				{
+					otherSet.Add(element);
+				}
+
+				set.ReduceToIntersection(otherSet);
+				const unsigned int expectedCount = (otherCount < 1000) ? (otherCount / 2) : 500;
+				assert(set.Size() == expectedCount && "ReduceToIntersection kept a wrong amount of elements.");
+				for (size_t index = 0; index < set.Size(); ++index)
+				{
+					assert(set[index] == index * 2 && "ReduceToIntersection did not keep the relative order.");
+					assert(set.Find(set[index]) == index && "ReduceToIntersection left a stale sparse slot.");
+				}
+				assert(!set.IsValid(1) && !set.IsValid(999) && "ReduceToIntersection kept an element missing from the other set.");
+				set.Add(1);
+				assert(set.Find(1) == expectedCount && "Set is unusable after ReduceToIntersection.");
+				expectedCount;
+			}
+		}
+
+		std::vector<unsigned int> ids;
+		GenerateUniqueElements(ids, 1'000'000, 0, 999'999);
+		CU::SparseSet<unsigned int> set;
+		CU::SparseSet<unsigned int> otherSet;
+		set.AddMany(ids.data(), 300'000);
+		otherSet.AddMany(ids.data() + 150'000, 300'000);
+
+		CU::SparseSet<unsigned int> removedSet = set;
+		CU::StopWatch s;
+		s.Start();
+		for (size_t index = removedSet.Size(); index-- > 0;)
+		{
+			if (otherSet.Find(removedSet[index]) == otherSet.failureIndex)
+			{
+				removedSet.RemoveCyclic(removedSet[index]);
+			}
+		}
+		s.Stop();
+		const long long removeTime = s.Time().count();
+
+		s.Start();
+		set.ReduceToIntersection(otherSet);
+		s.Stop();
+		assert(set.Size() == 150'000 && removedSet.Size() == 150'000 && "ReduceToIntersection kept a wrong amount of elements.");
+		std::cout << "ReduceToIntersection 300k x 300k: Find + RemoveCyclic " << removeTime << " compaction " << s.Time().count() << "\n";
+	}
+}
+
+//Stand-in for a large component such as animation state, stored in a chunked pool.
+struct ChunkedTestComponent
+{
+	ChunkedTestComponent() {}
+	ChunkedTestComponent(const Entity anOwner) : myOwner(anOwner) {}
+	explicit operator Entity() const { return myOwner; }
+
+	Entity myOwner = 0;
+	float myPayload[63] = {};
+};
+
+template<>
+struct ComponentStorage<ChunkedTestComponent> : ChunkedComponentStorage<ChunkedTestComponent> {};
+
+namespace EntityRegistryTests
+{
+	//Checks that handles to destroyed entities stay invalid after their slot has been reused.
+	inline void StaleHandleTest()
+	{
+		EntityRegistry registry;
+		const Entity first = registry.Create();
+		registry.Assign<int>(first) = 1;
+		registry.Destroy(first);
+
+		const Entity reused = registry.Create();
+		registry.Assign<int>(reused) = 2;
+
+		assert(EntityRegistry::Traits::ToIndex(first) == EntityRegistry::Traits::ToIndex(reused) && "Destroyed slot was not reused.");
+		assert(!registry.IsValid(first) && "Stale handle reported as valid.");
+		assert(registry.IsValid(reused) && "Live handle reported as invalid.");
+		assert(!registry.IsValid(EntityRegistry::null) && "Null handle reported as valid.");
+		assert(registry.Get<int>().Find(first) == EntityRegistry::EntitySet::failureIndex && "Stale handle found in component pool.");
+		assert(registry.Get<int>().Find(reused) != EntityRegistry::EntitySet::failureIndex && "Live handle missing from component pool.");
+		first, reused;
+	}
+
+	//Checks that a cached View matches a freshly built Collection after a series of structural changes.
+	inline void ViewConsistencyTest()
+	{
+		EntityRegistry registry;
+		std::vector<Entity> entities;
+		for (int i = 0; i < 1000; ++i)
+		{
+			const Entity entity = registry.Create();
+			entities.push_back(entity);
+			if (i % 2 == 0)
+				registry.Assign<int>(entity);
+			if (i % 3 == 0)
+				registry.Assign<float>(entity);
+		}
+
+		const EntityRegistry::EntitySet& view = registry.View<int, float>();
+
+		for (size_t i = 0; i < entities.size(); i += 5)
+		{
+			registry.Destroy(entities[i]);
+		}
+		for (size_t i = 1; i < entities.size(); i += 10)
+		{
+			registry.Assign<int>(entities[i]);
+		}
+
+		EntityRegistry::EntitySet collection;
+		registry.Collection<int, float>(collection);
+
+		assert(view.Size() == collection.Size() && "View and Collection differ in size.");
+		for (size_t denseIndex = 0; denseIndex < collection.Size(); ++denseIndex)
+		{
+			assert(view.IsValid(collection[denseIndex]) && "View is missing an entity found by Collection.");
+		}
+		view;
+	}
+
+	struct Position { float x = 0.f, y = 0.f, z = 0.f; };
+	struct Velocity { float x = 1.f, y = 1.f, z = 1.f; };
+
+	//Compares a joined Position += Velocity pass over 1M entities through Collection + GetPool lookups against an owning group.
+	inline void OwningGroupBenchmark()
+	{
+		const int entityCount = 1'000'000;
+		CU::StopWatch s;
+
+		std::vector<Entity> entities;
+		auto populate = [&](EntityRegistry& aRegistry)
+		{
+			entities.clear();
+			for (int i = 0; i < entityCount; ++i)
+			{
+				const Entity entity = aRegistry.Create();
+				entities.push_back(entity);
+				aRegistry.Assign<Position>(entity);
+			}
+			//Velocities are assigned in a different order so the two pools do not line up by accident.
+			for (int i = entityCount - 1; i >= 0; i -= 2)
+			{
+				aRegistry.Assign<Velocity>(entities[i]);
+			}
+		};
+
+		{
+			EntityRegistry registry;
+			populate(registry);
+
+			s.Start();
+			EntityRegistry::EntitySet joined;
+			registry.Collection<Position, Velocity>(joined);
+			const EntityRegistry::EntitySet& positionEntities = registry.Get<Position>();
+			const EntityRegistry::EntitySet& velocityEntities = registry.Get<Velocity>();
+			std::vector<Position>& positions = registry.GetPool<Position>();
+			std::vector<Velocity>& velocities = registry.GetPool<Velocity>();
+			for (size_t index = 0; index < joined.Size(); ++index)
+			{
+				Position& position = positions[positionEntities.Find(joined[index])];
+				const Velocity& velocity = velocities[velocityEntities.Find(joined[index])];
+				position.x += velocity.x;
+				position.y += velocity.y;
+				position.z += velocity.z;
+			}
+			s.Stop();
+			std::cout << "Collection + GetPool: " << s.Time().count() << "\n";
+		}
+
+		{
+			EntityRegistry registry;
+			populate(registry);
+			registry.Group<Position, Velocity>();
+
+			s.Start();
+			const size_t groupSize = registry.Group<Position, Velocity>();
+			std::vector<Position>& positions = registry.GetPool<Position>();
+			std::vector<Velocity>& velocities = registry.GetPool<Velocity>();
+			for (size_t index = 0; index < groupSize; ++index)
+			{
+				positions[index].x += velocities[index].x;
+				positions[index].y += velocities[index].y;
+				positions[index].z += velocities[index].z;
+			}
+			s.Stop();
+			std::cout << "Owning group: " << s.Time().count() << "\n";
+		}
+	}
+
+	//Checks that an owning group keeps its entities packed and aligned through assigns, removes and destroys.
+	inline void OwningGroupConsistencyTest()
+	{
+		EntityRegistry registry;
+		std::vector<Entity> entities;
+		for (int i = 0; i < 1000; ++i)
+		{
+			const Entity entity = registry.Create();
+			entities.push_back(entity);
+			registry.Assign<int>(entity) = static_cast<int>(entity);
+			if (i % 3 == 0)
+				registry.Assign<float>(entity) = static_cast<float>(entity);
+		}
+
+		registry.Group<int, float>();
+
+		for (size_t i = 1; i < entities.size(); i += 3)
+		{
+			registry.Assign<float>(entities[i]) = static_cast<float>(entities[i]);
+		}
+		for (size_t i = 0; i < entities.size(); i += 6)
+		{
+			registry.Remove<float>(entities[i]);
+		}
+		for (size_t i = 0; i < entities.size(); i += 7)
+		{
+			registry.Destroy(entities[i]);
+		}
+
+		const size_t groupSize = registry.Group<int, float>();
+		EntityRegistry::EntitySet collection;
+		registry.Collection<int, float>(collection);
+		assert(groupSize == collection.Size() && "Group size does not match Collection.");
+
+		const EntityRegistry::EntitySet& intEntities = registry.Get<int>();
+		const EntityRegistry::EntitySet& floatEntities = registry.Get<float>();
+		const std::vector<int>& ints = registry.GetPool<int>();
+		const std::vector<float>& floats = registry.GetPool<float>();
+		for (size_t index = 0; index < groupSize; ++index)
+		{
+			assert(intEntities[index] == floatEntities[index] && "Group is not aligned across owned pools.");
+			assert(ints[index] == static_cast<int>(floats[index]) && "Grouped components were not moved with their entities.");
+		}
+		groupSize, intEntities, floatEntities, ints, floats;
+	}
+
+	//Runs the same Position += Velocity pass sequentially and in parallel, and destroys part of the entities through Defer.
+	inline void ParallelForEachTest()
+	{
+		const int entityCount = 1'000'000;
+		EntityRegistry registry;
+		for (int i = 0; i < entityCount; ++i)
+		{
+			const Entity entity = registry.Create();
+			registry.Assign<Position>(entity);
+			registry.Assign<Velocity>(entity);
+		}
+
+		auto integrate = [](const Entity, Position& aPosition, const Velocity& aVelocity)
+		{
+			for (int step = 0; step < 16; ++step)
+			{
+				aPosition.x += aVelocity.x;
+				aPosition.y += aVelocity.y * aPosition.x;
+				aPosition.z += aVelocity.z * aPosition.y;
+			}
+		};
+
+		CU::StopWatch s;
+		s.Start();
+		registry.ForEach<Position, Velocity>(integrate, ExecutionPolicy::Sequential);
+		s.Stop();
+		std::cout << "Sequential ForEach: " << s.Time().count() << "\n";
+
+		s.Start();
+		registry.ForEach<Position, Velocity>(integrate, ExecutionPolicy::Parallel);
+		s.Stop();
+		std::cout << "Parallel ForEach(" << CU::ThreadPool::GetDefault().GetParticipantCount() << " threads): " << s.Time().count() << "\n";
+
+		const std::vector<Position>& positions = registry.GetPool<Position>();
+		for (const Position& position : positions)
+		{
+			assert(position.x == 32.f && "ForEach visited an entity more or less than once per pass.");
+			position;
+		}
+
+		const int deferredCount = 10'000;
+		EntityRegistry deferRegistry;
+		for (int i = 0; i < deferredCount; ++i)
+		{
+			deferRegistry.Assign<Position>(deferRegistry.Create());
+		}
+
+		deferRegistry.ForEach<Position>([&deferRegistry](const Entity anEntity, Position&)
+		{
+			if ((EntityRegistry::Traits::ToIndex(anEntity) % 2) == 0)
+			{
+				deferRegistry.Defer().Destroy(anEntity);
+			}
+		}, ExecutionPolicy::Parallel);
+		assert(deferRegistry.Size() == deferredCount / 2 && "Deferred destroys were not applied at the sync point.");
+	}
+
+	//Destroys a third of 100k entities and removes Velocity from another third, once immediately and once through a command buffer,
+	//then repeats the batch with a group over the pools and checks pools, views and groups agree.
+	inline void CommandBufferPlaybackTest()
+	{
+		const int entityCount = 100'000;
+		CU::StopWatch s;
+
+		auto populate = [](EntityRegistry& aRegistry, std::vector<Entity>& someEntitiesOut)
+		{
+			for (int i = 0; i < entityCount; ++i)
+			{
+				const Entity entity = aRegistry.Create();
+				someEntitiesOut.push_back(entity);
+				aRegistry.Assign<Position>(entity).x = static_cast<float>(entity);
+				if (i % 2 == 0)
+					aRegistry.Assign<Velocity>(entity).x = static_cast<float>(entity);
+			}
+			aRegistry.View<Velocity>();
+		};
+
+		auto validate = [](EntityRegistry& aRegistry, const Entity aSpawnedEntity)
+		{
+			const EntityRegistry::EntitySet& positionEntities = aRegistry.Get<Position>();
+			const std::vector<Position>& positions = aRegistry.GetPool<Position>();
+			for (size_t index = 0; index < positionEntities.Size(); ++index)
+			{
+				const Entity entity = positionEntities[index];
+				assert(aRegistry.IsValid(entity) && "Destroyed entity still owns a component.");
+				assert((entity == aSpawnedEntity || positions[index].x == static_cast<float>(entity)) && "Removal separated components from their entities.");
+				entity;
+			}
+
+			const EntityRegistry::EntitySet& velocityEntities = aRegistry.Get<Velocity>();
+			const std::vector<Velocity>& velocities = aRegistry.GetPool<Velocity>();
+			for (size_t index = 0; index < velocityEntities.Size(); ++index)
+			{
+				const Entity entity = velocityEntities[index];
+				assert(aRegistry.IsValid(entity) && "Destroyed entity still owns a component.");
+				assert((entity == aSpawnedEntity || velocities[index].x == static_cast<float>(entity)) && "Removal separated components from their entities.");
+				entity;
+			}
+			assert(aRegistry.View<Velocity>().Size() == velocityEntities.Size() && "View out of date after Playback.");
+			positions;
+			velocities;
+		};
+
+		EntityRegistry immediateRegistry;
+		std::vector<Entity> immediateEntities;
+		populate(immediateRegistry, immediateEntities);
+
+		s.Start();
+		for (size_t i = 0; i < immediateEntities.size(); i += 3)
+		{
+			immediateRegistry.Destroy(immediateEntities[i]);
+		}
+		for (size_t i = 1; i < immediateEntities.size(); i += 3)
+		{
+			if (immediateRegistry.Get<Velocity>().IsValid(immediateEntities[i]))
+				immediateRegistry.Remove<Velocity>(immediateEntities[i]);
+		}
+		s.Stop();
+		std::cout << "Immediate Destroy and Remove: " << s.Time().count() << "\n";
+
+		EntityRegistry registry;
+		std::vector<Entity> entities;
+		populate(registry, entities);
+
+		EntityRegistry::CommandBuffer commandBuffer;
+		for (size_t i = 0; i < entities.size(); i += 3)
+		{
+			commandBuffer.Destroy(entities[i]);
+		}
+		for (size_t i = 1; i < entities.size(); i += 3)
+		{
+			if (registry.Get<Velocity>().IsValid(entities[i]))
+				commandBuffer.Remove<Velocity>(entities[i]);
+		}
+
+		s.Start();
+		commandBuffer.Playback(registry);
+		s.Stop();
+		std::cout << "Command buffer Playback: " << s.Time().count() << "\n";
+
+		assert(commandBuffer.IsEmpty() && "Playback did not clear the command buffer.");
+		assert(registry.Size() == immediateRegistry.Size() && "Playback destroyed a different amount of entities.");
+		assert(registry.Get<Velocity>().Size() == immediateRegistry.Get<Velocity>().Size() && "Playback removed a different amount of components.");
+		validate(registry, EntityRegistry::Traits::null);
+
+		//A single recorded Destroy costs about as much as an immediate one, the pools are not walked.
+		s.Start();
+		immediateRegistry.Destroy(immediateEntities[1]);
+		s.Stop();
+		std::cout << "Single immediate Destroy: " << s.Time().count() << "\n";
+
+		commandBuffer.Destroy(entities[1]);
+		s.Start();
+		commandBuffer.Playback(registry);
+		s.Stop();
+		std::cout << "Single Destroy Playback: " << s.Time().count() << "\n";
+
+		//Group owned pools take the order-preserving path, duplicates and creates are mixed in.
+		EntityRegistry groupRegistry;
+		std::vector<Entity> groupEntities;
+		populate(groupRegistry, groupEntities);
+		groupRegistry.Group<Position, Velocity>();
+
+		const EntityRegistry::CommandBuffer::PendingEntity spawned = commandBuffer.Create();
+		commandBuffer.Assign<Position>(spawned, Position{ 7.f, 0.f, 0.f });
+		commandBuffer.Assign<Velocity>(spawned);
+		for (size_t i = 0; i < groupEntities.size(); i += 3)
+		{
+			commandBuffer.Destroy(groupEntities[i]);
+			commandBuffer.Destroy(groupEntities[i]);
+		}
+		for (size_t i = 1; i < groupEntities.size(); i += 3)
+		{
+			commandBuffer.Remove<Velocity>(groupEntities[i]);
+		}
+		commandBuffer.Playback(groupRegistry);
+
+		assert(groupRegistry.Size() == groupEntities.size() - (groupEntities.size() + 2) / 3 + 1 && "Deferred creates or destroys were not applied.");
+
+		const Entity spawnedEntity = commandBuffer.GetCreatedEntities()[spawned.myCreateIndex];
+		assert(groupRegistry.IsValid(spawnedEntity) && groupRegistry.Get<Velocity>().IsValid(spawnedEntity) && "Pending entity did not receive its components.");
+		validate(groupRegistry, spawnedEntity);
+
+		EntityRegistry::EntitySet collection;
+		groupRegistry.Collection<Position, Velocity>(collection);
+		const size_t groupSize = groupRegistry.Group<Position, Velocity>();
+		assert(groupSize == collection.Size() && "Group size does not match Collection after Playback.");
+		groupSize;
+	}
+
+	//Records Remove then Assign and Assign then Remove on the same entity and component, Playback has to end up where running them in order would.
+	inline void CommandBufferOrderTest()
+	{
+		EntityRegistry registry;
+		const Entity reassigned = registry.Create();
+		const Entity removed = registry.Create();
+		const Entity added = registry.Create();
+		registry.Assign<Velocity>(reassigned).x = 1.f;
+		registry.Assign<Velocity>(removed).x = 1.f;
+
+		EntityRegistry::CommandBuffer commandBuffer;
+		commandBuffer.Remove<Velocity>(reassigned);
+		commandBuffer.Assign<Velocity>(reassigned, Velocity{ 2.f, 0.f, 0.f });
+		commandBuffer.Assign<Velocity>(removed, Velocity{ 3.f, 0.f, 0.f });
+		commandBuffer.Remove<Velocity>(removed);
+		commandBuffer.Assign<Velocity>(added, Velocity{ 4.f, 0.f, 0.f });
+		commandBuffer.Remove<Velocity>(added);
+		commandBuffer.Assign<Velocity>(added, Velocity{ 5.f, 0.f, 0.f });
+		commandBuffer.Playback(registry);
+
+		const EntityRegistry::EntitySet& velocityEntities = registry.Get<Velocity>();
+		const std::vector<Velocity>& velocities = registry.GetPool<Velocity>();
+		assert(velocityEntities.IsValid(reassigned) && velocities[velocityEntities.Find(reassigned)].x == 2.f && "Assign recorded after Remove was not applied.");
+		assert(!velocityEntities.IsValid(removed) && "Remove recorded after Assign was not applied.");
+		assert(velocityEntities.IsValid(added) && velocities[velocityEntities.Find(added)].x == 5.f && "The last recorded Assign did not win.");
+		velocityEntities;
+		velocities;
+	}
+
+	//Checks that every pool stays in lockstep with its entity set: the component at dense index i belongs to the entity at index i.
+	template<class ComponentType>
+	inline void ValidatePool(EntityRegistry& aRegistry)
+	{
+		const EntityRegistry::EntitySet& entities = aRegistry.Get<ComponentType>();
+		const EntityRegistry::PoolType<ComponentType>& components = aRegistry.GetPool<ComponentType>();
+		assert(entities.Size() == components.size() && "Pool and entity set differ in size.");
+		for (size_t index = 0; index < entities.Size(); ++index)
+		{
+			assert(entities.Find(entities[index]) == index && "Entity set sparse side points at the wrong dense slot.");
+			assert(static_cast<Entity>(components[index]) == entities[index] && "Component drifted away from its entity.");
+		}
+		entities, components;
+	}
+
+	//Millions of random Assign/Remove/RemoveOrdered calls on a small entity range, with a group over two of the pools.
+	inline void RemoveStressTest()
+	{
+		const int entityCount = 4096;
+		const int operationCount = 4'000'000;
+
+		EntityRegistry registry;
+		std::vector<Entity> entities;
+		for (int i = 0; i < entityCount; ++i)
+		{
+			entities.push_back(registry.Create());
+		}
+		registry.Group<int, float>();
+
+		CU::StopWatch s;
+		s.Start();
+		for (int operation = 0; operation < operationCount; ++operation)
+		{
+			const Entity entity = entities[CU::GenerateRandomInteger(0, entityCount - 1)];
+			const int action = CU::GenerateRandomInteger(0, 5);
+			switch (action % 3)
+			{
+			case 0:
+				if (registry.Get<int>().IsValid(entity))
+					(action < 3) ? registry.Remove<int>(entity) : registry.RemoveOrdered<int>(entity);
+				else
+					registry.Assign<int>(entity) = static_cast<int>(entity);
+				break;
+			case 1:
+				if (registry.Get<float>().IsValid(entity))
+					(action < 3) ? registry.Remove<float>(entity) : registry.RemoveOrdered<float>(entity);
+				else
+					registry.Assign<float>(entity) = static_cast<float>(entity);
+				break;
+			default:
+				if (registry.Get<unsigned int>().IsValid(entity))
+					registry.Remove<unsigned int>(entity);
+				else
+					registry.Assign<unsigned int>(entity) = entity;
+				break;
+			}
+		}
+		s.Stop();
+		std::cout << "Random Assign/Remove: " << s.Time().count() << "\n";
+
+		ValidatePool<int>(registry);
+		ValidatePool<float>(registry);
+		ValidatePool<unsigned int>(registry);
+
+		EntityRegistry::EntitySet collection;
+		registry.Collection<int, float>(collection);
+		const size_t groupSize = registry.Group<int, float>();
+		assert(groupSize == collection.Size() && "Group size does not match Collection.");
+		for (size_t index = 0; index < groupSize; ++index)
+		{
+			assert(registry.Get<int>()[index] == registry.Get<float>()[index] && "Group is not aligned across owned pools.");
+		}
+		groupSize;
+	}
+
+	//Spawns 200k entities with two components one call at a time and through SpawnMany/AssignManyGenerated.
+	inline void BulkSpawnBenchmark()
+	{
+		const size_t entityCount = 200'000;
+		CU::StopWatch s;
+
+		{
+			EntityRegistry registry;
+			s.Start();
+			for (size_t i = 0; i < entityCount; ++i)
+			{
+				const Entity entity = registry.Create();
+				registry.Assign<int>(entity) = static_cast<int>(entity);
+				registry.Assign<float>(entity) = static_cast<float>(entity);
+			}
+			s.Stop();
+			std::cout << "Create + Assign: " << s.Time().count() << "\n";
+		}
+
+		EntityRegistry registry;
+		std::vector<Entity> entities(entityCount);
+		s.Start();
+		registry.CreateMany(entityCount, entities.data());
+		registry.AssignManyGenerated<int>(entities.data(), entityCount, [&entities](const size_t anIndex) { return static_cast<int>(entities[anIndex]); });
+		registry.AssignManyGenerated<float>(entities.data(), entityCount, [&entities](const size_t anIndex) { return static_cast<float>(entities[anIndex]); });
+		s.Stop();
+		std::cout << "CreateMany + AssignManyGenerated: " << s.Time().count() << "\n";
+
+		ValidatePool<int>(registry);
+		ValidatePool<float>(registry);
+
+		//Recycled slots, a live view and a group have to be kept up to date by the batched path as well.
+		registry.View<int, unsigned int>();
+		registry.Group<float, unsigned int>();
+		registry.DestroyMany(entities.data(), entityCount / 2);
+
+		std::vector<Entity> spawned(entityCount);
+		registry.SpawnMany<unsigned int>(entityCount, spawned.data(), 7u);
+		registry.AssignManyGenerated<int>(spawned.data(), entityCount / 4, [&spawned](const size_t anIndex) { return static_cast<int>(spawned[anIndex]); });
+		registry.AssignManyGenerated<float>(spawned.data() + entityCount / 2, entityCount / 4, [&spawned](const size_t anIndex) { return static_cast<float>(spawned[entityCount / 2 + anIndex]); });
+
+		assert(registry.Size() == entityCount + entityCount / 2 && "CreateMany produced a wrong amount of entities.");
+		ValidatePool<int>(registry);
+		ValidatePool<float>(registry);
+
+		const EntityRegistry::EntitySet& view = registry.View<int, unsigned int>();
+		EntityRegistry::EntitySet collection;
+		registry.Collection<int, unsigned int>(collection);
+		assert(view.Size() == collection.Size() && "View out of date after AssignMany.");
+		EntityRegistry::EntitySet groupCollection;
+		registry.Collection<float, unsigned int>(groupCollection);
+		const size_t groupSize = registry.Group<float, unsigned int>();
+		assert(groupSize == groupCollection.Size() && "Group size does not match Collection after AssignMany.");
+		for (size_t index = 0; index < groupSize; ++index)
+		{
+			assert(registry.Get<float>()[index] == registry.Get<unsigned int>()[index] && "Group is not aligned across owned pools.");
+		}
+		view, groupSize;
+	}
+
+	//Keeps a reference from Assign alive through 100k further assigns into a chunked pool, then churns the pool inside a group.
+	inline void ChunkedPoolTest()
+	{
+		const size_t entityCount = 100'000;
+		EntityRegistry registry;
+
+		const Entity first = registry.Create();
+		ChunkedTestComponent& firstComponent = registry.Assign<ChunkedTestComponent>(first);
+		firstComponent.myOwner = first;
+
+		std::vector<Entity> entities(entityCount);
+		CU::StopWatch s;
+		s.Start();
+		registry.CreateMany(entityCount, entities.data());
+		for (const Entity entity : entities)
+		{
+			registry.Assign<ChunkedTestComponent>(entity).myOwner = entity;
+		}
+		s.Stop();
+		std::cout << "Assign into chunked pool: " << s.Time().count() << "\n";
+
+		assert(&registry.GetPool<ChunkedTestComponent>()[registry.Get<ChunkedTestComponent>().Find(first)] == &firstComponent && "Chunked pool moved a component while growing.");
+		assert(firstComponent.myOwner == first && "Chunked pool moved a component while growing.");
+		firstComponent;
+
+		registry.Group<ChunkedTestComponent, int>();
+		for (size_t i = 0; i < entities.size(); i += 2)
+		{
+			registry.Assign<int>(entities[i]) = static_cast<int>(entities[i]);
+		}
+		for (size_t i = 0; i < entities.size(); i += 3)
+		{
+			registry.Remove<ChunkedTestComponent>(entities[i]);
+		}
+		for (size_t i = 1; i < entities.size(); i += 6)
+		{
+			registry.RemoveOrdered<ChunkedTestComponent>(entities[i]);
+		}
+		registry.DestroyMany(entities.data() + entityCount / 2, entityCount / 2);
+
+		ValidatePool<ChunkedTestComponent>(registry);
+		ValidatePool<int>(registry);
+
+		size_t visited = 0;
+		const EntityRegistry::PoolType<ChunkedTestComponent>& pool = registry.GetPool<ChunkedTestComponent>();
+		for (size_t chunkIndex = 0; chunkIndex < pool.GetChunkCount(); ++chunkIndex)
+		{
+			visited += pool.GetChunkSize(chunkIndex);
+		}
+		assert(visited == pool.size() && "Chunk-wise iteration does not cover the pool.");
+
+		EntityRegistry::EntitySet collection;
+		registry.Collection<ChunkedTestComponent, int>(collection);
+		const size_t groupSize = registry.Group<ChunkedTestComponent, int>();
+		assert(groupSize == collection.Size() && "Group size does not match Collection over a chunked pool.");
+		visited, groupSize;
+	}
+
+	struct Health { int value = 100; };
+
+	//Runs the same spawn, churn, query and destroy workload on either storage engine and returns a checksum of the query results.
+	template<class RegistryType>
+	inline double StorageEngineWorkload(const char* anEngineName)
+	{
+		const size_t entityCount = 200'000;
+		RegistryType registry;
+		std::vector<Entity> entities(entityCount);
+		CU::StopWatch s;
+
+		s.Start();
+		registry.CreateMany(entityCount, entities.data());
+		for (size_t i = 0; i < entityCount; ++i)
+		{
+			registry.template Assign<Position>(entities[i]).x = static_cast<float>(i);
+			if (i % 2 == 0)
+				registry.template Assign<Velocity>(entities[i]);
+			if (i % 3 == 0)
+				registry.template Assign<Health>(entities[i]);
+		}
+		s.Stop();
+		std::cout << anEngineName << " spawn: " << s.Time().count() << "\n";
+
+		s.Start();
+		for (size_t i = 0; i < entityCount; i += 4)
+		{
+			registry.template Remove<Position>(entities[i]);
+		}
+		for (size_t i = 0; i < entityCount; i += 8)
+		{
+			registry.template Assign<Position>(entities[i]).x = static_cast<float>(i);
+		}
+		s.Stop();
+		std::cout << anEngineName << " churn: " << s.Time().count() << "\n";
+
+		double checksum = 0.0;//Every term is a whole number, so the sum is exact whatever order the engines visit entities in.
+		s.Start();
+		for (int pass = 0; pass < 10; ++pass)
+		{
+			registry.template ForEach<Position, Velocity, Health>([](const Entity, Position& aPosition, const Velocity& aVelocity, Health& aHealth)
+			{
+				aPosition.x += aVelocity.x;
+				aHealth.value -= 1;
+			}, (pass % 2 == 0) ? ExecutionPolicy::Sequential : ExecutionPolicy::Parallel);
+		}
+		registry.template ForEach<Position, Health>([&checksum](const Entity, const Position& aPosition, const Health& aHealth)
+		{
+			checksum += static_cast<double>(aPosition.x) * aHealth.value;
+		});
+		s.Stop();
+		std::cout << anEngineName << " 3-component query x10: " << s.Time().count() << "\n";
+
+		for (size_t i = 1; i < entityCount; i += 2)
+		{
+			registry.Destroy(entities[i]);
+		}
+		assert(registry.Size() == entityCount / 2 && "Destroy left a wrong amount of entities.");
+
+		return checksum;
+	}
+
+	//Both storage engines have to agree on the workload results, their timings are printed side by side.
+	inline void StorageEngineComparison()
+	{
+		const double sparseSetChecksum = StorageEngineWorkload<EntityRegistry>("Sparse set");
+		const double archetypeChecksum = StorageEngineWorkload<ArchetypeRegistry>("Archetype");
+		assert(sparseSetChecksum == archetypeChecksum && "Storage engines disagree on the workload result.");
+		sparseSetChecksum, archetypeChecksum;
+
+		ArchetypeRegistry registry;
+		const Entity entity = registry.Create();
+		registry.Assign<Position>(entity).x = 3.f;
+		registry.Assign<Velocity>(entity);
+		registry.Remove<Position>(entity);
+		registry.Assign<Position>(entity).x = 4.f;
+		assert(registry.GetArchetypeCount() == 4 && "Archetype transitions created duplicate archetypes.");
+		assert(registry.GetComponent<Position>(entity).x == 4.f && registry.Has<Velocity>(entity) && "Components were lost moving between archetypes.");
+
+		size_t visited = 0;
+		registry.ForEachArchetype<Velocity>([&visited](const Entity*, const size_t aCount, Velocity*) { visited += aCount; });
+		assert(visited == 1 && "ForEachArchetype visited a wrong amount of entities.");
+		visited;
+	}
 }
 
 class CommonBase
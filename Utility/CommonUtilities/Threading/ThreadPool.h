@@ -0,0 +1,254 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <assert.h>
+
+/*
+	Work-stealing thread pool. ParallelFor hands out task indices round-robin to one queue per participant
+	(the calling thread plus every worker). Each participant drains its own queue from the front and, once it is
+	empty, steals from the back of the other queues, so uneven tasks balance out without a shared queue.
+	The calling thread participates and ParallelFor returns once every task has run.
+	Participant 0 is the calling thread, workers are 1..GetParticipantCount()-1, see GetCurrentParticipantIndex.
+*/
+
+namespace CommonUtility
+{
+	class ThreadPool
+	{
+	public:
+		ThreadPool(const unsigned int aWorkerCount = DefaultWorkerCount());
+		ThreadPool(const ThreadPool& aThreadPool) = delete;
+		ThreadPool& operator=(const ThreadPool& aThreadPool) = delete;
+		~ThreadPool();
+
+		//Runs aTask(taskIndex) for every taskIndex in [0, aTaskCount) and blocks until all have finished. Not reentrant.
+		template<class Function>
+		void ParallelFor(const size_t aTaskCount, const Function& aTask);
+
+		unsigned int GetParticipantCount() const;
+
+		//Index of the pool participant running the current thread, 0 for any thread that is not a worker.
+		static unsigned int GetCurrentParticipantIndex();
+
+		static ThreadPool& GetDefault();
+		//aThreadPool, or the default pool when it is nullptr. Take pools as ThreadPool* defaulting to nullptr and resolve them here
+		//only where work is handed out, so sequential calls never start the default pool's workers.
+		static ThreadPool& GetOrDefault(ThreadPool* aThreadPool);
+
+	private:
+		static unsigned int DefaultWorkerCount();
+
+		template<class Function>
+		static void InvokeTask(const void* aTask, const size_t aTaskIndex);
+
+		void WorkerLoop(const unsigned int aParticipantIndex);
+		void RunTasks(const unsigned int aParticipantIndex);
+		bool PopTask(const unsigned int aParticipantIndex, size_t& aTaskIndexOut);
+		bool StealTask(const unsigned int aParticipantIndex, size_t& aTaskIndexOut);
+
+		struct WorkQueue
+		{
+			std::mutex myMutex;
+			std::deque<size_t> myTasks;
+		};
+
+		std::vector<std::unique_ptr<WorkQueue>> myQueues;
+		std::vector<std::thread> myWorkers;
+
+		std::mutex myDispatchMutex;
+		std::mutex myWakeMutex;
+		std::condition_variable myWakeCondition;
+		std::condition_variable myDoneCondition;
+		size_t myGeneration = 0;
+		bool myIsShuttingDown = false;
+
+		std::atomic<size_t> myRemainingTasks = 0;
+		std::atomic<void(*)(const void*, const size_t)> myTaskFunc = nullptr;
+		std::atomic<const void*> myTask = nullptr;
+
+		inline static thread_local unsigned int ourParticipantIndex = 0;
+	};
+
+	inline ThreadPool::ThreadPool(const unsigned int aWorkerCount)
+	{
+		for (unsigned int participantIndex = 0; participantIndex <= aWorkerCount; ++participantIndex)
+		{
+			myQueues.push_back(std::make_unique<WorkQueue>());
+		}
+
+		for (unsigned int workerIndex = 0; workerIndex < aWorkerCount; ++workerIndex)
+		{
+			myWorkers.emplace_back(&ThreadPool::WorkerLoop, this, workerIndex + 1);
+		}
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(myWakeMutex);
+			myIsShuttingDown = true;
+		}
+		myWakeCondition.notify_all();
+
+		for (std::thread& worker : myWorkers)
+		{
+			worker.join();
+		}
+	}
+
+	template<class Function>
+	inline void ThreadPool::ParallelFor(const size_t aTaskCount, const Function& aTask)
+	{
+		if (aTaskCount == 0)
+		{
+			return;
+		}
+
+		if (myWorkers.empty() || (aTaskCount == 1))
+		{
+			for (size_t taskIndex = 0; taskIndex < aTaskCount; ++taskIndex)
+			{
+				aTask(taskIndex);
+			}
+			return;
+		}
+
+		std::lock_guard<std::mutex> dispatchLock(myDispatchMutex);
+		assert(ourParticipantIndex == 0 && "ThreadPool::ParallelFor can not be called from inside a task.");
+
+		//The task is published before any index is queued, a participant reads it only after popping an index.
+		myTask = &aTask;
+		myTaskFunc = &ThreadPool::InvokeTask<Function>;
+		myRemainingTasks = aTaskCount;
+
+		const size_t participantCount = myQueues.size();
+		for (size_t participantIndex = 0; participantIndex < participantCount; ++participantIndex)
+		{
+			WorkQueue& queue = *myQueues[participantIndex];
+			std::lock_guard<std::mutex> queueLock(queue.myMutex);
+			for (size_t taskIndex = participantIndex; taskIndex < aTaskCount; taskIndex += participantCount)
+			{
+				queue.myTasks.push_back(taskIndex);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(myWakeMutex);
+			++myGeneration;
+		}
+		myWakeCondition.notify_all();
+
+		RunTasks(0);
+
+		std::unique_lock<std::mutex> lock(myWakeMutex);
+		myDoneCondition.wait(lock, [this]() { return myRemainingTasks == 0; });
+	}
+
+	inline unsigned int ThreadPool::GetParticipantCount() const
+	{
+		return static_cast<unsigned int>(myQueues.size());
+	}
+
+	inline unsigned int ThreadPool::GetCurrentParticipantIndex()
+	{
+		return ourParticipantIndex;
+	}
+
+	inline ThreadPool & ThreadPool::GetDefault()
+	{
+		static ThreadPool defaultPool;
+		return defaultPool;
+	}
+
+	inline ThreadPool & ThreadPool::GetOrDefault(ThreadPool * aThreadPool)
+	{
+		return (aThreadPool != nullptr) ? *aThreadPool : GetDefault();
+	}
+
+	inline unsigned int ThreadPool::DefaultWorkerCount()
+	{
+		const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		return (hardwareThreads > 1) ? (hardwareThreads - 1) : 0;
+	}
+
+	template<class Function>
+	inline void ThreadPool::InvokeTask(const void * aTask, const size_t aTaskIndex)
+	{
+		(*static_cast<const Function*>(aTask))(aTaskIndex);
+	}
+
+	inline void ThreadPool::WorkerLoop(const unsigned int aParticipantIndex)
+	{
+		ourParticipantIndex = aParticipantIndex;
+		size_t seenGeneration = 0;
+
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(myWakeMutex);
+				myWakeCondition.wait(lock, [&]() { return myIsShuttingDown || (myGeneration != seenGeneration); });
+				if (myIsShuttingDown)
+				{
+					return;
+				}
+				seenGeneration = myGeneration;
+			}
+
+			RunTasks(aParticipantIndex);
+		}
+	}
+
+	inline void ThreadPool::RunTasks(const unsigned int aParticipantIndex)
+	{
+		size_t taskIndex;
+		while (PopTask(aParticipantIndex, taskIndex) || StealTask(aParticipantIndex, taskIndex))
+		{
+			myTaskFunc.load()(myTask.load(), taskIndex);
+
+			if (--myRemainingTasks == 0)
+			{
+				std::lock_guard<std::mutex> lock(myWakeMutex);
+				myDoneCondition.notify_all();
+			}
+		}
+	}
+
+	inline bool ThreadPool::PopTask(const unsigned int aParticipantIndex, size_t & aTaskIndexOut)
+	{
+		WorkQueue& queue = *myQueues[aParticipantIndex];
+		std::lock_guard<std::mutex> lock(queue.myMutex);
+		if (queue.myTasks.empty())
+		{
+			return false;
+		}
+
+		aTaskIndexOut = queue.myTasks.front();
+		queue.myTasks.pop_front();
+		return true;
+	}
+
+	inline bool ThreadPool::StealTask(const unsigned int aParticipantIndex, size_t & aTaskIndexOut)
+	{
+		const size_t participantCount = myQueues.size();
+		for (size_t offset = 1; offset < participantCount; ++offset)
+		{
+			WorkQueue& victim = *myQueues[(aParticipantIndex + offset) % participantCount];
+			std::lock_guard<std::mutex> lock(victim.myMutex);
+			if (!victim.myTasks.empty())
+			{
+				aTaskIndexOut = victim.myTasks.back();
+				victim.myTasks.pop_back();
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+namespace CU = CommonUtility;